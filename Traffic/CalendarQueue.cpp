@@ -0,0 +1,81 @@
+#include "CalendarQueue.hpp"
+
+CalendarQueue::CalendarQueue(unsigned int bucketCount) : total(0) {
+	unsigned int size = 1;
+	while (size < bucketCount) {
+		size *= 2;
+	}
+	mask = size - 1;
+	buckets = new Bucket[size];
+	for (unsigned int b = 0; b < size; b++) {
+		buckets[b].events = 0;
+		buckets[b].count = 0;
+		buckets[b].capacity = 0;
+	}
+}
+
+CalendarQueue::~CalendarQueue() {
+	for (unsigned int b = 0; b <= mask; b++) {
+		delete[] buckets[b].events;
+	}
+	delete[] buckets;
+}
+
+void CalendarQueue::push(unsigned int tick, unsigned int item) {
+	Bucket& bucket = buckets[tick & mask];
+	if (bucket.count == bucket.capacity) {
+		unsigned int capacity = bucket.capacity != 0 ? 2 * bucket.capacity : 4;
+		Event* events = new Event[capacity];
+		for (unsigned int e = 0; e < bucket.count; e++) {
+			events[e] = bucket.events[e];
+		}
+		delete[] bucket.events;
+		bucket.events = events;
+		bucket.capacity = capacity;
+	}
+	bucket.events[bucket.count].tick = tick;
+	bucket.events[bucket.count].item = item;
+	bucket.count++;
+	total++;
+}
+
+unsigned int CalendarQueue::nextTick(unsigned int from) const {
+	if (total == 0) {
+		return NO_EVENT;
+	}
+	// Look through the coming year a day at a time
+	for (unsigned int day = 0; day <= mask; day++) {
+		const Bucket& bucket = buckets[(from + day) & mask];
+		for (unsigned int e = 0; e < bucket.count; e++) {
+			if (bucket.events[e].tick == from + day) {
+				return from + day;
+			}
+		}
+	}
+	// Nothing is due this year, so find the earliest event directly
+	unsigned int earliest = NO_EVENT;
+	for (unsigned int b = 0; b <= mask; b++) {
+		for (unsigned int e = 0; e < buckets[b].count; e++) {
+			unsigned int tick = buckets[b].events[e].tick;
+			if (tick >= from && tick < earliest) {
+				earliest = tick;
+			}
+		}
+	}
+	return earliest;
+}
+
+bool CalendarQueue::pop(unsigned int tick, unsigned int& item) {
+	Bucket& bucket = buckets[tick & mask];
+	// Events added last are usually the ones due soonest
+	for (unsigned int e = bucket.count; e > 0; e--) {
+		if (bucket.events[e - 1].tick == tick) {
+			item = bucket.events[e - 1].item;
+			bucket.events[e - 1] = bucket.events[bucket.count - 1];
+			bucket.count--;
+			total--;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,85 @@
+#ifndef CALENDARQUEUE_HPP
+#define CALENDARQUEUE_HPP
+
+/*
+The CalendarQueue class is a priority queue of events, each an item (such as an intersection or lane index) due at a
+tick. Like a desk calendar it has a bucket for each day of the year: an event due at tick t goes in bucket t % B, where B
+is the number of buckets, so adding an event and taking the events due at the current tick take O(1) time. Events more
+than a year ahead share a bucket with nearer ones and are passed over until their year comes round, so the queue works
+best with at least as many buckets as the furthest ahead events are usually scheduled.
+*/
+class CalendarQueue {
+public:
+	/*
+	Returned by nextTick() when there are no events.
+	*/
+	static const unsigned int NO_EVENT = ~0u;
+
+	/*
+	Create an empty queue of `bucketCount` buckets, rounded up to a power of two.
+	*/
+	explicit CalendarQueue(unsigned int bucketCount = 256);
+
+	/*
+	Destroy the queue. The items are not otherwise cleaned up.
+	*/
+	~CalendarQueue();
+
+	/*
+	Get the number of events in the queue.
+	*/
+	unsigned int size() const {
+		return total;
+	}
+
+	/*
+	Return `true` if there are no events in the queue, otherwise `false`.
+	*/
+	bool empty() const {
+		return total == 0;
+	}
+
+	/*
+	Add an event for `item` due at tick `tick`.
+	*/
+	void push(unsigned int tick, unsigned int item);
+
+	/*
+	Get the earliest tick at or after `from` that has an event due, or NO_EVENT if there is none. Events due before
+	`from` are ignored.
+	*/
+	unsigned int nextTick(unsigned int from) const;
+
+	/*
+	Remove an event due at tick `tick` and store its item in `item`, returning `true`, or return `false` if there is no
+	event due then. Events due at the same tick are removed in no particular order.
+	*/
+	bool pop(unsigned int tick, unsigned int& item);
+
+private:
+	/*
+	Private copy constructor and copy assignment operator - queues cannot be copied.
+	*/
+	CalendarQueue(const CalendarQueue&);
+	CalendarQueue& operator=(const CalendarQueue&);
+
+	struct Event {
+		unsigned int tick;
+		unsigned int item;
+	};
+
+	/*
+	The events in one bucket, unordered, in an array that doubles when full.
+	*/
+	struct Bucket {
+		Event* events;
+		unsigned int count;
+		unsigned int capacity;
+	};
+
+	Bucket* buckets;
+	unsigned int mask;
+	unsigned int total;
+};
+
+#endif /* end of include guard: CALENDARQUEUE_HPP */
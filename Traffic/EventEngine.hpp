@@ -0,0 +1,157 @@
+#ifndef EVENTENGINE_HPP
+#define EVENTENGINE_HPP
+
+#include "RoadNetwork.hpp"
+#include "CalendarQueue.hpp"
+#include "RingBuffer.hpp"
+
+/*
+The BasicEventEngine class runs a BasicRoadNetwork as a discrete-event simulation: rather than visiting the network
+every tick, it keeps a CalendarQueue of the ticks at which something happens and jumps straight from one to the next.
+There are two kinds of event. A decision event simulates an intersection with the usual give way rules (see
+BasicIntersection::simulateWith()); an arrival event puts vehicles that have finished travelling along a lane into it.
+An intersection that moved vehicles decides again the next tick, and one that found nothing waiting is not visited
+again until a vehicle arrives in one of its incoming lanes, so the time taken grows with the number of vehicle
+movements rather than with the size of the network or the number of ticks.
+
+Each lane has a travel time: a vehicle leaving the intersection upstream of it arrives at the back of the lane that many
+ticks later. Vehicles on their way along a lane count towards its capacity, and never overtake each other. A vehicle sent
+into a lane by the intersection that lane flows into (turning back, or into another incoming lane) has no distance to
+travel and arrives at the end of the tick. Within a tick the engine works like a synchronous step of the network (see
+RoadNetworkBase::SM_SYNCHRONOUS): every intersection deciding sees its lanes as they were at the start of the tick, and
+arrivals happen at the end. With every travel time 0, the default, running the engine for a number of ticks gives
+exactly the same result as stepping the network synchronously that many times.
+
+The engine works on the network's lanes and intersections in place. While vehicles are travelling they belong to the
+engine, which deletes any still in transit when it is destroyed. The network must not be stepped, relabelled or
+reordered while the engine is in use, though vehicles may be added to its lanes between calls to run().
+*/
+template <class LaneT, class Rules = LeftHandTraffic>
+class BasicEventEngine {
+public:
+	typedef BasicRoadNetwork<LaneT, Rules> NetworkType;
+
+	/*
+	Create an engine running `network`, with calendars of `buckets` buckets (see CalendarQueue). Choose at least as
+	many buckets as the longest travel time for the best speed. Every lane starts with a travel time of 0.
+	*/
+	explicit BasicEventEngine(NetworkType& network, unsigned int buckets = 256);
+
+	/*
+	Destroy the engine and the vehicles still travelling along lanes.
+	*/
+	~BasicEventEngine();
+
+	/*
+	Get or set the number of ticks a vehicle takes to travel along lane `l`.
+	*/
+	unsigned int travelTime(unsigned int l) const {
+		return travelTimes[l];
+	}
+	void setTravelTime(unsigned int l, unsigned int ticks) {
+		travelTimes[l] = ticks;
+	}
+
+	/*
+	Get the number of vehicles travelling along lane `l`, or along every lane.
+	*/
+	unsigned int inTransit(unsigned int l) const {
+		return transit[l].count();
+	}
+	unsigned int inTransit() const {
+		return transitTotal;
+	}
+
+	/*
+	Get the number of vehicles moved through intersections since the engine was created.
+	*/
+	unsigned long long movements() const {
+		return movementTotal;
+	}
+
+	/*
+	Run the simulation from the SimClock's current tick up to, but not including, tick `until`, then set the SimClock to
+	`until`. Every intersection the network has awake (see BasicRoadNetwork::active()) decides at the first tick, so
+	vehicles added to lanes since the last run are picked up.
+	*/
+	void run(unsigned int until);
+
+private:
+	/*
+	Private copy constructor and copy assignment operator - engines cannot be copied.
+	*/
+	BasicEventEngine(const BasicEventEngine&);
+	BasicEventEngine& operator=(const BasicEventEngine&);
+
+	/*
+	Schedule a decision for intersection `i` at tick `tick`, unless it already has one then.
+	*/
+	void schedule(unsigned int i, unsigned int tick);
+
+	/*
+	Process every event due at tick `tick`: the decisions, then the arrivals.
+	*/
+	void processTick(unsigned int tick);
+
+	/*
+	Move a vehicle sent into lane `l` by intersection `from` at tick `tick` on its way.
+	*/
+	void send(unsigned int l, Vehicle* vehicle, unsigned int from, unsigned int tick);
+
+	/*
+	Put the vehicles due to arrive in lane `l` at tick `tick` into it, and wake the intersection it flows into.
+	*/
+	void arrive(unsigned int l, unsigned int tick);
+
+	/*
+	The router a deciding intersection is simulated with, which checks room against the lanes as they were at the start
+	of the tick and sends vehicles on their way along lanes rather than enqueueing them.
+	*/
+	struct EventRouter {
+		BasicEventEngine* engine;
+		unsigned int intersection;
+		unsigned int tick;
+
+		bool hasRoom(LaneT* lane) {
+			return engine->laneRoom[lane - engine->lanes];
+		}
+		void deliver(LaneT* lane, Vehicle* vehicle) {
+			engine->send(lane - engine->lanes, vehicle, intersection, tick);
+		}
+	};
+
+	/*
+	A vehicle travelling along a lane, and the tick it arrives.
+	*/
+	struct Transit {
+		Vehicle* vehicle;
+		unsigned int arrival;
+	};
+
+	NetworkType& network;
+	LaneT* lanes;
+	CalendarQueue decisions;
+	CalendarQueue arrivals;
+	// The tick of each intersection's scheduled decision, or CalendarQueue::NO_EVENT
+	unsigned int* decisionTick;
+	unsigned int* travelTimes;
+	// The vehicles travelling along each lane from its upstream intersection, in order of arrival
+	RingBuffer<Transit>* transit;
+	unsigned int transitTotal;
+	// The vehicle each lane's downstream intersection sent into it this tick, if any
+	Vehicle** returned;
+	// Whether each lane of the intersections deciding this tick had room at the start of the tick
+	bool* laneRoom;
+	// The intersections deciding this tick
+	unsigned int* deciding;
+	unsigned long long movementTotal;
+};
+
+/*
+An engine for a network of SimpleLanes.
+*/
+typedef BasicEventEngine<SimpleLane> EventEngine;
+
+#include "EventEngine.tpp"
+
+#endif /* end of include guard: EVENTENGINE_HPP */
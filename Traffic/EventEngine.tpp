@@ -0,0 +1,145 @@
+// Template definitions for BasicEventEngine, included at the end of EventEngine.hpp
+
+template <class LaneT, class Rules>
+BasicEventEngine<LaneT, Rules>::BasicEventEngine(NetworkType& network, unsigned int buckets) : network(network),
+	lanes(network.laneCount() > 0 ? &network.lane(0) : 0), decisions(buckets), arrivals(buckets), transitTotal(0),
+	movementTotal(0) {
+	unsigned int intersectionCount = network.intersectionCount();
+	unsigned int laneCount = network.laneCount();
+	decisionTick = new unsigned int[intersectionCount];
+	for (unsigned int i = 0; i < intersectionCount; i++) {
+		decisionTick[i] = CalendarQueue::NO_EVENT;
+	}
+	deciding = new unsigned int[intersectionCount];
+	travelTimes = new unsigned int[laneCount];
+	transit = new RingBuffer<Transit>[laneCount];
+	returned = new Vehicle*[laneCount];
+	laneRoom = new bool[laneCount];
+	for (unsigned int l = 0; l < laneCount; l++) {
+		travelTimes[l] = 0;
+		returned[l] = 0;
+		laneRoom[l] = false;
+	}
+}
+
+template <class LaneT, class Rules>
+BasicEventEngine<LaneT, Rules>::~BasicEventEngine() {
+	for (unsigned int l = 0; l < network.laneCount(); l++) {
+		while (!transit[l].empty()) {
+			delete transit[l].pop().vehicle;
+		}
+		delete returned[l];
+	}
+	delete[] decisionTick;
+	delete[] deciding;
+	delete[] travelTimes;
+	delete[] transit;
+	delete[] returned;
+	delete[] laneRoom;
+}
+
+template <class LaneT, class Rules>
+void BasicEventEngine<LaneT, Rules>::run(unsigned int until) {
+	unsigned int tick = SimClock::now();
+	if (tick >= until) {
+		return;
+	}
+	for (unsigned int i = 0; i < network.intersectionCount(); i++) {
+		if (network.active(i)) {
+			schedule(i, tick);
+		}
+	}
+	while (true) {
+		unsigned int nextDecision = decisions.nextTick(tick);
+		unsigned int nextArrival = arrivals.nextTick(tick);
+		tick = nextDecision < nextArrival ? nextDecision : nextArrival;
+		if (tick == CalendarQueue::NO_EVENT || tick >= until) {
+			break;
+		}
+		SimClock::reset(tick);
+		processTick(tick);
+		tick++;
+	}
+	SimClock::reset(until);
+}
+
+template <class LaneT, class Rules>
+void BasicEventEngine<LaneT, Rules>::schedule(unsigned int i, unsigned int tick) {
+	if (decisionTick[i] != tick) {
+		decisionTick[i] = tick;
+		decisions.push(tick, i);
+	}
+}
+
+template <class LaneT, class Rules>
+void BasicEventEngine<LaneT, Rules>::processTick(unsigned int tick) {
+	unsigned int decidingCount = 0;
+	unsigned int i;
+	while (decisions.pop(tick, i)) {
+		decisionTick[i] = CalendarQueue::NO_EVENT;
+		deciding[decidingCount++] = i;
+	}
+
+	// Record which lanes have room before any intersection moves a vehicle, counting the vehicles on their way
+	for (unsigned int d = 0; d < decidingCount; d++) {
+		for (int side = 0; side < 4; side++) {
+			unsigned int l = network.laneAt(deciding[d], side);
+			if (l != NetworkType::NONE) {
+				unsigned int capacity = lanes[l].capacity();
+				laneRoom[l] = capacity == 0 || lanes[l].count() + transit[l].count() < capacity;
+			}
+		}
+	}
+
+	// An intersection that moved vehicles may have more to move next tick
+	EventRouter router = { this, 0, tick };
+	for (unsigned int d = 0; d < decidingCount; d++) {
+		router.intersection = deciding[d];
+		if (network.intersection(deciding[d]).simulateWith(router)) {
+			schedule(deciding[d], tick + 1);
+		}
+	}
+
+	unsigned int l;
+	while (arrivals.pop(tick, l)) {
+		arrive(l, tick);
+	}
+}
+
+template <class LaneT, class Rules>
+void BasicEventEngine<LaneT, Rules>::send(unsigned int l, Vehicle* vehicle, unsigned int from, unsigned int tick) {
+	movementTotal++;
+	if (network.downstreamOf(l) == from) {
+		returned[l] = vehicle;
+		arrivals.push(tick, l);
+		return;
+	}
+	// A vehicle cannot arrive before the one ahead of it, even if the travel time has been shortened since it left
+	Transit travelling = { vehicle, tick + travelTimes[l] };
+	if (!transit[l].empty() && transit[l].back().arrival > travelling.arrival) {
+		travelling.arrival = transit[l].back().arrival;
+	}
+	transit[l].push(travelling);
+	transitTotal++;
+	arrivals.push(travelling.arrival, l);
+}
+
+template <class LaneT, class Rules>
+void BasicEventEngine<LaneT, Rules>::arrive(unsigned int l, unsigned int tick) {
+	// Vehicles from upstream join the lane first, as in a synchronous step; a lane may have more than one event due
+	bool arrived = false;
+	while (!transit[l].empty() && transit[l].front().arrival == tick) {
+		lanes[l].enqueue(transit[l].pop().vehicle);
+		transitTotal--;
+		arrived = true;
+	}
+	if (returned[l] != 0) {
+		lanes[l].enqueue(returned[l]);
+		returned[l] = 0;
+		arrived = true;
+	}
+	unsigned int downstream = network.downstreamOf(l);
+	if (arrived && downstream != NetworkType::NONE) {
+		schedule(downstream, tick + 1);
+	}
+}
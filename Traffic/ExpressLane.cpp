@@ -1,4 +1,10 @@
 #include "ExpressLane.hpp"
+#include <typeinfo>
+
+ExpressLane::ExpressLane() {
+	// No motorcycles are queued in a new lane
+	lastBike = 0;
+}
 
 void ExpressLane::enqueue(Vehicle* vehicle) {
 
@@ -9,44 +15,115 @@ void ExpressLane::enqueue(Vehicle* vehicle) {
 		frontVehicle = nodeToAdd;
 		lastVehicle = nodeToAdd;
 	}
+	// Adding car/bus to the end
+	else if (vehicle->type() != Vehicle::VT_MOTORCYCLE) {
+		lastVehicle->setNext(nodeToAdd);
+		lastVehicle = nodeToAdd;
+	}
+	// If there are no motorcycles in the queue then the motorcycle goes to the front
+	else if (lastBike == 0) {
+		nodeToAdd->setNext(frontVehicle);
+		frontVehicle = nodeToAdd;
+	}
+	// Adding to the back of the last bike, which may also be the last vehicle
 	else {
-		// If vehicles are in a queue and vehicle being enqueued is motorcycle
-		if (nodeToAdd->getQueued()->type() == Vehicle::VT_MOTORCYCLE) {
-
-			// If there are no motocycles in queue which means front vehicle is not motorcycle
-			// then add motorcycle to the front
-			if (frontVehicle->getQueued()->type() != Vehicle::VT_MOTORCYCLE) {
-				nodeToAdd->setNext(frontVehicle);
-				frontVehicle = nodeToAdd;
-			}
-			else {
-				Node *ref = frontVehicle;
-
-				//There are bikes in queue and we need to find the last bike in queue
-				for (int i = 1; i < sum; i++) {
-					if (ref->getNext()->getQueued()->type() == Vehicle::VT_MOTORCYCLE) {
-						ref = ref->getNext();
-					}
-				}
-
-				// Adding to the back of the last bike
-				if (ref == lastVehicle) {
-					lastVehicle->setNext(nodeToAdd);
-					lastVehicle = nodeToAdd;
-				}
-				else {
-					nodeToAdd->setNext(ref->getNext());
-					ref->setNext(nodeToAdd);
-				}
+		nodeToAdd->setNext(lastBike->getNext());
+		lastBike->setNext(nodeToAdd);
+		if (lastBike == lastVehicle) {
+			lastVehicle = nodeToAdd;
+		}
+	}
+
+	// The new motorcycle is now the last bike in the queue
+	if (vehicle->type() == Vehicle::VT_MOTORCYCLE) {
+		lastBike = nodeToAdd;
+	}
+	// sum of the total vehicles is incremented
+	sum++;
+	recordEnqueue(vehicle, sum);
+}
+
+Vehicle* ExpressLane::dequeue() {
+	// Motorcycles are always at the front, so if the front node is the last bike then it is the only
+	// bike left and no motorcycles remain once it has been dequeued
+	if (frontVehicle != 0 && frontVehicle == lastBike) {
+		lastBike = 0;
+	}
+	return SimpleLane::dequeue();
+}
+
+void ExpressLane::enqueueRange(Vehicle* const* vehicles, unsigned int n) {
+	// Each vehicle needs the motorcycle rule applied, but the calls are not dispatched virtually
+	for (unsigned int i = 0; i < n; i++) {
+		ExpressLane::enqueue(vehicles[i]);
+	}
+}
+
+unsigned int ExpressLane::dequeueInto(Vehicle** buffer, unsigned int max) {
+	unsigned int n = 0;
+	while (n < max && frontVehicle != 0) {
+		if (frontVehicle == lastBike) {
+			lastBike = 0;
+		}
+		buffer[n++] = SimpleLane::dequeue();
+	}
+	return n;
+}
+
+void ExpressLane::spliceFrom(Lane& other) {
+	// Only another ExpressLane is known to have its motorcycles grouped at the front
+	if (typeid(other) != typeid(ExpressLane)) {
+		Lane::spliceFrom(other);
+		return;
+	}
+	ExpressLane &source = static_cast<ExpressLane&>(other);
+	if (&source == this || source.frontVehicle == 0) {
+		return;
+	}
+
+	// Split the source into its motorcycles and the cars/buses behind them
+	Node *bikesFirst = 0;
+	Node *carsFirst = source.frontVehicle;
+	if (source.lastBike != 0) {
+		bikesFirst = source.frontVehicle;
+		carsFirst = source.lastBike->getNext();
+		source.lastBike->setNext(0);
+	}
 
+	// Cars and buses go to the back of the lane
+	if (carsFirst != 0) {
+		if (frontVehicle == 0) {
+			frontVehicle = carsFirst;
+		}
+		else {
+			lastVehicle->setNext(carsFirst);
+		}
+		lastVehicle = source.lastVehicle;
+	}
+
+	// Motorcycles go behind the last bike, or to the front if there are no bikes
+	if (bikesFirst != 0) {
+		if (lastBike != 0) {
+			source.lastBike->setNext(lastBike->getNext());
+			lastBike->setNext(bikesFirst);
+			if (lastVehicle == lastBike) {
+				lastVehicle = source.lastBike;
 			}
 		}
-		// Adding car/bus to the end
 		else {
-			lastVehicle->setNext(nodeToAdd);
-			lastVehicle = nodeToAdd;
+			source.lastBike->setNext(frontVehicle);
+			frontVehicle = bikesFirst;
+			if (lastVehicle == 0) {
+				lastVehicle = source.lastBike;
+			}
 		}
+		lastBike = source.lastBike;
 	}
-	// sum of the total vehicles is incremented
-	sum++;
+	sum += source.sum;
+	recordSplice(source, source.sum, sum);
+
+	source.frontVehicle = 0;
+	source.lastVehicle = 0;
+	source.lastBike = 0;
+	source.sum = 0;
 }
@@ -9,10 +9,45 @@ The ExpressLane class simulates a single lane of a road. It is a FIFO queue for
 ExpressLane implements the same behavior as SimpleLane, except when a Vehicle of type VT_MOTORCYCLE is enqueued, that
 Vehicle is inserted ahead of all Vehicles of type VT_CAR and VT_BUS, but behind other motorcycles that have already been
 enqueued.
+
+The lane keeps a pointer to the node of the last queued motorcycle, so all enqueues and dequeues are O(1).
 */
-class ExpressLane : public SimpleLane {
+class ExpressLane final : public SimpleLane {
+protected:
+	// Node of the last motorcycle in the queue, or 0 if there are no motorcycles queued
+	Node *lastBike;
 public:
+	/*
+	Create a new empty express lane.
+	*/
+	ExpressLane();
+
+	/*
+	Add a Vehicle to the lane. Motorcycles are placed behind the last queued motorcycle, other vehicles at the back.
+	*/
 	void enqueue(Vehicle* vehicle);
+
+	/*
+	Remove a vehicle from the front of the lane, returning a pointer to the removed vehicle. If there is no vehicle to
+	remove, this method returns 0 instead.
+	*/
+	Vehicle* dequeue();
+
+	/*
+	Add `n` vehicles to the lane, in order, applying the motorcycle rule to each of them.
+	*/
+	void enqueueRange(Vehicle* const* vehicles, unsigned int n);
+
+	/*
+	Remove up to `max` vehicles from the front of the lane into `buffer`, returning the number removed.
+	*/
+	unsigned int dequeueInto(Vehicle** buffer, unsigned int max);
+
+	/*
+	Move every vehicle from `other` into this lane. If `other` is also an ExpressLane, its motorcycles are linked in
+	behind this lane's motorcycles and its cars and buses at the back, in O(1) time.
+	*/
+	void spliceFrom(Lane& other);
 };
 
 #endif /* end of include guard: EXPRESSLANE_HPP */
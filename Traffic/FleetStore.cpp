@@ -0,0 +1,352 @@
+#include "FleetStore.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FLEETSTORE_X86
+#include <immintrin.h>
+#endif
+
+static const unsigned int TYPE_COUNT = Vehicle::VT_INVALID + 1;
+
+/*
+Plain loops, used on CPUs without SIMD support and for the rows left over after the vector loops.
+*/
+static unsigned long long occupantsOfScalar(const unsigned char* types, const unsigned int* occupants, unsigned int n,
+	unsigned int type) {
+	unsigned long long sum = 0;
+	for (unsigned int i = 0; i < n; i++) {
+		sum += types[i] == type ? occupants[i] : 0;
+	}
+	return sum;
+}
+
+static void countByTypeScalar(const unsigned char* types, unsigned int n, unsigned int* counts) {
+	for (unsigned int i = 0; i < n; i++) {
+		counts[types[i]]++;
+	}
+}
+
+static unsigned int countNonZeroScalar(const unsigned int* values, unsigned int n) {
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < n; i++) {
+		count += values[i] != 0;
+	}
+	return count;
+}
+
+static void histogramScalar(const unsigned int* values, unsigned int n, unsigned int* buckets, unsigned int bucketCount) {
+	for (unsigned int i = 0; i < n; i++) {
+		buckets[std::min(values[i], bucketCount - 1)]++;
+	}
+}
+
+#ifdef FLEETSTORE_X86
+/*
+SSE2 versions, four rows at a time.
+*/
+static __m128i loadTypesSse2(const unsigned char* types) {
+	int raw;
+	std::memcpy(&raw, types, sizeof(raw));
+	__m128i zero = _mm_setzero_si128();
+	return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(raw), zero), zero);
+}
+
+static unsigned int sumLanesSse2(__m128i v) {
+	unsigned int lanes[4];
+	_mm_storeu_si128((__m128i*)lanes, v);
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+static unsigned long long occupantsOfSse2(const unsigned char* types, const unsigned int* occupants, unsigned int n,
+	unsigned int type) {
+	__m128i zero = _mm_setzero_si128();
+	__m128i want = _mm_set1_epi32(type);
+	__m128i sum = zero;
+	unsigned int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i match = _mm_cmpeq_epi32(loadTypesSse2(types + i), want);
+		__m128i selected = _mm_and_si128(match, _mm_loadu_si128((const __m128i*)(occupants + i)));
+		// widen to 64 bits so large fleets cannot overflow
+		sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(selected, zero));
+		sum = _mm_add_epi64(sum, _mm_unpackhi_epi32(selected, zero));
+	}
+	unsigned long long lanes[2];
+	_mm_storeu_si128((__m128i*)lanes, sum);
+	return lanes[0] + lanes[1] + occupantsOfScalar(types + i, occupants + i, n - i, type);
+}
+
+static void countByTypeSse2(const unsigned char* types, unsigned int n, unsigned int* counts) {
+	__m128i totals[TYPE_COUNT];
+	for (unsigned int t = 0; t < TYPE_COUNT; t++) {
+		totals[t] = _mm_setzero_si128();
+	}
+	unsigned int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i value = loadTypesSse2(types + i);
+		for (unsigned int t = 0; t < TYPE_COUNT; t++) {
+			// a match is all ones, i.e. -1, so subtracting it counts it
+			totals[t] = _mm_sub_epi32(totals[t], _mm_cmpeq_epi32(value, _mm_set1_epi32(t)));
+		}
+	}
+	for (unsigned int t = 0; t < TYPE_COUNT; t++) {
+		counts[t] += sumLanesSse2(totals[t]);
+	}
+	countByTypeScalar(types + i, n - i, counts);
+}
+
+static unsigned int countNonZeroSse2(const unsigned int* values, unsigned int n) {
+	__m128i zeros = _mm_setzero_si128();
+	unsigned int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i value = _mm_loadu_si128((const __m128i*)(values + i));
+		zeros = _mm_sub_epi32(zeros, _mm_cmpeq_epi32(value, _mm_setzero_si128()));
+	}
+	return i - sumLanesSse2(zeros) + countNonZeroScalar(values + i, n - i);
+}
+
+static void histogramSse2(const unsigned int* values, unsigned int n, unsigned int* buckets, unsigned int bucketCount) {
+	__m128i totals[16];
+	for (unsigned int b = 0; b < bucketCount; b++) {
+		totals[b] = _mm_setzero_si128();
+	}
+	// SSE2 has no unsigned compare, so both sides are shifted into signed range first
+	__m128i bias = _mm_set1_epi32(0x80000000);
+	__m128i last = _mm_set1_epi32(bucketCount - 1);
+	__m128i biasedLast = _mm_xor_si128(last, bias);
+	unsigned int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i value = _mm_loadu_si128((const __m128i*)(values + i));
+		__m128i over = _mm_cmpgt_epi32(_mm_xor_si128(value, bias), biasedLast);
+		value = _mm_or_si128(_mm_andnot_si128(over, value), _mm_and_si128(over, last));
+		for (unsigned int b = 0; b < bucketCount; b++) {
+			totals[b] = _mm_sub_epi32(totals[b], _mm_cmpeq_epi32(value, _mm_set1_epi32(b)));
+		}
+	}
+	for (unsigned int b = 0; b < bucketCount; b++) {
+		buckets[b] += sumLanesSse2(totals[b]);
+	}
+	histogramScalar(values + i, n - i, buckets, bucketCount);
+}
+
+/*
+AVX2 versions, eight rows at a time. They are compiled for AVX2 individually so the rest of the build needs no extra
+flags, and only called when the CPU supports it.
+*/
+__attribute__((target("avx2"))) static __m256i loadTypesAvx2(const unsigned char* types) {
+	return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)types));
+}
+
+__attribute__((target("avx2"))) static unsigned int sumLanesAvx2(__m256i v) {
+	unsigned int lanes[8];
+	_mm256_storeu_si256((__m256i*)lanes, v);
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+}
+
+__attribute__((target("avx2"))) static unsigned long long occupantsOfAvx2(const unsigned char* types,
+	const unsigned int* occupants, unsigned int n, unsigned int type) {
+	__m256i want = _mm256_set1_epi32(type);
+	__m256i sumLow = _mm256_setzero_si256();
+	__m256i sumHigh = _mm256_setzero_si256();
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i match = _mm256_cmpeq_epi32(loadTypesAvx2(types + i), want);
+		__m256i selected = _mm256_and_si256(match, _mm256_loadu_si256((const __m256i*)(occupants + i)));
+		// widen to 64 bits so large fleets cannot overflow
+		sumLow = _mm256_add_epi64(sumLow, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(selected)));
+		sumHigh = _mm256_add_epi64(sumHigh, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(selected, 1)));
+	}
+	unsigned long long lanes[4];
+	_mm256_storeu_si256((__m256i*)lanes, _mm256_add_epi64(sumLow, sumHigh));
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + occupantsOfScalar(types + i, occupants + i, n - i, type);
+}
+
+__attribute__((target("avx2"))) static void countByTypeAvx2(const unsigned char* types, unsigned int n,
+	unsigned int* counts) {
+	__m256i totals[TYPE_COUNT];
+	for (unsigned int t = 0; t < TYPE_COUNT; t++) {
+		totals[t] = _mm256_setzero_si256();
+	}
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i value = loadTypesAvx2(types + i);
+		for (unsigned int t = 0; t < TYPE_COUNT; t++) {
+			totals[t] = _mm256_sub_epi32(totals[t], _mm256_cmpeq_epi32(value, _mm256_set1_epi32(t)));
+		}
+	}
+	for (unsigned int t = 0; t < TYPE_COUNT; t++) {
+		counts[t] += sumLanesAvx2(totals[t]);
+	}
+	countByTypeScalar(types + i, n - i, counts);
+}
+
+__attribute__((target("avx2"))) static unsigned int countNonZeroAvx2(const unsigned int* values, unsigned int n) {
+	__m256i zeros = _mm256_setzero_si256();
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i value = _mm256_loadu_si256((const __m256i*)(values + i));
+		zeros = _mm256_sub_epi32(zeros, _mm256_cmpeq_epi32(value, _mm256_setzero_si256()));
+	}
+	return i - sumLanesAvx2(zeros) + countNonZeroScalar(values + i, n - i);
+}
+
+__attribute__((target("avx2"))) static void histogramAvx2(const unsigned int* values, unsigned int n,
+	unsigned int* buckets, unsigned int bucketCount) {
+	__m256i totals[16];
+	for (unsigned int b = 0; b < bucketCount; b++) {
+		totals[b] = _mm256_setzero_si256();
+	}
+	__m256i last = _mm256_set1_epi32(bucketCount - 1);
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i value = _mm256_min_epu32(_mm256_loadu_si256((const __m256i*)(values + i)), last);
+		for (unsigned int b = 0; b < bucketCount; b++) {
+			totals[b] = _mm256_sub_epi32(totals[b], _mm256_cmpeq_epi32(value, _mm256_set1_epi32(b)));
+		}
+	}
+	for (unsigned int b = 0; b < bucketCount; b++) {
+		buckets[b] += sumLanesAvx2(totals[b]);
+	}
+	histogramScalar(values + i, n - i, buckets, bucketCount);
+}
+#endif
+
+FleetStore::FleetStore()
+	: typeColumn(0), occupantColumn(0), turnsLeftColumn(0), laneColumn(0), entryTickColumn(0), rows(0), capacity(0),
+	  simd(supportedSimdLevel()) {
+}
+
+FleetStore::~FleetStore() {
+	delete[] typeColumn;
+	delete[] occupantColumn;
+	delete[] turnsLeftColumn;
+	delete[] laneColumn;
+	delete[] entryTickColumn;
+}
+
+unsigned int FleetStore::add(Vehicle::Type type, unsigned int occupants, unsigned int turnsLeft, unsigned int lane,
+	unsigned int entryTick) {
+	if (rows == capacity) {
+		grow(rows + 1);
+	}
+	typeColumn[rows] = (unsigned char)type;
+	occupantColumn[rows] = occupants;
+	turnsLeftColumn[rows] = turnsLeft;
+	laneColumn[rows] = lane;
+	entryTickColumn[rows] = entryTick;
+	return rows++;
+}
+
+unsigned int FleetStore::add(const Vehicle& vehicle, unsigned int lane, unsigned int entryTick) {
+	return add(vehicle.type(), vehicle.occupantCount(), vehicle.turnsLeft(), lane, entryTick);
+}
+
+void FleetStore::addLane(const Lane& source, unsigned int lane, unsigned int entryTick) {
+	grow(rows + source.count());
+	for (Lane::const_iterator it = source.begin(); it != source.end(); ++it) {
+		add(**it, lane, entryTick);
+	}
+}
+
+void FleetStore::clear() {
+	rows = 0;
+}
+
+unsigned long long FleetStore::occupantsOf(Vehicle::Type type) const {
+	switch (simd) {
+#ifdef FLEETSTORE_X86
+		case SL_AVX2: return occupantsOfAvx2(typeColumn, occupantColumn, rows, type);
+		case SL_SSE2: return occupantsOfSse2(typeColumn, occupantColumn, rows, type);
+#endif
+		default: return occupantsOfScalar(typeColumn, occupantColumn, rows, type);
+	}
+}
+
+void FleetStore::countByType(unsigned int counts[Vehicle::VT_INVALID + 1]) const {
+	for (unsigned int t = 0; t < TYPE_COUNT; t++) {
+		counts[t] = 0;
+	}
+	switch (simd) {
+#ifdef FLEETSTORE_X86
+		case SL_AVX2: countByTypeAvx2(typeColumn, rows, counts); break;
+		case SL_SSE2: countByTypeSse2(typeColumn, rows, counts); break;
+#endif
+		default: countByTypeScalar(typeColumn, rows, counts); break;
+	}
+}
+
+unsigned int FleetStore::countWithTurnsLeft() const {
+	switch (simd) {
+#ifdef FLEETSTORE_X86
+		case SL_AVX2: return countNonZeroAvx2(turnsLeftColumn, rows);
+		case SL_SSE2: return countNonZeroSse2(turnsLeftColumn, rows);
+#endif
+		default: return countNonZeroScalar(turnsLeftColumn, rows);
+	}
+}
+
+void FleetStore::turnsLeftHistogram(unsigned int* buckets, unsigned int bucketCount) const {
+	if (bucketCount == 0) {
+		return;
+	}
+	for (unsigned int b = 0; b < bucketCount; b++) {
+		buckets[b] = 0;
+	}
+	// The vector versions keep one register of counters per bucket, so only short histograms use them
+	SimdLevel level = bucketCount <= 16 ? simd : SL_SCALAR;
+	switch (level) {
+#ifdef FLEETSTORE_X86
+		case SL_AVX2: histogramAvx2(turnsLeftColumn, rows, buckets, bucketCount); break;
+		case SL_SSE2: histogramSse2(turnsLeftColumn, rows, buckets, bucketCount); break;
+#endif
+		default: histogramScalar(turnsLeftColumn, rows, buckets, bucketCount); break;
+	}
+}
+
+void FleetStore::setSimdLevel(SimdLevel level) {
+	simd = std::min(level, supportedSimdLevel());
+}
+
+FleetStore::SimdLevel FleetStore::supportedSimdLevel() {
+#ifdef FLEETSTORE_X86
+	if (__builtin_cpu_supports("avx2")) {
+		return SL_AVX2;
+	}
+	if (__builtin_cpu_supports("sse2")) {
+		return SL_SSE2;
+	}
+#endif
+	return SL_SCALAR;
+}
+
+void FleetStore::grow(unsigned int minimum) {
+	if (minimum <= capacity) {
+		return;
+	}
+	unsigned int newCapacity = capacity != 0 ? capacity : 64;
+	while (newCapacity < minimum) {
+		newCapacity *= 2;
+	}
+	unsigned char* newTypes = new unsigned char[newCapacity];
+	unsigned int* newOccupants = new unsigned int[newCapacity];
+	unsigned int* newTurnsLeft = new unsigned int[newCapacity];
+	unsigned int* newLanes = new unsigned int[newCapacity];
+	unsigned int* newEntryTicks = new unsigned int[newCapacity];
+	std::copy(typeColumn, typeColumn + rows, newTypes);
+	std::copy(occupantColumn, occupantColumn + rows, newOccupants);
+	std::copy(turnsLeftColumn, turnsLeftColumn + rows, newTurnsLeft);
+	std::copy(laneColumn, laneColumn + rows, newLanes);
+	std::copy(entryTickColumn, entryTickColumn + rows, newEntryTicks);
+	delete[] typeColumn;
+	delete[] occupantColumn;
+	delete[] turnsLeftColumn;
+	delete[] laneColumn;
+	delete[] entryTickColumn;
+	typeColumn = newTypes;
+	occupantColumn = newOccupants;
+	turnsLeftColumn = newTurnsLeft;
+	laneColumn = newLanes;
+	entryTickColumn = newEntryTicks;
+	capacity = newCapacity;
+}
@@ -0,0 +1,203 @@
+#ifndef FLEETSTORE_HPP
+#define FLEETSTORE_HPP
+
+#include "Lane.hpp"
+#include "Vehicle.hpp"
+
+class FleetStore;
+
+/*
+A read-only view of one vehicle's row in a FleetStore, with the same accessors as the matching Vehicle methods.
+*/
+class FleetRow {
+public:
+	FleetRow(const FleetStore& store, unsigned int index) : store(&store), index(index) {
+	}
+
+	Vehicle::Type type() const;
+	unsigned int occupantCount() const;
+	unsigned int turnsLeft() const;
+	unsigned int lane() const;
+	unsigned int entryTick() const;
+
+private:
+	const FleetStore* store;
+	unsigned int index;
+};
+
+/*
+The FleetStore class keeps a column-wise (structure of arrays) record of a fleet of vehicles: type, occupant count,
+turns left on the route, the lane the vehicle is in and the tick it entered that lane. Each vehicle is a row, and each
+field is a separate contiguous array, so questions about the whole fleet read only the columns they need, in order.
+
+The aggregate queries use AVX2 or SSE2 when the CPU supports them, chosen at run time, and plain loops otherwise; every
+level gives the same results. Vehicles themselves still live in lanes: the store is filled from them (e.g. with
+addLane()) and kept up to date by whoever moves them, and it never refers back to the Vehicle objects.
+*/
+class FleetStore {
+public:
+	/*
+	Instruction set used by the aggregate queries, from slowest to fastest.
+	*/
+	enum SimdLevel { SL_SCALAR, SL_SSE2, SL_AVX2 };
+
+	/*
+	Create a new empty store, using the fastest SIMD level the CPU supports.
+	*/
+	FleetStore();
+
+	/*
+	Destroy the store and release its columns.
+	*/
+	~FleetStore();
+
+	/*
+	Add a row and return its index. Rows are numbered from 0 in the order they are added.
+	*/
+	unsigned int add(Vehicle::Type type, unsigned int occupants, unsigned int turnsLeft, unsigned int lane,
+		unsigned int entryTick);
+
+	/*
+	Add a row for `vehicle`, which is in lane number `lane` and entered it at tick `entryTick`, and return its index.
+	*/
+	unsigned int add(const Vehicle& vehicle, unsigned int lane, unsigned int entryTick);
+
+	/*
+	Add a row for every vehicle queued in `source`, front to back, all recorded as being in lane number `lane`.
+	*/
+	void addLane(const Lane& source, unsigned int lane, unsigned int entryTick);
+
+	/*
+	Remove every row, keeping the storage for reuse.
+	*/
+	void clear();
+
+	/*
+	Get the number of rows.
+	*/
+	unsigned int count() const {
+		return rows;
+	}
+
+	/*
+	Get a view of row `index`.
+	*/
+	FleetRow row(unsigned int index) const {
+		return FleetRow(*this, index);
+	}
+
+	/*
+	Update the fields of row `index` that change as a vehicle travels.
+	*/
+	void setOccupants(unsigned int index, unsigned int occupants) {
+		occupantColumn[index] = occupants;
+	}
+	void setTurnsLeft(unsigned int index, unsigned int turnsLeft) {
+		turnsLeftColumn[index] = turnsLeft;
+	}
+	void setLane(unsigned int index, unsigned int lane, unsigned int entryTick) {
+		laneColumn[index] = lane;
+		entryTickColumn[index] = entryTick;
+	}
+
+	/*
+	Direct access to the columns, each count() entries long.
+	*/
+	const unsigned char* types() const {
+		return typeColumn;
+	}
+	const unsigned int* occupants() const {
+		return occupantColumn;
+	}
+	const unsigned int* turnsLeft() const {
+		return turnsLeftColumn;
+	}
+	const unsigned int* lanes() const {
+		return laneColumn;
+	}
+	const unsigned int* entryTicks() const {
+		return entryTickColumn;
+	}
+
+	/*
+	Get the total number of occupants of vehicles of type `type`.
+	*/
+	unsigned long long occupantsOf(Vehicle::Type type) const;
+
+	/*
+	Count the vehicles of each type into `counts`, indexed by Vehicle::Type.
+	*/
+	void countByType(unsigned int counts[Vehicle::VT_INVALID + 1]) const;
+
+	/*
+	Get the number of vehicles that still have at least one turn left.
+	*/
+	unsigned int countWithTurnsLeft() const;
+
+	/*
+	Count the vehicles by number of turns left into `buckets[0]` to `buckets[bucketCount - 1]`. The last bucket also
+	counts every vehicle with more turns left than that.
+	*/
+	void turnsLeftHistogram(unsigned int* buckets, unsigned int bucketCount) const;
+
+	/*
+	Get the SIMD level the aggregate queries use.
+	*/
+	SimdLevel simdLevel() const {
+		return simd;
+	}
+
+	/*
+	Choose the SIMD level for the aggregate queries, e.g. to compare levels. Levels the CPU does not support are lowered
+	to the best one it does.
+	*/
+	void setSimdLevel(SimdLevel level);
+
+	/*
+	Get the fastest SIMD level the CPU supports.
+	*/
+	static SimdLevel supportedSimdLevel();
+
+private:
+	/*
+	Private copy constructor and copy assignment operator - stores own their columns and cannot be copied.
+	*/
+	FleetStore(const FleetStore&);
+	FleetStore& operator=(const FleetStore&);
+
+	/*
+	Make room for at least `minimum` rows, doubling the columns.
+	*/
+	void grow(unsigned int minimum);
+
+	unsigned char* typeColumn;
+	unsigned int* occupantColumn;
+	unsigned int* turnsLeftColumn;
+	unsigned int* laneColumn;
+	unsigned int* entryTickColumn;
+	unsigned int rows;
+	unsigned int capacity;
+	SimdLevel simd;
+};
+
+inline Vehicle::Type FleetRow::type() const {
+	return (Vehicle::Type)store->types()[index];
+}
+
+inline unsigned int FleetRow::occupantCount() const {
+	return store->occupants()[index];
+}
+
+inline unsigned int FleetRow::turnsLeft() const {
+	return store->turnsLeft()[index];
+}
+
+inline unsigned int FleetRow::lane() const {
+	return store->lanes()[index];
+}
+
+inline unsigned int FleetRow::entryTick() const {
+	return store->entryTicks()[index];
+}
+
+#endif /* end of include guard: FLEETSTORE_HPP */
@@ -0,0 +1,253 @@
+#ifndef GIVEWAY_HPP
+#define GIVEWAY_HPP
+
+#include "Vehicle.hpp"
+
+/*
+Finds the index of the lane a vehicle leaves through, given the index of the lane it arrived from and its turn
+direction.
+*/
+constexpr int enqueueLane(int index, Vehicle::TurnDirection dir) {
+	// Finds the index of the outgoing lane. Left will mean incrementing an index where as right will mean decrementing and
+	// straight will mean adding 2 to the index.
+	if (dir == Vehicle::TD_LEFT) {
+		index++;
+	}
+	else if (dir == Vehicle::TD_RIGHT) {
+		index--;
+	}
+	else if (dir == Vehicle::TD_STRAIGHT) {
+		index = index + 2;
+	}
+	// Solves the problem of indexes going out of range to invalid indexes.
+	if (index > 3) {
+		index = index - 4;
+	}
+	else if (index < 0) {
+		index = index + 4;
+	}
+	return index;
+}
+
+/*
+The GiveWay class describes the give way decision of a four-way intersection as a lookup table, so an intersection can
+decide which vehicles proceed with one load instead of a chain of comparisons. The tables themselves are GiveWayTable
+instances, one per rule set.
+
+A table is indexed by a key describing the vehicles waiting at the front of the incoming lanes (lanes are numbered
+north 0, east 1, south 2, west 3):
+ - bits 0-3 are set for each incoming lane that has a vehicle waiting;
+ - bits 4 + 2 * i and 5 + 2 * i hold the Vehicle::TurnDirection of the vehicle waiting in lane i, or 0 if there is none.
+Each entry gives the lanes whose front vehicle proceeds in bits 0-3, and in bits 4 + 2 * i and 5 + 2 * i the lane the
+vehicle from lane i leaves through.
+*/
+class GiveWay {
+public:
+	/*
+	The number of keys, and so of table entries.
+	*/
+	static const unsigned int TABLE_SIZE = 1 << 12;
+
+	/*
+	Build the key for the vehicles waiting in the lanes set in `waiting`, where `turns[i]` is the next turn of the
+	vehicle waiting in lane i. Turns for lanes not in `waiting` are ignored.
+	*/
+	static constexpr unsigned int key(unsigned int waiting, const Vehicle::TurnDirection turns[4]) {
+		unsigned int result = waiting;
+		for (unsigned int i = 0; i < 4; i++) {
+			if (waiting & (1 << i)) {
+				result |= (unsigned int)turns[i] << (4 + 2 * i);
+			}
+		}
+		return result;
+	}
+
+	/*
+	Get the set of lanes with a vehicle waiting, as bits 0-3, from a key.
+	*/
+	static constexpr unsigned int waiting(unsigned int key) {
+		return key & 15;
+	}
+
+	/*
+	Get the turn of the vehicle waiting in lane `lane` from a key.
+	*/
+	static constexpr Vehicle::TurnDirection turn(unsigned int key, int lane) {
+		return (Vehicle::TurnDirection)((key >> (4 + 2 * lane)) & 3);
+	}
+
+	/*
+	Get the set of lanes whose front vehicle proceeds, as bits 0-3, from a table entry.
+	*/
+	static constexpr unsigned int proceeding(unsigned int entry) {
+		return entry & 15;
+	}
+
+	/*
+	Get the lane the vehicle from lane `from` leaves through, from a table entry.
+	*/
+	static constexpr int destination(unsigned int entry, int from) {
+		return (entry >> (4 + 2 * from)) & 3;
+	}
+
+	/*
+	The decision shared by the built-in rule sets, which differ only in which turn crosses oncoming traffic:
+	 - A vehicle alone at the intersection proceeds.
+	 - Two vehicles making the same turn both proceed. Otherwise the one going straight proceeds, or failing that the
+	   one making `favouredTurn` (the turn that does not cross oncoming traffic), or failing that the one in the lower
+	   numbered lane.
+	 - With three or four vehicles waiting, the vehicle going straight in the highest numbered lane proceeds, or
+	   failing that the one in the lowest numbered lane.
+	A vehicle with no turns left (TD_INVALID) counts as neither straight nor favoured, and goes back into its own lane.
+	*/
+	static constexpr unsigned int standardRules(unsigned int key, Vehicle::TurnDirection favouredTurn) {
+		// Collect the waiting lanes in order, and the turn of each waiting vehicle
+		int lanes[4] = {};
+		Vehicle::TurnDirection turns[4] = {};
+		int count = 0;
+		for (int i = 0; i < 4; i++) {
+			if (key & (1 << i)) {
+				lanes[count] = i;
+				turns[count] = turn(key, i);
+				count++;
+			}
+		}
+
+		// Choose which of the waiting vehicles proceed, as positions in `lanes`
+		unsigned int chosen = 0;
+		if (count == 1) {
+			chosen = 1;
+		}
+		else if (count == 2) {
+			if (turns[0] == turns[1]) {
+				chosen = 3;
+			}
+			else {
+				int straight = -1;
+				int favoured = 0;
+				for (int i = 0; i < 2; i++) {
+					if (turns[i] == Vehicle::TD_STRAIGHT) {
+						straight = i;
+					}
+					if (turns[i] == favouredTurn) {
+						favoured = i;
+					}
+				}
+				chosen = 1 << (straight >= 0 ? straight : favoured);
+			}
+		}
+		else if (count > 2) {
+			int straight = 0;
+			for (int i = 0; i < count; i++) {
+				if (turns[i] == Vehicle::TD_STRAIGHT) {
+					straight = i;
+				}
+			}
+			chosen = 1 << straight;
+		}
+
+		unsigned int entry = 0;
+		for (int i = 0; i < count; i++) {
+			if (chosen & (1 << i)) {
+				entry |= 1 << lanes[i];
+				entry |= (unsigned int)enqueueLane(lanes[i], turns[i]) << (4 + 2 * lanes[i]);
+			}
+		}
+		return entry;
+	}
+
+	/*
+	Check that a rule set never deadlocks: whenever a vehicle is waiting at least one proceeds, and only waiting
+	vehicles do.
+	*/
+	static constexpr bool deadlockFree(const unsigned short* entries) {
+		for (unsigned int key = 0; key < TABLE_SIZE; key++) {
+			unsigned int moving = proceeding(entries[key]);
+			if ((moving & ~waiting(key)) != 0 || (moving != 0) != (waiting(key) != 0)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/*
+	Check that a rule set never sends two vehicles into the same lane in one step.
+	*/
+	static constexpr bool conflictFree(const unsigned short* entries) {
+		for (unsigned int key = 0; key < TABLE_SIZE; key++) {
+			unsigned int used = 0;
+			for (int i = 0; i < 4; i++) {
+				if (proceeding(entries[key]) & (1 << i)) {
+					unsigned int lane = 1 << destination(entries[key], i);
+					if (used & lane) {
+						return false;
+					}
+					used |= lane;
+				}
+			}
+		}
+		return true;
+	}
+};
+
+/*
+The give way rules for traffic driving on the left, as in New Zealand: right-turning vehicles cross oncoming traffic, so
+they give way to vehicles turning left or going straight, and left-turning vehicles give way to vehicles going
+straight. These are the rules intersections use unless told otherwise.
+*/
+struct LeftHandTraffic {
+	static constexpr unsigned int decide(unsigned int key) {
+		return GiveWay::standardRules(key, Vehicle::TD_LEFT);
+	}
+};
+
+/*
+The give way rules for traffic driving on the right: left-turning vehicles give way to vehicles turning right or going
+straight, and right-turning vehicles give way to vehicles going straight.
+*/
+struct RightHandTraffic {
+	static constexpr unsigned int decide(unsigned int key) {
+		return GiveWay::standardRules(key, Vehicle::TD_RIGHT);
+	}
+};
+
+/*
+The entries of a give way table, generated at compile time from a rule set's decide() function.
+*/
+struct GiveWayEntries {
+	unsigned short entries[GiveWay::TABLE_SIZE];
+};
+
+template <class Rules>
+constexpr GiveWayEntries buildGiveWayEntries() {
+	GiveWayEntries result = {};
+	for (unsigned int key = 0; key < GiveWay::TABLE_SIZE; key++) {
+		result.entries[key] = (unsigned short)Rules::decide(key);
+	}
+	return result;
+}
+
+/*
+The give way table for a rule set. A rule set is a class with a constexpr `static unsigned int decide(unsigned int key)`
+returning the table entry for a key (see GiveWay); the table is built from it by the compiler and checked to be
+deadlock-free and conflict-free, so a rule set that could stall an intersection or merge two vehicles into one lane
+does not compile.
+*/
+template <class Rules>
+class GiveWayTable {
+public:
+	/*
+	Get the table entry for `key`.
+	*/
+	static unsigned int lookup(unsigned int key) {
+		return table.entries[key];
+	}
+
+private:
+	static constexpr GiveWayEntries table = buildGiveWayEntries<Rules>();
+
+	static_assert(GiveWay::deadlockFree(table.entries), "give way rules let no vehicle proceed for some key");
+	static_assert(GiveWay::conflictFree(table.entries), "give way rules send two vehicles into the same lane");
+};
+
+#endif /* end of include guard: GIVEWAY_HPP */
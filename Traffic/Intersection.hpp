@@ -2,9 +2,9 @@
 #define INTERSECTION_HPP
 
 #include "Vehicle.hpp"
-// forward declaration
-//class Lane;
+#include "GiveWay.hpp"
 #include "Lane.hpp"
+#include "IntersectionTiming.hpp"
 
 /*
 The Intersection class aggregates a set of lanes together to simulate traffic flow through an intersection. Traffic may
@@ -15,8 +15,20 @@ If a lane is connected as an incoming lane, traffic may be dequeued from that la
 `simulate` method is called. If a lane is connected as an outgoing lane, traffic may be enqueued into that lane each
 time the Intersection's `simulate` method is called. What lanes vehicles flow from and to each time `simulate` is called
 will be determined by the Vehicle's `nextTurn` method and the give way rules that apply to the intersection.
+
+BasicIntersection is written against a lane type `LaneT`. `Intersection` is BasicIntersection<Lane>, which accepts any
+kind of Lane and calls it through virtual functions. A network built from a single concrete lane type, such as
+BasicIntersection<ExpressLane> or BasicIntersection<RingLane>, calls that type's methods directly so that `simulate` can
+be inlined.
+
+The give way rules are a second template parameter, `Rules`, which defaults to LeftHandTraffic. A rule set is turned into
+a lookup table at compile time (see GiveWayTable), so choosing another one, e.g. BasicIntersection<Lane,
+RightHandTraffic>, costs nothing per tick.
+
+Every intersection records how long the vehicles it lets through waited and how long the journeys ending there took
+(see IntersectionTiming).
 */
-class Intersection {
+class IntersectionBase {
 public:
     /*
     The LaneDirection enum is used to indicate which end of a Lane is connected to this intersection. If LD_INCOMING is
@@ -24,11 +36,15 @@ public:
     Intersection will only enqueue traffic into the Lane.
     */
     enum LaneDirection { LD_INCOMING, LD_OUTGOING };
+};
 
+template <class LaneT, class Rules = LeftHandTraffic>
+class BasicIntersection : public IntersectionBase {
+public:
     /*
     Intersection constructor. Initializes a new Intersection with no Lanes attached.
     */
-    Intersection();
+    BasicIntersection();
 
     /*
     This method is used to determine if the Intersection has been fully and properly initialized and can be used for
@@ -50,45 +66,142 @@ public:
     
     The Intersection is *not* responsible for cleaning up attached Lanes when it is destroyed.
     */
-    Lane* connectNorth(Lane* lane, LaneDirection direction);
+    LaneT* connectNorth(LaneT* lane, LaneDirection direction);
 
     /*
     This method can be used to add a Lane to the eastern side of the Intersection. The behavior of this method is
     identical to `connectNorth`, but for the eastern Lane of the Intersection.
     */
-    Lane* connectEast(Lane* lane, LaneDirection direction);
+    LaneT* connectEast(LaneT* lane, LaneDirection direction);
 
     /*
     This method can be used to add a Lane to the southern side of the Intersection. The behavior of this method is
     identical to `connectNorth`, but for the southern Lane of the Intersection.
     */
-    Lane* connectSouth(Lane* lane, LaneDirection direction);
+    LaneT* connectSouth(LaneT* lane, LaneDirection direction);
 
     /*
     This method can be used to add a Lane to the western side of the Intersection. The behavior of this method is
     identical to `connectNorth`, but for the western Lane of the Intersection.
     */
-    Lane* connectWest(Lane* lane, LaneDirection direction);
+    LaneT* connectWest(LaneT* lane, LaneDirection direction);
 
-    int enqueueLane(int index, Vehicle::TurnDirection dir);
+    /*
+    Connect a Lane by the number of its side of the Intersection: 0 north, 1 east, 2 south or 3 west. The behavior is
+    otherwise identical to `connectNorth`.
+    */
+    LaneT* connect(int index, LaneT* lane, LaneDirection direction);
 
     /*
     Execute a single simulation iteration, allowing up to one car from each incoming Lane to pass through the 
-    Intersection. The give way rules for the intersection are as follows:
+    Intersection. The default (LeftHandTraffic) give way rules for the intersection are as follows:
      - Right-turning Vehicles must give way to other Vehicles turning left or traveling straight through the
        Intersection.
      - Left-turning Vehicles must give way to other Vehicles traveling straight through the Intersection.
      - Any remaining vehicles waiting at the intersection that don't have to give way may proceed through the
        intersection.
+     - When three or four vehicles are waiting, only the one going straight in the highest numbered lane (north 0,
+       east 1, south 2, west 3) proceeds, or the one in the lowest numbered lane if none is going straight.
+    The decision is looked up in the rule set's GiveWayTable; GiveWay::standardRules lists the exact rules.
+    A vehicle that may proceed but whose outgoing Lane is full (see Lane::setCapacity) stays at the front of its
+    incoming Lane, and the vehicles that must give way to it keep waiting as well.
 
     This method should do nothing if this Intersection is not valid (i.e. the valid() method returns `false`).
     */
+    void simulate();
 
+    /*
+    Execute up to `maxPerApproach` simulation iterations at once, with the same result as calling simulate() that many
+    times within one tick, so up to `maxPerApproach` vehicles leave each incoming Lane (saturation flow). The give way
+    decisions for the whole batch are made first, from the vehicles queued at the front of the incoming Lanes, and the
+    vehicles are then moved with one dequeueInto() per incoming Lane and one enqueueRange() per outgoing Lane. Outgoing
+    Lane capacities are respected exactly as in simulate(). An iteration that would move a vehicle into an incoming
+    Lane (a vehicle with no turns left, or one turning into another incoming Lane) is run on its own with simulate().
+    */
+    void simulate(unsigned int maxPerApproach);
+
+    /*
+    Execute a single simulation iteration exactly as simulate() does, but let `router` place the vehicles that proceed:
+    `router.hasRoom(lane)` is asked in place of `!lane->full()`, and `router.deliver(lane, vehicle)` is called in place
+    of `lane->enqueue(vehicle)`. A network uses this to hold vehicles back until the end of a tick (see
+    BasicRoadNetwork::SM_SYNCHRONOUS). Returns `false` if there was nothing to do, because the Intersection is not valid
+    or no vehicle was waiting, otherwise `true`.
+    */
+    template <class Router>
+    bool simulateWith(Router& router);
+
+    /*
+    Get the time vehicles spent in an incoming lane before passing through this intersection.
+    */
+    LatencyHistogram waitTimes() const {
+        return timing.waitTimes();
+    }
+
+    /*
+    Get the journey times, from first entering a lane, of vehicles that made the last turn of their route here.
+    */
+    const LatencyHistogram& journeyTimes() const {
+        return timing.journeyTimes();
+    }
+
+    /*
+    Exchange the recorded wait and journey times with `other`, e.g. when a network moves its intersections.
+    */
+    void swapTiming(BasicIntersection& other) {
+        timing.swap(other.timing);
+    }
 
-    void simulate();
 private:
-	LaneDirection laneDirections[4];
-	Lane* lanes[4];
+	/*
+	Private copy constructor and copy assignment operator - intersections cannot be copied.
+	*/
+	BasicIntersection(const BasicIntersection&);
+	BasicIntersection& operator=(const BasicIntersection&);
+
+	/*
+	The router simulate() uses, which enqueues vehicles straight into their outgoing lanes.
+	*/
+	struct DirectRouter {
+		bool hasRoom(LaneT* lane) {
+			return !lane->full();
+		}
+		void deliver(LaneT* lane, Vehicle* vehicle) {
+			lane->enqueue(vehicle);
+		}
+	};
+
+	/*
+	Dequeue the front vehicle of lane `from`, make its turn and hand it to `router` for lane `to`, unless the router has
+	no room for it there.
+	*/
+	template <class Router>
+	void moveVehicle(int from, int to, Router& router);
+
+	/*
+	The most iterations simulate(maxPerApproach) plans at once, which bounds the vehicles it copies from each lane.
+	*/
+	static const unsigned int BATCH = 32;
+
+	/*
+	Everything simulate() reads on every tick fits in one cache line: the lanes, then bit i of `incoming` and
+	`outgoing` set when lane i is attached in that direction, and whether all four lanes are attached. They only change
+	in connect().
+	*/
+	LaneT* lanes[4];
+	unsigned char incoming;
+	unsigned char outgoing;
+	bool connected;
+	IntersectionTiming timing;
 };
 
+/*
+The polymorphic intersection, which accepts lanes of any type.
+*/
+typedef BasicIntersection<Lane> Intersection;
+
+#include "Intersection.tpp"
+
+// The polymorphic intersection is compiled once in Intersection.cpp
+extern template class BasicIntersection<Lane>;
+
 #endif /* end of include guard: INTERSECTION_HPP */
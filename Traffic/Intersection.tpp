@@ -0,0 +1,214 @@
+// Template definitions for BasicIntersection, included at the end of Intersection.hpp
+
+template <class LaneT, class Rules>
+BasicIntersection<LaneT, Rules>::BasicIntersection() {
+	// Initialise the lanes array to store NULL pointers
+	for (int i = 0; i < 4; i++) {
+		lanes[i] = 0;
+	}
+	incoming = 0;
+	outgoing = 0;
+	connected = false;
+}
+
+template <class LaneT, class Rules>
+bool BasicIntersection<LaneT, Rules>::valid() {
+	// Kept up to date by connect(), true once all four lanes are attached
+	return connected;
+}
+
+template <class LaneT, class Rules>
+LaneT* BasicIntersection<LaneT, Rules>::connect(int index, LaneT* lane, LaneDirection direction) {
+	LaneT* temp = lanes[index];
+	lanes[index] = lane;
+	// A lane counts as incoming or outgoing only while one is attached
+	incoming &= ~(1 << index);
+	outgoing &= ~(1 << index);
+	if (lane != 0) {
+		if (direction == LD_INCOMING) {
+			incoming |= 1 << index;
+		}
+		else {
+			outgoing |= 1 << index;
+		}
+	}
+	connected = (incoming | outgoing) == 15;
+	return temp;
+}
+
+template <class LaneT, class Rules>
+LaneT* BasicIntersection<LaneT, Rules>::connectNorth(LaneT* lane, LaneDirection direction) {
+	// The north lane is lane 0
+	return connect(0, lane, direction);
+}
+
+template <class LaneT, class Rules>
+LaneT* BasicIntersection<LaneT, Rules>::connectEast(LaneT* lane, LaneDirection direction) {
+	// The east lane is lane 1
+	return connect(1, lane, direction);
+}
+
+template <class LaneT, class Rules>
+LaneT* BasicIntersection<LaneT, Rules>::connectSouth(LaneT* lane, LaneDirection direction) {
+	// The south lane is lane 2
+	return connect(2, lane, direction);
+}
+
+template <class LaneT, class Rules>
+LaneT* BasicIntersection<LaneT, Rules>::connectWest(LaneT* lane, LaneDirection direction) {
+	// The west lane is lane 3
+	return connect(3, lane, direction);
+}
+
+template <class LaneT, class Rules>
+template <class Router>
+void BasicIntersection<LaneT, Rules>::moveVehicle(int from, int to, Router& router) {
+	// A vehicle whose outgoing lane is full waits at the front of its lane, and vehicles giving way to it keep waiting
+	if (to != from && !router.hasRoom(lanes[to])) {
+		return;
+	}
+	// Dequeues lane, Make turns, Enqueues in outgoing lane
+	Vehicle* toTurn = lanes[from]->dequeue();
+	timing.passThrough(toTurn);
+	router.deliver(lanes[to], toTurn);
+}
+
+template <class LaneT, class Rules>
+void BasicIntersection<LaneT, Rules>::simulate() {
+	DirectRouter router;
+	simulateWith(router);
+}
+
+template <class LaneT, class Rules>
+template <class Router>
+bool BasicIntersection<LaneT, Rules>::simulateWith(Router& router) {
+	if (!connected) {
+		return false;
+	}
+	// Describe the vehicles waiting at the front of the incoming lanes as a GiveWay key
+	unsigned int key = 0;
+	for (int i = 0; i < 4; i++) {
+		if ((incoming & (1 << i)) && lanes[i]->empty() == false) {
+			key |= (1 << i) | ((unsigned int)lanes[i]->front()->nextTurn() << (4 + 2 * i));
+		}
+	}
+	if (key == 0) {
+		return false;
+	}
+
+	// Move the vehicles allowed to proceed, in lane order
+	unsigned int entry = GiveWayTable<Rules>::lookup(key);
+	unsigned int proceeding = GiveWay::proceeding(entry);
+	for (int i = 0; i < 4; i++) {
+		if (proceeding & (1 << i)) {
+			moveVehicle(i, GiveWay::destination(entry, i), router);
+		}
+	}
+	return true;
+}
+
+template <class LaneT, class Rules>
+void BasicIntersection<LaneT, Rules>::simulate(unsigned int maxPerApproach) {
+	if (!connected) {
+		return;
+	}
+	while (maxPerApproach > 0) {
+		// Copy the vehicles at the front of each incoming lane; no more than `limit` of them can leave in this batch
+		unsigned int limit = maxPerApproach < BATCH ? maxPerApproach : BATCH;
+		const Vehicle* queued[4][BATCH];
+		unsigned int queuedCount[4] = {};
+		unsigned int taken[4] = {};
+		unsigned int room[4] = {};
+		for (int i = 0; i < 4; i++) {
+			if (incoming & (1 << i)) {
+				queuedCount[i] = lanes[i]->snapshot(queued[i], limit);
+			}
+			else if (lanes[i]->capacity() == 0) {
+				room[i] = ~0u;
+			}
+			else if (lanes[i]->count() < lanes[i]->capacity()) {
+				room[i] = lanes[i]->capacity() - lanes[i]->count();
+			}
+		}
+
+		// Make the give way decisions round by round, recording each move as its source lane, destination lane and
+		// position in the source lane, in the order simulate() would make them
+		unsigned short moves[4 * BATCH];
+		unsigned int moveCount = 0;
+		unsigned int rounds = 0;
+		bool stalled = false;
+		bool single = false;
+		for (; rounds < limit; rounds++) {
+			unsigned int key = 0;
+			for (int i = 0; i < 4; i++) {
+				if (taken[i] < queuedCount[i]) {
+					key |= (1 << i) | ((unsigned int)queued[i][taken[i]]->nextTurn() << (4 + 2 * i));
+				}
+			}
+			if (key == 0) {
+				stalled = true;
+				break;
+			}
+			unsigned int entry = GiveWayTable<Rules>::lookup(key);
+			unsigned int proceeding = GiveWay::proceeding(entry);
+			unsigned int destinations = 0;
+			for (int i = 0; i < 4; i++) {
+				if (proceeding & (1 << i)) {
+					destinations |= 1 << GiveWay::destination(entry, i);
+				}
+			}
+			// The queues copied above do not see vehicles arriving in an incoming lane
+			if (destinations & incoming) {
+				single = true;
+				break;
+			}
+			unsigned int moved = 0;
+			for (int i = 0; i < 4; i++) {
+				int to = GiveWay::destination(entry, i);
+				if ((proceeding & (1 << i)) && room[to] > 0) {
+					room[to]--;
+					moves[moveCount++] = (unsigned short)(i | (to << 2) | (taken[i] << 4));
+					taken[i]++;
+					moved++;
+				}
+			}
+			// Every later round would make the same decision and be blocked in the same way
+			if (moved == 0) {
+				stalled = true;
+				break;
+			}
+		}
+
+		// Move the vehicles, handing them to each outgoing lane in the order they were chosen
+		Vehicle* leaving[4][BATCH];
+		for (int i = 0; i < 4; i++) {
+			if (taken[i] > 0) {
+				lanes[i]->dequeueInto(leaving[i], taken[i]);
+				for (unsigned int j = 0; j < taken[i]; j++) {
+					timing.passThrough(leaving[i][j]);
+				}
+			}
+		}
+		for (int to = 0; to < 4; to++) {
+			Vehicle* arriving[4 * BATCH];
+			unsigned int arrivingCount = 0;
+			for (unsigned int m = 0; m < moveCount; m++) {
+				if (((moves[m] >> 2) & 3) == (unsigned int)to) {
+					arriving[arrivingCount++] = leaving[moves[m] & 3][moves[m] >> 4];
+				}
+			}
+			if (arrivingCount > 0) {
+				lanes[to]->enqueueRange(arriving, arrivingCount);
+			}
+		}
+
+		maxPerApproach -= rounds;
+		if (stalled) {
+			return;
+		}
+		if (single) {
+			simulate();
+			maxPerApproach--;
+		}
+	}
+}
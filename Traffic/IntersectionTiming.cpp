@@ -0,0 +1,52 @@
+#include "IntersectionTiming.hpp"
+
+IntersectionTiming::IntersectionTiming() {
+#ifndef TRAFFIC_NO_TIMING
+	for (unsigned int i = 0; i < SHORT_WAITS; i++) {
+		shortWaits[i] = 0;
+	}
+	histograms = 0;
+#endif
+}
+
+IntersectionTiming::~IntersectionTiming() {
+#ifndef TRAFFIC_NO_TIMING
+	delete histograms;
+#endif
+}
+
+LatencyHistogram IntersectionTiming::waitTimes() const {
+	LatencyHistogram waits;
+#ifndef TRAFFIC_NO_TIMING
+	if (histograms != 0) {
+		waits.merge(histograms->waits);
+	}
+	for (unsigned int i = 0; i < SHORT_WAITS; i++) {
+		waits.record(i, shortWaits[i]);
+	}
+#endif
+	return waits;
+}
+
+const LatencyHistogram& IntersectionTiming::journeyTimes() const {
+	static const LatencyHistogram none;
+#ifndef TRAFFIC_NO_TIMING
+	if (histograms != 0) {
+		return histograms->journeys;
+	}
+#endif
+	return none;
+}
+
+void IntersectionTiming::swap(IntersectionTiming& other) {
+#ifndef TRAFFIC_NO_TIMING
+	for (unsigned int i = 0; i < SHORT_WAITS; i++) {
+		unsigned int waits = shortWaits[i];
+		shortWaits[i] = other.shortWaits[i];
+		other.shortWaits[i] = waits;
+	}
+	Histograms* mine = histograms;
+	histograms = other.histograms;
+	other.histograms = mine;
+#endif
+}
@@ -0,0 +1,95 @@
+#ifndef INTERSECTIONTIMING_HPP
+#define INTERSECTIONTIMING_HPP
+
+#include "Vehicle.hpp"
+#include "LatencyHistogram.hpp"
+#include "SimClock.hpp"
+
+/*
+The IntersectionTiming class records, for one intersection, how long the vehicles it lets through waited (from entering
+their incoming lane to leaving it) and, for vehicles making the last turn of their route, how long their whole journey
+took, in ticks of the SimClock. Building with TRAFFIC_NO_TIMING defined removes the recording.
+*/
+class IntersectionTiming {
+public:
+	/*
+	Create a record with no waits or journeys in it.
+	*/
+	IntersectionTiming();
+
+	/*
+	Destroy the record and its histograms.
+	*/
+	~IntersectionTiming();
+
+	/*
+	Record the wait and journey times of `vehicle`, which has just left its incoming lane, and make its turn.
+	*/
+	void passThrough(Vehicle* vehicle);
+
+	/*
+	Get the time vehicles spent in an incoming lane before passing through the intersection.
+	*/
+	LatencyHistogram waitTimes() const;
+
+	/*
+	Get the journey times, from first entering a lane, of vehicles that made the last turn of their route here.
+	*/
+	const LatencyHistogram& journeyTimes() const;
+
+	/*
+	Exchange everything recorded with `other`.
+	*/
+	void swap(IntersectionTiming& other);
+
+private:
+	/*
+	Private copy constructor and copy assignment operator - records own their histograms and cannot be copied.
+	*/
+	IntersectionTiming(const IntersectionTiming&);
+	IntersectionTiming& operator=(const IntersectionTiming&);
+
+#ifndef TRAFFIC_NO_TIMING
+	/*
+	The histograms are large, so they are kept out of line and only allocated when first needed, which keeps arrays of
+	intersections compact. Most waits are short and are counted in shortWaits instead, inside the intersection, so the
+	common case never touches the histograms.
+	*/
+	struct Histograms {
+		LatencyHistogram waits;
+		LatencyHistogram journeys;
+	};
+	static const unsigned int SHORT_WAITS = 16;
+	unsigned int shortWaits[SHORT_WAITS];
+	Histograms* histograms;
+#endif
+};
+
+inline void IntersectionTiming::passThrough(Vehicle* vehicle) {
+#ifndef TRAFFIC_NO_TIMING
+	unsigned int now = SimClock::now();
+	if (vehicle->lastMoveTick() != Vehicle::NO_TICK) {
+		unsigned int wait = now - vehicle->lastMoveTick();
+		if (wait < SHORT_WAITS) {
+			shortWaits[wait]++;
+		}
+		else {
+			if (histograms == 0) {
+				histograms = new Histograms;
+			}
+			histograms->waits.record(wait);
+		}
+	}
+	if (vehicle->makeTurn() != Vehicle::TD_INVALID && vehicle->turnsLeft() == 0 &&
+		vehicle->journeyStartTick() != Vehicle::NO_TICK) {
+		if (histograms == 0) {
+			histograms = new Histograms;
+		}
+		histograms->journeys.record(now - vehicle->journeyStartTick());
+	}
+#else
+	vehicle->makeTurn();
+#endif
+}
+
+#endif /* end of include guard: INTERSECTIONTIMING_HPP */
@@ -0,0 +1,198 @@
+#ifndef JUNCTION_HPP
+#define JUNCTION_HPP
+
+#include "Vehicle.hpp"
+#include "Lane.hpp"
+#include "Intersection.hpp"
+#include "IntersectionTiming.hpp"
+
+/*
+The JunctionLayout class describes the movements through a junction with `N` approaches, numbered 0 to N - 1
+anticlockwise, and which of them conflict. A movement is a vehicle arriving on an approach with a given next turn, and
+is numbered 4 * approach + Vehicle::TurnDirection. Each movement has:
+ - an exit, the approach the vehicle leaves through. A movement whose exit is its own approach, such as TD_INVALID for
+   a vehicle with no turns left, or going straight on at a T-junction, sends the vehicle to the back of its own lane;
+ - a set of conflicting movements, which may not proceed in the same step;
+ - a priority; lower numbers go first.
+
+Each step, the waiting vehicles are taken in order of priority (then approach number), and a vehicle proceeds if its
+movement conflicts with none of the movements already chosen. The first vehicle always proceeds, so a junction never
+deadlocks.
+
+A layout is fixed once built and may be shared by any number of junctions. For junctions with up to four approaches
+every decision is worked out when the layout is built and looked up while simulating, as BasicIntersection does.
+*/
+template <unsigned int N>
+class JunctionLayout {
+public:
+	static_assert(N >= 1 && N <= 16, "a junction has between 1 and 16 approaches");
+
+	/*
+	The number of movements, and a set of movements as bits of an integer.
+	*/
+	static const unsigned int MOVEMENTS = 4 * N;
+	typedef unsigned long long MovementSet;
+
+	/*
+	Junctions with this many approaches or fewer decide with a lookup table.
+	*/
+	static const unsigned int TABLE_APPROACHES = 4;
+
+	/*
+	Get the number of the movement from approach `from` making turn `turn`.
+	*/
+	static unsigned int movement(unsigned int from, Vehicle::TurnDirection turn) {
+		return 4 * from + turn;
+	}
+
+	/*
+	Create the standard layout: approaches evenly spaced around the junction, a left turn leaving through the next
+	approach anticlockwise, a right turn through the previous one and going straight through the opposite one (there is
+	no straight on with fewer than four approaches). Two movements conflict if their paths cross or they leave through
+	the same approach. Vehicles going straight go first, then those turning left, then those turning right.
+	*/
+	JunctionLayout();
+
+	/*
+	Create a layout from its movements, each array indexed by movement number.
+	*/
+	JunctionLayout(const unsigned int exits[MOVEMENTS], const MovementSet conflicts[MOVEMENTS],
+		const unsigned int priorities[MOVEMENTS]);
+
+	/*
+	Destroy the layout. No junction may still be using it.
+	*/
+	~JunctionLayout();
+
+	/*
+	Get the exit, conflicting movements and priority of movement `m`.
+	*/
+	unsigned int exit(unsigned int m) const {
+		return exits[m];
+	}
+	MovementSet conflicts(unsigned int m) const {
+		return conflictSets[m];
+	}
+	unsigned int priority(unsigned int m) const {
+		return priorities[m];
+	}
+
+	/*
+	Choose which waiting vehicles proceed. `waiting` has bit i set for each approach with a vehicle waiting, and
+	`turns[i]` is that vehicle's next turn. Returns the approaches whose vehicle proceeds, as bits.
+	*/
+	unsigned int decide(unsigned int waiting, const Vehicle::TurnDirection turns[N]) const;
+
+	/*
+	For layouts with up to TABLE_APPROACHES approaches, get the decision table. It is indexed by a key made of the
+	waiting approaches in bits 0 to N - 1 and the turn of the vehicle waiting on approach i in bits N + 2 * i and
+	N + 2 * i + 1. Each entry has the approaches whose vehicle proceeds in bits 0 to N - 1, and the exit of the vehicle
+	from approach i in bits N + 2 * i and N + 2 * i + 1.
+	*/
+	const unsigned short* decisions() const {
+		return table;
+	}
+
+	/*
+	Get the layout used by junctions that are not given one.
+	*/
+	static const JunctionLayout& standard();
+
+private:
+	/*
+	Private copy constructor and copy assignment operator - layouts own their decision table and cannot be copied.
+	*/
+	JunctionLayout(const JunctionLayout&);
+	JunctionLayout& operator=(const JunctionLayout&);
+
+	/*
+	Sort the movements by priority and, for small layouts, fill the decision table.
+	*/
+	void prepare();
+
+	unsigned int exits[MOVEMENTS];
+	MovementSet conflictSets[MOVEMENTS];
+	unsigned int priorities[MOVEMENTS];
+	// Movement numbers in the order decide() considers them
+	unsigned char order[MOVEMENTS];
+	unsigned short* table;
+};
+
+/*
+The Junction class is an intersection with `N` approaches, numbered 0 to N - 1, each of which may be connected to an
+incoming or an outgoing lane. T-junctions (N = 3), five-way junctions and roundabout entries can be modelled without the
+dummy lanes a four-way Intersection would need. Which vehicles proceed each step is decided by a JunctionLayout.
+
+Like BasicIntersection, Junction is written against a lane type `LaneT`, and records wait and journey times (see
+IntersectionTiming). A Junction<4> decides with a lookup table and runs as fast as a BasicIntersection, but follows its
+layout's conflict rules rather than the four-way give way rules.
+*/
+template <unsigned int N, class LaneT = Lane>
+class Junction : public IntersectionBase {
+public:
+	/*
+	Create a junction with no lanes attached, following `layout`, which must outlive the junction.
+	*/
+	explicit Junction(const JunctionLayout<N>& layout = JunctionLayout<N>::standard());
+
+	/*
+	Return `true` if every approach has a lane attached, otherwise `false`.
+	*/
+	bool valid() const {
+		return connected;
+	}
+
+	/*
+	Attach `lane` to approach `approach` with traffic flowing in `direction`, returning the lane previously attached
+	there, or 0 if there was none. Passing 0 as `lane` detaches the approach. The junction does not destroy attached
+	lanes.
+	*/
+	LaneT* connect(unsigned int approach, LaneT* lane, LaneDirection direction);
+
+	/*
+	Execute a single simulation iteration, allowing up to one vehicle from each incoming lane to pass through the
+	junction as the layout decides. A vehicle that may proceed but whose outgoing lane is full stays at the front of its
+	incoming lane. This method does nothing if the junction is not valid.
+	*/
+	void simulate();
+
+	/*
+	Get the time vehicles spent in an incoming lane before passing through this junction.
+	*/
+	LatencyHistogram waitTimes() const {
+		return timing.waitTimes();
+	}
+
+	/*
+	Get the journey times, from first entering a lane, of vehicles that made the last turn of their route here.
+	*/
+	const LatencyHistogram& journeyTimes() const {
+		return timing.journeyTimes();
+	}
+
+private:
+	/*
+	Private copy constructor and copy assignment operator - junctions cannot be copied.
+	*/
+	Junction(const Junction&);
+	Junction& operator=(const Junction&);
+
+	/*
+	Dequeue the front vehicle of lane `from`, make its turn and enqueue it into lane `to`, unless lane `to` is full.
+	*/
+	void moveVehicle(unsigned int from, unsigned int to);
+
+	LaneT* lanes[N];
+	const JunctionLayout<N>* layout;
+	// The layout's decision table, kept here to save loading it through `layout` every step
+	const unsigned short* decisions;
+	// Bit i is set when approach i is attached in that direction
+	unsigned int incoming;
+	unsigned int outgoing;
+	bool connected;
+	IntersectionTiming timing;
+};
+
+#include "Junction.tpp"
+
+#endif /* end of include guard: JUNCTION_HPP */
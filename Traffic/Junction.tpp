@@ -0,0 +1,201 @@
+// Template definitions for JunctionLayout and Junction, included at the end of Junction.hpp
+
+template <unsigned int N>
+JunctionLayout<N>::JunctionLayout() {
+	for (unsigned int from = 0; from < N; from++) {
+		exits[movement(from, Vehicle::TD_LEFT)] = (from + 1) % N;
+		exits[movement(from, Vehicle::TD_RIGHT)] = (from + N - 1) % N;
+		exits[movement(from, Vehicle::TD_STRAIGHT)] = N >= 4 ? (from + N / 2) % N : from;
+		exits[movement(from, Vehicle::TD_INVALID)] = from;
+		priorities[movement(from, Vehicle::TD_STRAIGHT)] = 0;
+		priorities[movement(from, Vehicle::TD_LEFT)] = 1;
+		priorities[movement(from, Vehicle::TD_RIGHT)] = 2;
+		priorities[movement(from, Vehicle::TD_INVALID)] = 3;
+	}
+
+	for (unsigned int a = 0; a < MOVEMENTS; a++) {
+		conflictSets[a] = 0;
+		unsigned int p = a / 4;
+		unsigned int q = exits[a];
+		for (unsigned int b = 0; b < MOVEMENTS; b++) {
+			unsigned int r = b / 4;
+			unsigned int s = exits[b];
+			// Vehicles going back into their own lane never cross the junction
+			if (p == r || p == q || r == s) {
+				continue;
+			}
+			bool conflict = q == s;
+			if (!conflict && p != s && q != r) {
+				// Two paths between points on a circle cross when exactly one end of one lies between the ends of the
+				// other
+				unsigned int span = (q + N - p) % N;
+				bool rInside = (r + N - p) % N < span;
+				bool sInside = (s + N - p) % N < span;
+				conflict = rInside != sInside;
+			}
+			if (conflict) {
+				conflictSets[a] |= (MovementSet)1 << b;
+			}
+		}
+	}
+	prepare();
+}
+
+template <unsigned int N>
+JunctionLayout<N>::JunctionLayout(const unsigned int newExits[MOVEMENTS], const MovementSet newConflicts[MOVEMENTS],
+	const unsigned int newPriorities[MOVEMENTS]) {
+	for (unsigned int m = 0; m < MOVEMENTS; m++) {
+		exits[m] = newExits[m];
+		conflictSets[m] = newConflicts[m];
+		priorities[m] = newPriorities[m];
+	}
+	prepare();
+}
+
+template <unsigned int N>
+JunctionLayout<N>::~JunctionLayout() {
+	delete[] table;
+}
+
+template <unsigned int N>
+void JunctionLayout<N>::prepare() {
+	// Insertion sort keeps movements of equal priority in approach order
+	for (unsigned int m = 0; m < MOVEMENTS; m++) {
+		unsigned int k = m;
+		while (k > 0 && priorities[order[k - 1]] > priorities[m]) {
+			order[k] = order[k - 1];
+			k--;
+		}
+		order[k] = m;
+	}
+
+	table = 0;
+	if constexpr (N <= TABLE_APPROACHES) {
+		table = new unsigned short[1 << (3 * N)];
+		for (unsigned int key = 0; key < (1u << (3 * N)); key++) {
+			Vehicle::TurnDirection turns[N];
+			for (unsigned int i = 0; i < N; i++) {
+				turns[i] = (Vehicle::TurnDirection)((key >> (N + 2 * i)) & 3);
+			}
+			unsigned int entry = decide(key & ((1 << N) - 1), turns);
+			for (unsigned int i = 0; i < N; i++) {
+				if (entry & (1 << i)) {
+					entry |= exits[movement(i, turns[i])] << (N + 2 * i);
+				}
+			}
+			table[key] = (unsigned short)entry;
+		}
+	}
+}
+
+template <unsigned int N>
+unsigned int JunctionLayout<N>::decide(unsigned int waiting, const Vehicle::TurnDirection turns[N]) const {
+	MovementSet waitingMovements = 0;
+	for (unsigned int i = 0; i < N; i++) {
+		if (waiting & (1 << i)) {
+			waitingMovements |= (MovementSet)1 << movement(i, turns[i]);
+		}
+	}
+	// Take the waiting movements by priority, skipping any that conflict with one already chosen
+	MovementSet chosen = 0;
+	unsigned int proceeding = 0;
+	for (unsigned int k = 0; k < MOVEMENTS && waitingMovements != 0; k++) {
+		MovementSet m = (MovementSet)1 << order[k];
+		if ((waitingMovements & m) != 0) {
+			waitingMovements &= ~m;
+			if ((conflictSets[order[k]] & chosen) == 0) {
+				chosen |= m;
+				proceeding |= 1 << (order[k] / 4);
+			}
+		}
+	}
+	return proceeding;
+}
+
+template <unsigned int N>
+const JunctionLayout<N>& JunctionLayout<N>::standard() {
+	static const JunctionLayout layout;
+	return layout;
+}
+
+template <unsigned int N, class LaneT>
+Junction<N, LaneT>::Junction(const JunctionLayout<N>& layout) : layout(&layout), decisions(layout.decisions()),
+	incoming(0), outgoing(0), connected(false) {
+	for (unsigned int i = 0; i < N; i++) {
+		lanes[i] = 0;
+	}
+}
+
+template <unsigned int N, class LaneT>
+LaneT* Junction<N, LaneT>::connect(unsigned int approach, LaneT* lane, LaneDirection direction) {
+	LaneT* previous = lanes[approach];
+	lanes[approach] = lane;
+	incoming &= ~(1u << approach);
+	outgoing &= ~(1u << approach);
+	if (lane != 0) {
+		if (direction == LD_INCOMING) {
+			incoming |= 1u << approach;
+		}
+		else {
+			outgoing |= 1u << approach;
+		}
+	}
+	connected = (incoming | outgoing) == (1u << N) - 1;
+	return previous;
+}
+
+template <unsigned int N, class LaneT>
+void Junction<N, LaneT>::moveVehicle(unsigned int from, unsigned int to) {
+	// A vehicle whose outgoing lane is full waits at the front of its lane
+	if (to != from && lanes[to]->full()) {
+		return;
+	}
+	Vehicle* vehicle = lanes[from]->dequeue();
+	timing.passThrough(vehicle);
+	lanes[to]->enqueue(vehicle);
+}
+
+template <unsigned int N, class LaneT>
+void Junction<N, LaneT>::simulate() {
+	if (!connected) {
+		return;
+	}
+	if constexpr (N <= JunctionLayout<N>::TABLE_APPROACHES) {
+		// Describe the waiting vehicles as a key into the layout's decision table
+		unsigned int key = 0;
+		for (unsigned int i = 0; i < N; i++) {
+			if ((incoming & (1 << i)) && lanes[i]->empty() == false) {
+				key |= (1 << i) | ((unsigned int)lanes[i]->front()->nextTurn() << (N + 2 * i));
+			}
+		}
+		if (key == 0) {
+			return;
+		}
+		unsigned int entry = decisions[key];
+		for (unsigned int i = 0; i < N; i++) {
+			if (entry & (1 << i)) {
+				moveVehicle(i, (entry >> (N + 2 * i)) & 3);
+			}
+		}
+	}
+	else {
+		unsigned int waiting = 0;
+		Vehicle::TurnDirection turns[N];
+		for (unsigned int i = 0; i < N; i++) {
+			turns[i] = Vehicle::TD_INVALID;
+			if ((incoming & (1 << i)) && lanes[i]->empty() == false) {
+				waiting |= 1 << i;
+				turns[i] = lanes[i]->front()->nextTurn();
+			}
+		}
+		if (waiting == 0) {
+			return;
+		}
+		unsigned int proceeding = layout->decide(waiting, turns);
+		for (unsigned int i = 0; i < N; i++) {
+			if (proceeding & (1 << i)) {
+				moveVehicle(i, layout->exit(JunctionLayout<N>::movement(i, turns[i])));
+			}
+		}
+	}
+}
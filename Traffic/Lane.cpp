@@ -0,0 +1,58 @@
+#include "Lane.hpp"
+
+void Lane::enqueueRange(Vehicle* const* vehicles, unsigned int n) {
+    // Default behavior for lanes with no faster way to add many vehicles
+    for (unsigned int i = 0; i < n; i++) {
+        enqueue(vehicles[i]);
+    }
+}
+
+unsigned int Lane::dequeueInto(Vehicle** buffer, unsigned int max) {
+    // Default behavior for lanes with no faster way to remove many vehicles
+    unsigned int n = 0;
+    while (n < max && !empty()) {
+        buffer[n++] = dequeue();
+    }
+    return n;
+}
+
+void Lane::spliceFrom(Lane& other) {
+    // Lanes of different types cannot share storage, so the vehicles are moved one at a time
+    if (&other == this) {
+        return;
+    }
+    while (!other.empty()) {
+        enqueue(other.dequeue());
+    }
+}
+
+void Lane::setCapacity(unsigned int capacity) {
+    vehicleLimit = capacity;
+}
+
+unsigned int Lane::snapshot(const Vehicle** out, unsigned int max) const {
+    unsigned int n = 0;
+    for (const_iterator it = begin(); n < max && it != end(); ++it) {
+        out[n++] = *it;
+    }
+    return n;
+}
+
+LaneCursor Lane::cursorBegin() const {
+    LaneCursor cursor;
+    cursor.node = 0;
+    cursor.index = 0;
+    return cursor;
+}
+
+const Vehicle* Lane::cursorNext(LaneCursor& cursor) const {
+    return peek(cursor.index++);
+}
+
+LaneStats Lane::stats() const {
+#ifndef TRAFFIC_NO_LANE_STATS
+    return laneStats;
+#else
+    return LaneStats();
+#endif
+}
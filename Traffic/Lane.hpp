@@ -1,8 +1,21 @@
 #ifndef LANE_HPP
 #define LANE_HPP
 
-// forward declaration to save having to include the Vehicle header
-class Vehicle;
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+
+#include "LaneStats.hpp"
+#include "SimClock.hpp"
+
+/*
+A position in a Lane, used by Lane::const_iterator. Lanes stored as linked nodes keep the current node in `node`;
+other lanes only use `index`, the number of places behind the front of the lane.
+*/
+struct LaneCursor {
+    const void* node;
+    unsigned int index;
+};
 
 /*
 The Lane class simulates a single lane of a road. It is a FIFO queue for Vehicle objects.
@@ -12,6 +25,15 @@ pop() method.
 */
 class Lane {
 public:
+    /*
+    Lane constructor. New lanes have no capacity limit.
+    */
+    Lane() : vehicleLimit(0), watchWord(0), watchMask(0) {
+#ifndef TRAFFIC_NO_LANE_STATS
+        laneStats = LaneStats();
+#endif
+    };
+
     /*
     Lane destructor declared as virtual so that the appropriate destructor is called on polymorphic Lane objects.
     */
@@ -51,6 +73,236 @@ public:
     in the lane this method should return 0.
     */
     virtual const Vehicle* back() const = 0;
+
+    /*
+    Return a pointer to the vehicle `k` places behind the front of the lane without removing it; peek(0) is the same as
+    front(). If there are `k` or fewer vehicles in the lane this method should return 0.
+    */
+    virtual const Vehicle* peek(unsigned int k) const = 0;
+
+    /*
+    Add `n` vehicles to the lane, in order, as if enqueue() had been called for each of them.
+    */
+    virtual void enqueueRange(Vehicle* const* vehicles, unsigned int n);
+
+    /*
+    Remove up to `max` vehicles from the front of the lane, storing them in order in `buffer`, and return the number of
+    vehicles removed.
+    */
+    virtual unsigned int dequeueInto(Vehicle** buffer, unsigned int max);
+
+    /*
+    Move every vehicle from `other` into this lane, leaving `other` empty. The vehicles are added as if they had been
+    dequeued from `other` and enqueued here one at a time. When both lanes are of the same type this takes O(1) time.
+    */
+    virtual void spliceFrom(Lane& other);
+
+    /*
+    Limit the lane to holding at most `capacity` vehicles; 0 removes the limit. An Intersection will not move a vehicle
+    into a lane that is full, so the vehicle waits in its incoming lane instead (spillback). Callers enqueueing directly
+    should check full() first. Lanes with fixed storage may adjust the limit to what they can hold.
+    */
+    virtual void setCapacity(unsigned int capacity);
+
+    /*
+    Get the maximum number of vehicles this lane may hold, or 0 if the lane is unbounded.
+    */
+    unsigned int capacity() const {
+        return vehicleLimit;
+    }
+
+    /*
+    Return `true` if the lane has a capacity limit and holds that many vehicles, otherwise `false`.
+    */
+    bool full() const {
+        return vehicleLimit != 0 && count() >= vehicleLimit;
+    }
+
+    /*
+    Get the lane's traffic counters (see LaneStats). This takes O(1) time and does not change the lane.
+    */
+    virtual LaneStats stats() const;
+
+    /*
+    Have the lane set the bits `mask` in `word` whenever it goes from empty to holding a vehicle, e.g. to wake the
+    intersection it flows into. Passing 0 as `word` stops the lane setting them. Concurrent lanes only see the change
+    reliably while their consumer is not dequeueing.
+    */
+    void watch(std::atomic<unsigned long long>* word, unsigned long long mask) {
+        watchWord = word;
+        watchMask = mask;
+    }
+
+    /*
+    A read-only forward iterator over the vehicles in a lane, from front to back. Iterators are invalidated by any
+    change to the lane. Concurrent lanes may only be iterated from their consumer thread.
+    */
+    class const_iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef const Vehicle* value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Vehicle* const* pointer;
+        typedef const Vehicle* const& reference;
+
+        /*
+        Create an iterator equal to end().
+        */
+        const_iterator() : lane(0), current(0) {
+            cursor.node = 0;
+            cursor.index = 0;
+        }
+
+        reference operator*() const {
+            return current;
+        }
+
+        pointer operator->() const {
+            return &current;
+        }
+
+        const_iterator& operator++() {
+            current = lane->cursorNext(cursor);
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            // The same vehicle may be queued twice, so positions are compared as well as vehicles
+            return current == other.current && (current == 0 || cursor.index == other.cursor.index);
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        friend class Lane;
+
+        const_iterator(const Lane* lane, LaneCursor cursor) : lane(lane), cursor(cursor) {
+            current = lane->cursorNext(this->cursor);
+        }
+
+        const Lane* lane;
+        LaneCursor cursor;
+        const Vehicle* current;
+    };
+
+    /*
+    Get an iterator to the vehicle at the front of the lane.
+    */
+    const_iterator begin() const {
+        return const_iterator(this, cursorBegin());
+    }
+
+    /*
+    Get an iterator past the vehicle at the back of the lane.
+    */
+    const_iterator end() const {
+        return const_iterator();
+    }
+
+    /*
+    Copy pointers to up to `max` vehicles from the front of the lane, in order, into `out` and return the number
+    copied. The lane is not changed.
+    */
+    virtual unsigned int snapshot(const Vehicle** out, unsigned int max) const;
+
+protected:
+    /*
+    Get the cursor for the front of the lane. The default cursor counts places from the front.
+    */
+    virtual LaneCursor cursorBegin() const;
+
+    /*
+    Return the vehicle at `cursor` and move the cursor to the next vehicle, or return 0 if the cursor is past the back
+    of the lane. The default uses peek(), which is O(1) for lanes that store their vehicles contiguously.
+    */
+    virtual const Vehicle* cursorNext(LaneCursor& cursor) const;
+
+    /*
+    Update the counters for `vehicle` entering the lane, after which the lane holds `depth` vehicles, and stamp the
+    vehicle with the current tick. Every lane implementation calls this whenever a vehicle is added.
+    */
+    void recordEnqueue(Vehicle* vehicle, unsigned int depth) {
+#ifndef TRAFFIC_NO_TIMING
+        vehicle->recordMove(SimClock::now());
+#endif
+        if (depth == 1) {
+            recordOccupied();
+        }
+#ifndef TRAFFIC_NO_LANE_STATS
+        laneStats.typeCount[vehicle->type()]++;
+        laneStats.occupants += vehicle->occupantCount();
+        if (depth > laneStats.peakDepth) {
+            laneStats.peakDepth = depth;
+        }
+#endif
+    }
+
+    /*
+    Update the counters for `vehicle` leaving the lane. Every lane implementation calls this whenever a vehicle is
+    removed.
+    */
+    void recordDequeue(const Vehicle* vehicle) {
+#ifndef TRAFFIC_NO_LANE_STATS
+        laneStats.typeCount[vehicle->type()]--;
+        laneStats.occupants -= vehicle->occupantCount();
+        laneStats.passed++;
+#endif
+    }
+
+    /*
+    Update the counters of this lane and `source` for all `n` vehicles of `source` moving into this lane at once,
+    after which this lane holds `depth` vehicles.
+    */
+    void recordSplice(Lane& source, unsigned int n, unsigned int depth) {
+        if (n != 0 && depth == n) {
+            recordOccupied();
+        }
+#ifndef TRAFFIC_NO_LANE_STATS
+        for (unsigned int i = 0; i <= Vehicle::VT_INVALID; i++) {
+            laneStats.typeCount[i] += source.laneStats.typeCount[i];
+            source.laneStats.typeCount[i] = 0;
+        }
+        laneStats.occupants += source.laneStats.occupants;
+        source.laneStats.occupants = 0;
+        source.laneStats.passed += n;
+        if (depth > laneStats.peakDepth) {
+            laneStats.peakDepth = depth;
+        }
+#endif
+    }
+
+    /*
+    Tell the lane's watcher, if it has one, that the lane has gone from empty to holding a vehicle. recordEnqueue and
+    recordSplice call this; lanes that count their vehicles some other way must call it themselves.
+    */
+    void recordOccupied() {
+        // The bits are usually set already, and reading them is cheaper than setting them again
+        if (watchWord != 0 && (watchWord->load(std::memory_order_relaxed) & watchMask) != watchMask) {
+            watchWord->fetch_or(watchMask, std::memory_order_relaxed);
+        }
+    }
+
+    /*
+    Return `true` if the lane has a watcher (see watch()).
+    */
+    bool watched() const {
+        return watchWord != 0;
+    }
+
+    unsigned int vehicleLimit;
+#ifndef TRAFFIC_NO_LANE_STATS
+    LaneStats laneStats;
+#endif
+    std::atomic<unsigned long long>* watchWord;
+    unsigned long long watchMask;
 };
 
 #endif /* end of include guard: LANE_HPP */
\ No newline at end of file
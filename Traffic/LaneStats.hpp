@@ -0,0 +1,77 @@
+#ifndef LANESTATS_HPP
+#define LANESTATS_HPP
+
+#include <atomic>
+
+#include "Vehicle.hpp"
+
+/*
+The LaneStats struct holds the running counters every Lane keeps about its traffic. They are updated as vehicles are
+enqueued and dequeued, so reading them never walks the queue.
+
+Building with TRAFFIC_NO_LANE_STATS defined removes the counters from every lane, and Lane::stats() then returns all
+zeroes.
+*/
+struct LaneStats {
+	// Number of vehicles that have been dequeued from the lane over its lifetime
+	unsigned long long passed;
+	// Largest number of vehicles the lane has held at once
+	unsigned int peakDepth;
+	// Number of vehicles of each Vehicle::Type currently queued, indexed by type (VT_INVALID included)
+	unsigned int typeCount[Vehicle::VT_INVALID + 1];
+	// Total occupants of the vehicles currently queued
+	unsigned long long occupants;
+};
+
+/*
+Counters with the same meaning as LaneStats, for lanes whose enqueue and dequeue run on different threads.
+*/
+struct AtomicLaneStats {
+	std::atomic<unsigned long long> passed;
+	std::atomic<unsigned int> peakDepth;
+	std::atomic<unsigned int> typeCount[Vehicle::VT_INVALID + 1];
+	std::atomic<unsigned long long> occupants;
+
+	AtomicLaneStats() : passed(0), peakDepth(0), occupants(0) {
+		for (unsigned int i = 0; i <= Vehicle::VT_INVALID; i++) {
+			typeCount[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	/*
+	Record a vehicle entering the lane, which then holds `depth` vehicles.
+	*/
+	void recordEnqueue(const Vehicle* vehicle, unsigned int depth) {
+		typeCount[vehicle->type()].fetch_add(1, std::memory_order_relaxed);
+		occupants.fetch_add(vehicle->occupantCount(), std::memory_order_relaxed);
+		unsigned int peak = peakDepth.load(std::memory_order_relaxed);
+		while (depth > peak && !peakDepth.compare_exchange_weak(peak, depth, std::memory_order_relaxed)) {
+		}
+	}
+
+	/*
+	Record a vehicle leaving the lane.
+	*/
+	void recordDequeue(const Vehicle* vehicle) {
+		typeCount[vehicle->type()].fetch_sub(1, std::memory_order_relaxed);
+		occupants.fetch_sub(vehicle->occupantCount(), std::memory_order_relaxed);
+		passed.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/*
+	Copy the counters into a LaneStats. Each counter is read separately, so while other threads are using the lane the
+	counters may come from slightly different moments.
+	*/
+	LaneStats snapshot() const {
+		LaneStats stats;
+		stats.passed = passed.load(std::memory_order_relaxed);
+		stats.peakDepth = peakDepth.load(std::memory_order_relaxed);
+		for (unsigned int i = 0; i <= Vehicle::VT_INVALID; i++) {
+			stats.typeCount[i] = typeCount[i].load(std::memory_order_relaxed);
+		}
+		stats.occupants = occupants.load(std::memory_order_relaxed);
+		return stats;
+	}
+};
+
+#endif /* end of include guard: LANESTATS_HPP */
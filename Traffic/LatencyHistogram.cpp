@@ -0,0 +1,57 @@
+#include "LatencyHistogram.hpp"
+
+LatencyHistogram::LatencyHistogram() {
+	reset();
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+	for (unsigned int b = 0; b < BUCKETS; b++) {
+		counts[b] += other.counts[b];
+	}
+	total += other.total;
+	sum += other.sum;
+	if (other.maximum > maximum) {
+		maximum = other.maximum;
+	}
+}
+
+void LatencyHistogram::reset() {
+	for (unsigned int b = 0; b < BUCKETS; b++) {
+		counts[b] = 0;
+	}
+	total = 0;
+	sum = 0;
+	maximum = 0;
+}
+
+unsigned int LatencyHistogram::percentile(double quantile) const {
+	if (total == 0) {
+		return 0;
+	}
+	// the rank of the duration asked for, counting from 1
+	unsigned long long rank = (unsigned long long)(quantile * total);
+	if (rank < quantile * total || rank == 0) {
+		rank++;
+	}
+	if (rank > total) {
+		rank = total;
+	}
+	unsigned long long seen = 0;
+	for (unsigned int b = 0; b < BUCKETS; b++) {
+		seen += counts[b];
+		if (seen >= rank) {
+			unsigned int value = highestValueOf(b);
+			return value < maximum ? value : maximum;
+		}
+	}
+	return maximum;
+}
+
+unsigned int LatencyHistogram::highestValueOf(unsigned int bucket) {
+	if (bucket < LINEAR_BUCKETS) {
+		return bucket;
+	}
+	unsigned int shift = (bucket - LINEAR_BUCKETS) / SUB_BUCKETS + 1;
+	unsigned long long top = (bucket - LINEAR_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS + 1;
+	return (unsigned int)((top << shift) - 1);
+}
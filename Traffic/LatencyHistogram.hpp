@@ -0,0 +1,116 @@
+#ifndef LATENCYHISTOGRAM_HPP
+#define LATENCYHISTOGRAM_HPP
+
+/*
+The LatencyHistogram class records durations in ticks with log-scaled buckets, in the style of an HDR histogram. Values
+below 32 get a bucket each; above that every power of two is split into 16 buckets, so a reported value is within 1/16
+(6.25%) of the true one. Recording is O(1) and the histogram has a fixed size whatever values it sees.
+
+Percentiles are reported as the largest value that falls in the percentile's bucket, capped at the largest value
+recorded.
+*/
+class LatencyHistogram {
+public:
+	/*
+	Create a new empty histogram.
+	*/
+	LatencyHistogram();
+
+	/*
+	Add one duration of `ticks` ticks.
+	*/
+	void record(unsigned int ticks) {
+		record(ticks, 1);
+	}
+
+	/*
+	Add `n` durations of `ticks` ticks each.
+	*/
+	void record(unsigned int ticks, unsigned int n) {
+		counts[bucketOf(ticks)] += n;
+		total += n;
+		sum += (unsigned long long)ticks * n;
+		if (ticks > maximum && n != 0) {
+			maximum = ticks;
+		}
+	}
+
+	/*
+	Add every duration recorded in `other` to this histogram.
+	*/
+	void merge(const LatencyHistogram& other);
+
+	/*
+	Remove every recorded duration.
+	*/
+	void reset();
+
+	/*
+	Get the number of durations recorded.
+	*/
+	unsigned long long count() const {
+		return total;
+	}
+
+	/*
+	Get the largest duration recorded, or 0 if the histogram is empty.
+	*/
+	unsigned int max() const {
+		return maximum;
+	}
+
+	/*
+	Get the mean of the durations recorded (exact rather than bucketed), or 0 if the histogram is empty.
+	*/
+	double mean() const {
+		return total != 0 ? (double)sum / total : 0.0;
+	}
+
+	/*
+	Get the duration below or at which a fraction `quantile` (0 to 1) of the recorded durations fall, or 0 if the
+	histogram is empty.
+	*/
+	unsigned int percentile(double quantile) const;
+
+	unsigned int p50() const {
+		return percentile(0.5);
+	}
+
+	unsigned int p99() const {
+		return percentile(0.99);
+	}
+
+	unsigned int p999() const {
+		return percentile(0.999);
+	}
+
+private:
+	static const unsigned int LINEAR_BUCKETS = 32;
+	static const unsigned int SUB_BUCKETS = 16;
+	static const unsigned int BUCKETS = LINEAR_BUCKETS + 27 * SUB_BUCKETS;
+
+	/*
+	Get the bucket holding `value`.
+	*/
+	static unsigned int bucketOf(unsigned int value) {
+		if (value < LINEAR_BUCKETS) {
+			return value;
+		}
+		// keep the top five bits of the value; the leading one picks the power of two, the other four the sub-bucket
+		unsigned int shift = 31 - __builtin_clz(value) - 4;
+		return LINEAR_BUCKETS + (shift - 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+	}
+
+	/*
+	Get the largest value held by bucket `bucket`.
+	*/
+	static unsigned int highestValueOf(unsigned int bucket);
+
+	// The totals come first so that recording a short duration touches a single cache line
+	unsigned long long total;
+	unsigned long long sum;
+	unsigned int maximum;
+	unsigned int counts[BUCKETS];
+};
+
+#endif /* end of include guard: LATENCYHISTOGRAM_HPP */
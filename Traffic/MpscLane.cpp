@@ -0,0 +1,145 @@
+#include "MpscLane.hpp"
+#include "Vehicle.hpp"
+
+#include <thread>
+
+MpscLane::MpscLane(unsigned int capacity) : head(0), tail(0) {
+	// The capacity is rounded up to a power of two so positions can be wrapped with a mask
+	unsigned int size = 2;
+	while (size < capacity) {
+		size *= 2;
+	}
+	cells = new Cell[size];
+	mask = size - 1;
+	vehicleLimit = size;
+	// Every slot starts out free for the first pass around the ring
+	for (unsigned int i = 0; i < size; i++) {
+		cells[i].sequence.store(i, std::memory_order_relaxed);
+		cells[i].vehicle = 0;
+	}
+}
+
+MpscLane::~MpscLane() {
+	// dequeues all vehicles until no vehicles are left and deletes the vehicle
+	while (!empty()) {
+		delete dequeue();
+	}
+	delete[] cells;
+}
+
+bool MpscLane::tryEnqueue(Vehicle* vehicle) {
+	unsigned int position = tail.load(std::memory_order_relaxed);
+	Cell* cell;
+	while (true) {
+		cell = &cells[position & mask];
+		unsigned int sequence = cell->sequence.load(std::memory_order_acquire);
+		int difference = (int)(sequence - position);
+		if (difference == 0) {
+			// The slot is free; claim it by moving the tail past it
+			if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if (difference < 0) {
+			// The slot still holds a vehicle from the previous pass, so the lane is full
+			return false;
+		}
+		else {
+			// Another producer claimed this slot first
+			position = tail.load(std::memory_order_relaxed);
+		}
+	}
+	cell->vehicle = vehicle;
+#ifndef TRAFFIC_NO_TIMING
+	vehicle->recordMove(SimClock::now());
+#endif
+#ifndef TRAFFIC_NO_LANE_STATS
+	// Counted before publishing, so the consumer cannot count the vehicle leaving first
+	atomicStats.recordEnqueue(vehicle, position + 1 - head.load(std::memory_order_relaxed));
+#endif
+	if (watched() && position + 1 - head.load(std::memory_order_relaxed) == 1) {
+		recordOccupied();
+	}
+	// Publishing the sequence makes the vehicle visible to the consumer
+	cell->sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+void MpscLane::enqueue(Vehicle* vehicle) {
+	while (!tryEnqueue(vehicle)) {
+		std::this_thread::yield();
+	}
+}
+
+Vehicle* MpscLane::dequeue() {
+	unsigned int position = head.load(std::memory_order_relaxed);
+	Cell& cell = cells[position & mask];
+	if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+		return 0;
+	}
+	Vehicle* vehicle = cell.vehicle;
+#ifndef TRAFFIC_NO_LANE_STATS
+	atomicStats.recordDequeue(vehicle);
+#endif
+	// Free the slot for the producers' next pass around the ring
+	cell.sequence.store(position + mask + 1, std::memory_order_release);
+	head.store(position + 1, std::memory_order_release);
+	return vehicle;
+}
+
+bool MpscLane::empty() const {
+	return front() == 0;
+}
+
+unsigned int MpscLane::count() const {
+	// head is read first; tail never falls behind it, so the difference cannot underflow
+	unsigned int h = head.load(std::memory_order_acquire);
+	unsigned int t = tail.load(std::memory_order_acquire);
+	return t - h;
+}
+
+const Vehicle* MpscLane::front() const {
+	return peek(0);
+}
+
+const Vehicle* MpscLane::back() const {
+	// Walk back from the most recently claimed slot to the most recently published one
+	unsigned int h = head.load(std::memory_order_acquire);
+	unsigned int t = tail.load(std::memory_order_acquire);
+	while (t != h) {
+		const Cell& cell = cells[(t - 1) & mask];
+		if (cell.sequence.load(std::memory_order_acquire) == t) {
+			return cell.vehicle;
+		}
+		t--;
+	}
+	return 0;
+}
+
+const Vehicle* MpscLane::peek(unsigned int k) const {
+	unsigned int position = head.load(std::memory_order_relaxed) + k;
+	if (k > mask) {
+		return 0;
+	}
+	const Cell& cell = cells[position & mask];
+	if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+		return 0;
+	}
+	return cell.vehicle;
+}
+
+void MpscLane::setCapacity(unsigned int capacity) {
+	// The ring cannot grow, so the limit stays within it
+	if (capacity == 0 || capacity > mask + 1) {
+		capacity = mask + 1;
+	}
+	Lane::setCapacity(capacity);
+}
+
+LaneStats MpscLane::stats() const {
+#ifndef TRAFFIC_NO_LANE_STATS
+	return atomicStats.snapshot();
+#else
+	return LaneStats();
+#endif
+}
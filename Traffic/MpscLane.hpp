@@ -0,0 +1,120 @@
+#ifndef MPSCLANE_HPP
+#define MPSCLANE_HPP
+
+#include <atomic>
+
+#include "Lane.hpp"
+
+/*
+The MpscLane class is a FIFO lane that any number of producer threads may enqueue into while one consumer thread
+dequeues from it, e.g. an entry lane fed by a demand injector as well as by its upstream intersection. It is a bounded,
+lock-free ring buffer in which every slot carries a sequence number saying whether it is free or holds a published
+vehicle.
+
+ - enqueue and tryEnqueue may be called from any thread.
+ - dequeue, front, back, peek and empty may only be called from the consumer thread.
+ - count may be called from any thread. It includes vehicles whose producers have claimed a slot but not yet finished
+   writing it, so it may briefly be larger than the number of vehicles front/dequeue can see.
+Vehicles from the same producer leave the lane in the order that producer enqueued them. When only one thread uses
+the lane it behaves exactly like SimpleLane, up to its capacity.
+*/
+class MpscLane final : public Lane {
+public:
+	/*
+	Create a new empty lane holding up to `capacity` vehicles, rounded up to a power of two. capacity() reports the
+	rounded size.
+	*/
+	explicit MpscLane(unsigned int capacity = 1024);
+
+	/*
+	Destroy the lane; the destructor deletes *all* vehicles currently enqueued in the lane. No thread may be using the
+	lane at this point.
+	*/
+	virtual ~MpscLane();
+
+	/*
+	Add a Vehicle to the back of the lane. If the lane is full this waits for the consumer to make room.
+	*/
+	virtual void enqueue(Vehicle* vehicle);
+
+	/*
+	Add a Vehicle to the back of the lane if there is room, returning `true`, or return `false` if the lane is full.
+	*/
+	bool tryEnqueue(Vehicle* vehicle);
+
+	/*
+	Remove a vehicle from the front of the lane, returning a pointer to the removed vehicle. If there is no vehicle to
+	remove, this method returns 0 instead.
+	*/
+	virtual Vehicle* dequeue();
+
+	/*
+	Return `true` if there is no published vehicle at the front of the lane, otherwise `false`.
+	*/
+	virtual bool empty() const;
+
+	/*
+	Get the number of vehicles currently in the lane, including ones still being enqueued.
+	*/
+	virtual unsigned int count() const;
+
+	/*
+	Return a pointer to the vehicle at the front of the lane without removing it, or 0 if the lane is empty.
+	*/
+	virtual const Vehicle* front() const;
+
+	/*
+	Return a pointer to the most recently published vehicle in the lane, or 0 if the lane is empty.
+	*/
+	virtual const Vehicle* back() const;
+
+	/*
+	Return a pointer to the vehicle `k` places behind the front of the lane, or 0 if that vehicle has not been
+	published.
+	*/
+	virtual const Vehicle* peek(unsigned int k) const;
+
+	/*
+	Limit the lane to `capacity` vehicles. The limit cannot be removed or raised above the size of the ring, which is
+	the lane's initial capacity.
+	*/
+	virtual void setCapacity(unsigned int capacity);
+
+	/*
+	Get the lane's traffic counters. Enqueue and dequeue update them from different threads, so they are kept in
+	atomics and copied out here.
+	*/
+	virtual LaneStats stats() const;
+
+private:
+	/*
+	Private copy constructor and copy assignment operator - lanes cannot be copied.
+	*/
+	MpscLane(const MpscLane&);
+	MpscLane& operator=(const MpscLane&);
+
+	/*
+	A slot in the ring. A slot at position p is free for a producer when its sequence is p, and holds a published
+	vehicle when its sequence is p + 1.
+	*/
+	struct Cell {
+		std::atomic<unsigned int> sequence;
+		Vehicle* vehicle;
+	};
+
+	Cell* cells;
+	unsigned int mask;
+#ifndef TRAFFIC_NO_LANE_STATS
+	AtomicLaneStats atomicStats;
+#endif
+
+	// Position of the front vehicle, advanced only by the consumer
+	alignas(64) std::atomic<unsigned int> head;
+
+	// Position of the next free slot, claimed by producers with compare-and-swap
+	alignas(64) std::atomic<unsigned int> tail;
+
+	char padding[64 - sizeof(std::atomic<unsigned int>)];
+};
+
+#endif /* end of include guard: MPSCLANE_HPP */
@@ -0,0 +1,58 @@
+#include "PooledLane.hpp"
+#include <typeinfo>
+
+PooledLane::PooledLane(VehiclePool& vehiclePool) : pool(vehiclePool) {
+}
+
+PooledLane::~PooledLane() {
+	// the queued vehicles belong to the pool, so they are destroyed there rather than deleted
+	while (!vehicles.empty()) {
+		pool.destroy(vehicles.pop());
+	}
+}
+
+void PooledLane::enqueueRange(Vehicle* const* newVehicles, unsigned int n) {
+	// Grow once up front so the copy loop never reallocates
+	vehicles.reserve(vehicles.count() + n);
+	for (unsigned int i = 0; i < n; i++) {
+		vehicles.push(pool.idOf(newVehicles[i]));
+		recordEnqueue(newVehicles[i], vehicles.count());
+	}
+}
+
+unsigned int PooledLane::dequeueInto(Vehicle** buffer, unsigned int max) {
+	unsigned int n = 0;
+	while (n < max && !vehicles.empty()) {
+		buffer[n] = pool.at(vehicles.pop());
+		recordDequeue(buffer[n++]);
+	}
+	return n;
+}
+
+void PooledLane::spliceFrom(Lane& other) {
+	if (typeid(other) != typeid(PooledLane) || &static_cast<PooledLane&>(other).pool != &pool) {
+		Lane::spliceFrom(other);
+		return;
+	}
+	PooledLane &source = static_cast<PooledLane&>(other);
+	if (&source == this) {
+		return;
+	}
+	unsigned int n = source.vehicles.count();
+	// An empty lane can simply take over the other lane's buffer
+	if (vehicles.empty()) {
+		vehicles.swap(source.vehicles);
+	}
+	else {
+		vehicles.reserve(vehicles.count() + n);
+		while (!source.vehicles.empty()) {
+			vehicles.push(source.vehicles.pop());
+		}
+	}
+	recordSplice(source, n, vehicles.count());
+}
+
+void PooledLane::setCapacity(unsigned int capacity) {
+	Lane::setCapacity(capacity);
+	vehicles.reserve(capacity);
+}
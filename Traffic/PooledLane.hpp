@@ -0,0 +1,171 @@
+#ifndef POOLEDLANE_HPP
+#define POOLEDLANE_HPP
+
+#include "Lane.hpp"
+#include "RingBuffer.hpp"
+#include "VehiclePool.hpp"
+
+/*
+The PooledLane class is a FIFO lane for vehicles owned by a VehiclePool. It behaves like RingLane, but the queue holds
+32-bit VehicleId handles instead of pointers, halving the memory of long queues.
+
+Every vehicle enqueued must belong to the lane's pool. The Lane interface still passes Vehicle pointers, which are
+converted to and from handles in O(1) time; enqueueId() and dequeueId() skip the conversion. Vehicles left in the lane
+when it is destroyed are destroyed in the pool.
+*/
+class PooledLane final : public Lane {
+protected:
+	VehiclePool& pool;
+	RingBuffer<VehicleId> vehicles;
+public:
+	/*
+	Create a new empty traffic lane for vehicles from `vehiclePool`, which must outlive the lane.
+	*/
+	explicit PooledLane(VehiclePool& vehiclePool);
+
+	/*
+	Destroy the lane; every vehicle still enqueued is destroyed in the pool.
+	*/
+	virtual ~PooledLane();
+
+	/*
+	Add a Vehicle from the lane's pool to the back of the lane.
+	*/
+	virtual void enqueue(Vehicle* vehicle);
+
+	/*
+	Add the vehicle with handle `id` to the back of the lane.
+	*/
+	void enqueueId(VehicleId id);
+
+	/*
+	Remove a vehicle from the front of the lane, returning a pointer to the removed vehicle. If there is no vehicle to
+	remove, this method returns 0 instead.
+	*/
+	virtual Vehicle* dequeue();
+
+	/*
+	Remove a vehicle from the front of the lane, returning its handle, or 0 if the lane is empty.
+	*/
+	VehicleId dequeueId();
+
+	/*
+	Return `true` if there are no vehicles in the lane, otherwise `false`.
+	*/
+	virtual bool empty() const;
+
+	/*
+	Get the exact number of vehicles currently in the lane.
+	*/
+	virtual unsigned int count() const;
+
+	/*
+	Return a pointer to the vehicle at the front of the lane without removing it, or 0 if the lane is empty.
+	*/
+	virtual const Vehicle* front() const;
+
+	/*
+	Return a pointer to the vehicle at the back of the lane without removing it, or 0 if the lane is empty.
+	*/
+	virtual const Vehicle* back() const;
+
+	/*
+	Return a pointer to the vehicle `k` places behind the front of the lane without removing it, or 0 if there are `k`
+	or fewer vehicles in the lane. This takes O(1) time.
+	*/
+	virtual const Vehicle* peek(unsigned int k) const;
+
+	/*
+	Add `n` vehicles to the back of the lane, growing the buffer at most once.
+	*/
+	virtual void enqueueRange(Vehicle* const* vehicles, unsigned int n);
+
+	/*
+	Remove up to `max` vehicles from the front of the lane into `buffer`, returning the number removed.
+	*/
+	virtual unsigned int dequeueInto(Vehicle** buffer, unsigned int max);
+
+	/*
+	Move every vehicle from `other` to the back of this lane. If `other` is a PooledLane over the same pool and this lane
+	is empty the two buffers are exchanged in O(1) time; otherwise the vehicles are copied across.
+	*/
+	virtual void spliceFrom(Lane& other);
+
+	/*
+	Limit the lane to `capacity` vehicles, allocating room for all of them now.
+	*/
+	virtual void setCapacity(unsigned int capacity);
+
+	/*
+	Get the pool this lane's vehicles belong to.
+	*/
+	VehiclePool& vehiclePool() const {
+		return pool;
+	}
+
+private:
+	/*
+	Private copy constructor and copy assignment operator - lanes cannot be copied.
+	*/
+	PooledLane(const PooledLane&);
+	PooledLane& operator=(const PooledLane&);
+};
+
+inline void PooledLane::enqueueId(VehicleId id) {
+	vehicles.push(id);
+	recordEnqueue(pool.at(id), vehicles.count());
+}
+
+inline void PooledLane::enqueue(Vehicle* vehicle) {
+	vehicles.push(pool.idOf(vehicle));
+	recordEnqueue(vehicle, vehicles.count());
+}
+
+inline VehicleId PooledLane::dequeueId() {
+	if (vehicles.empty()) {
+		return 0;
+	}
+	VehicleId id = vehicles.pop();
+	recordDequeue(pool.at(id));
+	return id;
+}
+
+inline Vehicle* PooledLane::dequeue() {
+	if (vehicles.empty()) {
+		return 0;
+	}
+	Vehicle* vehicle = pool.at(vehicles.pop());
+	recordDequeue(vehicle);
+	return vehicle;
+}
+
+inline bool PooledLane::empty() const {
+	return vehicles.empty();
+}
+
+inline unsigned int PooledLane::count() const {
+	return vehicles.count();
+}
+
+inline const Vehicle* PooledLane::front() const {
+	if (vehicles.empty()) {
+		return 0;
+	}
+	return pool.at(vehicles.front());
+}
+
+inline const Vehicle* PooledLane::back() const {
+	if (vehicles.empty()) {
+		return 0;
+	}
+	return pool.at(vehicles.back());
+}
+
+inline const Vehicle* PooledLane::peek(unsigned int k) const {
+	if (k >= vehicles.count()) {
+		return 0;
+	}
+	return pool.at(vehicles.at(k));
+}
+
+#endif /* end of include guard: POOLEDLANE_HPP */
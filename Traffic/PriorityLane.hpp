@@ -0,0 +1,175 @@
+#ifndef PRIORITYLANE_HPP
+#define PRIORITYLANE_HPP
+
+#include "Lane.hpp"
+#include "RingBuffer.hpp"
+#include "Vehicle.hpp"
+
+/*
+The PriorityLane class simulates a single lane of a road in which some vehicles may move ahead of others. Each vehicle is
+sorted into one of `NumClasses` priority classes by the `Policy` type when it is enqueued; class 0 has the highest
+priority. Vehicles leave the lane from the highest priority class that has any vehicles queued, and within a class the
+lane is a FIFO queue.
+
+A policy is any type with a static member function
+
+    static unsigned int classify(const Vehicle* vehicle);
+
+returning a class index less than `NumClasses`. The policy is called directly rather than through a virtual function,
+and each class is stored in its own RingBuffer, with a bitmask recording which classes are non-empty. Enqueueing and
+dequeueing a vehicle is therefore O(1) whatever the policy.
+
+For example, `PriorityLane<MotorcyclesFirst, 2>` behaves in the same way as ExpressLane.
+*/
+template <class Policy, unsigned int NumClasses>
+class PriorityLane final : public Lane {
+	static_assert(NumClasses >= 1 && NumClasses <= 32, "PriorityLane supports between 1 and 32 classes");
+protected:
+	RingBuffer<Vehicle*> segments[NumClasses];
+	// Bit i is set while class i has at least one vehicle queued
+	unsigned int occupied;
+	unsigned int sum;
+
+	/*
+	Index of the highest priority class with any vehicles queued. The lane must not be empty.
+	*/
+	unsigned int firstClass() const {
+		return __builtin_ctz(occupied);
+	}
+
+	/*
+	Index of the lowest priority class with any vehicles queued. The lane must not be empty.
+	*/
+	unsigned int lastClass() const {
+		return 31 - __builtin_clz(occupied);
+	}
+public:
+	/*
+	Create a new empty lane.
+	*/
+	PriorityLane() : occupied(0), sum(0) {
+	}
+
+	/*
+	Destroy the lane; the destructor deletes *all* vehicles currently enqueued in the lane.
+	*/
+	virtual ~PriorityLane() {
+		for (unsigned int i = 0; i < NumClasses; i++) {
+			while (!segments[i].empty()) {
+				delete segments[i].pop();
+			}
+		}
+	}
+
+	/*
+	Add a Vehicle to the back of its priority class.
+	*/
+	virtual void enqueue(Vehicle* vehicle) {
+		unsigned int c = Policy::classify(vehicle);
+		segments[c].push(vehicle);
+		occupied |= 1u << c;
+		sum++;
+		recordEnqueue(vehicle, sum);
+	}
+
+	/*
+	Remove the vehicle at the front of the highest priority non-empty class, returning a pointer to the removed vehicle.
+	If there is no vehicle to remove, this method returns 0 instead.
+	*/
+	virtual Vehicle* dequeue() {
+		if (occupied == 0) {
+			return 0;
+		}
+		unsigned int c = firstClass();
+		Vehicle* vehicle = segments[c].pop();
+		if (segments[c].empty()) {
+			occupied &= ~(1u << c);
+		}
+		sum--;
+		recordDequeue(vehicle);
+		return vehicle;
+	}
+
+	/*
+	Return `true` if there are no vehicles in the lane, otherwise `false`.
+	*/
+	virtual bool empty() const {
+		return occupied == 0;
+	}
+
+	/*
+	Get the exact number of vehicles currently in the lane, across all classes.
+	*/
+	virtual unsigned int count() const {
+		return sum;
+	}
+
+	/*
+	Return a pointer to the vehicle that will be dequeued next without removing it, or 0 if the lane is empty.
+	*/
+	virtual const Vehicle* front() const {
+		if (occupied == 0) {
+			return 0;
+		}
+		return segments[firstClass()].front();
+	}
+
+	/*
+	Return a pointer to the vehicle that will be dequeued last without removing it, or 0 if the lane is empty.
+	*/
+	virtual const Vehicle* back() const {
+		if (occupied == 0) {
+			return 0;
+		}
+		return segments[lastClass()].back();
+	}
+
+	/*
+	Return a pointer to the vehicle `k` places behind the front of the lane without removing it, or 0 if there are `k`
+	or fewer vehicles in the lane. Only the non-empty classes are visited.
+	*/
+	virtual const Vehicle* peek(unsigned int k) const {
+		if (k >= sum) {
+			return 0;
+		}
+		unsigned int remaining = occupied;
+		while (true) {
+			unsigned int c = __builtin_ctz(remaining);
+			if (k < segments[c].count()) {
+				return segments[c].at(k);
+			}
+			k -= segments[c].count();
+			remaining &= remaining - 1;
+		}
+	}
+};
+
+/*
+Two class policy giving motorcycles priority over cars and buses, which is the ExpressLane rule.
+*/
+struct MotorcyclesFirst {
+	static unsigned int classify(const Vehicle* vehicle) {
+		return vehicle->type() == Vehicle::VT_MOTORCYCLE ? 0 : 1;
+	}
+};
+
+/*
+Two class policy giving buses priority over all other vehicles, for bus lanes and bus-priority approaches.
+*/
+struct BusesFirst {
+	static unsigned int classify(const Vehicle* vehicle) {
+		return vehicle->type() == Vehicle::VT_BUS ? 0 : 1;
+	}
+};
+
+/*
+Two class policy for high occupancy vehicle (HOV) lanes; vehicles carrying at least `MinOccupants` people have priority.
+*/
+template <unsigned int MinOccupants>
+struct HighOccupancyFirst {
+	static unsigned int classify(const Vehicle* vehicle) {
+		return vehicle->occupantCount() >= MinOccupants ? 0 : 1;
+	}
+};
+
+#endif /* end of include guard: PRIORITYLANE_HPP */
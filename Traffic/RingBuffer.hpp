@@ -0,0 +1,167 @@
+#ifndef RINGBUFFER_HPP
+#define RINGBUFFER_HPP
+
+#include <algorithm>
+
+/*
+The RingBuffer class is a growable FIFO queue stored in a single contiguous circular array. The capacity of the array is
+always a power of two so that positions can be wrapped with a mask instead of a division.
+
+Values are pushed onto the back and popped from the front in amortized O(1) time. Storage is only allocated when the
+buffer grows (doubling each time), so a buffer that has reached its working size performs no further allocation.
+*/
+template <class T>
+class RingBuffer {
+public:
+	/*
+	Create a new empty buffer. No storage is allocated until the first value is pushed.
+	*/
+	RingBuffer() : slots(0), mask(0), head(0), length(0) {
+	}
+
+	/*
+	Destroy the buffer and release its storage. Values held in the buffer are not otherwise cleaned up.
+	*/
+	~RingBuffer() {
+		delete[] slots;
+	}
+
+	/*
+	Get the number of values currently held in the buffer.
+	*/
+	unsigned int count() const {
+		return length;
+	}
+
+	/*
+	Return `true` if there are no values in the buffer, otherwise `false`.
+	*/
+	bool empty() const {
+		return length == 0;
+	}
+
+	/*
+	Get the number of values the buffer can hold before it has to grow.
+	*/
+	unsigned int capacity() const {
+		return slots != 0 ? mask + 1 : 0;
+	}
+
+	/*
+	Access the value at the front of the buffer. The buffer must not be empty.
+	*/
+	const T& front() const {
+		return slots[head];
+	}
+
+	/*
+	Access the value at the back of the buffer. The buffer must not be empty.
+	*/
+	const T& back() const {
+		return slots[(head + length - 1) & mask];
+	}
+
+	/*
+	Access the value `index` positions behind the front of the buffer. `index` must be less than count().
+	*/
+	const T& at(unsigned int index) const {
+		return slots[(head + index) & mask];
+	}
+
+	/*
+	Copy up to `max` values from the front of the buffer, in order, into `out` and return the number copied. The
+	values are copied in at most two contiguous runs.
+	*/
+	template <class U>
+	unsigned int copyTo(U* out, unsigned int max) const {
+		unsigned int n = length < max ? length : max;
+		unsigned int first = mask + 1 - head;
+		if (slots == 0 || n <= first) {
+			first = n;
+		}
+		std::copy(slots + head, slots + head + first, out);
+		std::copy(slots, slots + (n - first), out + first);
+		return n;
+	}
+
+	/*
+	Add a value to the back of the buffer, growing the storage if it is full.
+	*/
+	void push(const T& value) {
+		if (length == capacity()) {
+			grow(length + 1);
+		}
+		slots[(head + length) & mask] = value;
+		length++;
+	}
+
+	/*
+	Remove the value at the front of the buffer and return it. The buffer must not be empty.
+	*/
+	T pop() {
+		T value = slots[head];
+		head = (head + 1) & mask;
+		length--;
+		return value;
+	}
+
+	/*
+	Make sure the buffer can hold at least `minimum` values without growing again.
+	*/
+	void reserve(unsigned int minimum) {
+		if (minimum > capacity()) {
+			grow(minimum);
+		}
+	}
+
+	/*
+	Exchange the contents of this buffer with `other` in O(1) time.
+	*/
+	void swap(RingBuffer& other) {
+		T* otherSlots = other.slots;
+		unsigned int otherMask = other.mask;
+		unsigned int otherHead = other.head;
+		unsigned int otherLength = other.length;
+		other.slots = slots;
+		other.mask = mask;
+		other.head = head;
+		other.length = length;
+		slots = otherSlots;
+		mask = otherMask;
+		head = otherHead;
+		length = otherLength;
+	}
+
+private:
+	/*
+	Private copy constructor and copy assignment operator - buffers own their storage and cannot be copied.
+	*/
+	RingBuffer(const RingBuffer&);
+	RingBuffer& operator=(const RingBuffer&);
+
+	/*
+	Move the contents into a new power-of-two array that holds at least `minimum` values. The values are unwrapped so
+	that the front of the buffer sits at the start of the new array.
+	*/
+	void grow(unsigned int minimum) {
+		unsigned int newCapacity = capacity() != 0 ? capacity() : 8;
+		while (newCapacity < minimum) {
+			newCapacity *= 2;
+		}
+		T* newSlots = new T[newCapacity];
+		for (unsigned int i = 0; i < length; i++) {
+			newSlots[i] = slots[(head + i) & mask];
+		}
+		delete[] slots;
+		slots = newSlots;
+		mask = newCapacity - 1;
+		head = 0;
+	}
+
+	T* slots;
+	unsigned int mask;
+	unsigned int head;
+	unsigned int length;
+};
+
+#endif /* end of include guard: RINGBUFFER_HPP */
@@ -0,0 +1,67 @@
+#include "RingLane.hpp"
+#include "Vehicle.hpp"
+#include <typeinfo>
+
+RingLane::RingLane() {
+}
+
+RingLane::RingLane(unsigned int initialCapacity) {
+	vehicles.reserve(initialCapacity);
+}
+
+RingLane::~RingLane() {
+	// dequeues all vehicles until no vehicles are left and deletes the vehicle
+	while (!vehicles.empty()) {
+		delete vehicles.pop();
+	}
+}
+
+void RingLane::enqueueRange(Vehicle* const* newVehicles, unsigned int n) {
+	// Grow once up front so the copy loop never reallocates
+	vehicles.reserve(vehicles.count() + n);
+	for (unsigned int i = 0; i < n; i++) {
+		vehicles.push(newVehicles[i]);
+		recordEnqueue(newVehicles[i], vehicles.count());
+	}
+}
+
+unsigned int RingLane::dequeueInto(Vehicle** buffer, unsigned int max) {
+	unsigned int n = 0;
+	while (n < max && !vehicles.empty()) {
+		buffer[n] = vehicles.pop();
+		recordDequeue(buffer[n++]);
+	}
+	return n;
+}
+
+void RingLane::spliceFrom(Lane& other) {
+	if (typeid(other) != typeid(RingLane)) {
+		Lane::spliceFrom(other);
+		return;
+	}
+	RingLane &source = static_cast<RingLane&>(other);
+	if (&source == this) {
+		return;
+	}
+	unsigned int n = source.vehicles.count();
+	// An empty lane can simply take over the other lane's buffer
+	if (vehicles.empty()) {
+		vehicles.swap(source.vehicles);
+	}
+	else {
+		vehicles.reserve(vehicles.count() + n);
+		while (!source.vehicles.empty()) {
+			vehicles.push(source.vehicles.pop());
+		}
+	}
+	recordSplice(source, n, vehicles.count());
+}
+
+void RingLane::setCapacity(unsigned int capacity) {
+	Lane::setCapacity(capacity);
+	vehicles.reserve(capacity);
+}
+
+unsigned int RingLane::snapshot(const Vehicle** out, unsigned int max) const {
+	return vehicles.copyTo(out, max);
+}
@@ -0,0 +1,149 @@
+#ifndef RINGLANE_HPP
+#define RINGLANE_HPP
+
+#include "Lane.hpp"
+#include "RingBuffer.hpp"
+
+/*
+The RingLane class simulates a single lane of a road. It is a FIFO queue for Vehicle objects with the same behavior as
+SimpleLane, but the queued Vehicle pointers are stored in a contiguous circular buffer instead of a linked list of Nodes.
+
+The buffer doubles in size when it fills up, so once a lane has grown to the length of its longest queue, enqueueing and
+dequeueing vehicles does not allocate any memory. The per-vehicle methods are defined in this header so that code
+holding a RingLane directly can inline them.
+*/
+class RingLane final : public Lane {
+protected:
+	RingBuffer<Vehicle*> vehicles;
+public:
+	/*
+	Create a new empty traffic lane. No storage is allocated until the first vehicle is enqueued.
+	*/
+	RingLane();
+
+	/*
+	Create a new empty traffic lane with room for at least `initialCapacity` vehicles before it has to grow.
+	*/
+	explicit RingLane(unsigned int initialCapacity);
+
+	/*
+	Destroy the lane; the destructor deletes *all* vehicles currently enqueued in the lane.
+	*/
+	virtual ~RingLane();
+
+	/*
+	Add a Vehicle to the back of the lane.
+	*/
+	virtual void enqueue(Vehicle* vehicle);
+
+	/*
+	Remove a vehicle from the front of the lane, returning a pointer to the removed vehicle. If there is no vehicle to
+	remove, this method returns 0 instead.
+	*/
+	virtual Vehicle* dequeue();
+
+	/*
+	Return whether or not the lane is empty; the returned value is `true` if there are no vehicles in the lane, or
+	`false` if there is at least one vehicle in the lane.
+	*/
+	virtual bool empty() const;
+
+	/*
+	Get the exact number of vehicles currently in the lane.
+	*/
+	virtual unsigned int count() const;
+
+	/*
+	Return a pointer to the vehicle at the front of the lane without removing it from the lane. If there are no vehicles
+	in the lane this method returns 0.
+	*/
+	virtual const Vehicle* front() const;
+
+	/*
+	Return a pointer to the vehicle at the back of the lane without removing it from the lane. If there are no vehicles
+	in the lane this method returns 0.
+	*/
+	virtual const Vehicle* back() const;
+
+	/*
+	Return a pointer to the vehicle `k` places behind the front of the lane without removing it, or 0 if there are `k`
+	or fewer vehicles in the lane. This takes O(1) time.
+	*/
+	virtual const Vehicle* peek(unsigned int k) const;
+
+	/*
+	Add `n` vehicles to the back of the lane, growing the buffer at most once.
+	*/
+	virtual void enqueueRange(Vehicle* const* vehicles, unsigned int n);
+
+	/*
+	Remove up to `max` vehicles from the front of the lane into `buffer`, returning the number removed.
+	*/
+	virtual unsigned int dequeueInto(Vehicle** buffer, unsigned int max);
+
+	/*
+	Move every vehicle from `other` to the back of this lane. If `other` is also a RingLane and this lane is empty the
+	two buffers are exchanged in O(1) time; otherwise the vehicle pointers are copied across.
+	*/
+	virtual void spliceFrom(Lane& other);
+
+	/*
+	Limit the lane to `capacity` vehicles, allocating room for all of them now so the buffer never grows while the
+	limit is respected.
+	*/
+	virtual void setCapacity(unsigned int capacity);
+
+	/*
+	Copy pointers to up to `max` vehicles from the front of the lane into `out`, straight from the buffer.
+	*/
+	virtual unsigned int snapshot(const Vehicle** out, unsigned int max) const;
+};
+
+inline void RingLane::enqueue(Vehicle* vehicle) {
+	// The buffer only allocates when it is full, so in steady state this is a single store
+	vehicles.push(vehicle);
+	recordEnqueue(vehicle, vehicles.count());
+}
+
+inline Vehicle* RingLane::dequeue() {
+	// If there are no vehicles then NULL is returned, otherwise the front slot is released and its vehicle returned
+	if (vehicles.empty()) {
+		return 0;
+	}
+	Vehicle* vehicle = vehicles.pop();
+	recordDequeue(vehicle);
+	return vehicle;
+}
+
+inline bool RingLane::empty() const {
+	return vehicles.empty();
+}
+
+inline unsigned int RingLane::count() const {
+	return vehicles.count();
+}
+
+inline const Vehicle* RingLane::front() const {
+	// If no vehicles are enqueued returns NULL, else the vehicle in the front slot
+	if (vehicles.empty()) {
+		return 0;
+	}
+	return vehicles.front();
+}
+
+inline const Vehicle* RingLane::back() const {
+	// If no vehicles are enqueued returns NULL, else the vehicle in the back slot
+	if (vehicles.empty()) {
+		return 0;
+	}
+	return vehicles.back();
+}
+
+inline const Vehicle* RingLane::peek(unsigned int k) const {
+	if (k >= vehicles.count()) {
+		return 0;
+	}
+	return vehicles.at(k);
+}
+
+#endif /* end of include guard: RINGLANE_HPP */
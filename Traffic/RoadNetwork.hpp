@@ -0,0 +1,324 @@
+#ifndef ROADNETWORK_HPP
+#define ROADNETWORK_HPP
+
+#include "Intersection.hpp"
+#include "SimpleLane.hpp"
+#include "SimClock.hpp"
+#include "WorkerPool.hpp"
+
+/*
+The BasicRoadNetwork class owns a road network: a fixed number of intersections and lanes, each kept in one contiguous
+array and referred to by its index. Lanes are wired to intersections with connect(), and step() advances the whole
+network by one tick. Destroying the network destroys its intersections and lanes, and with them every vehicle still in
+a lane.
+
+The network keeps the wiring as well as handing it to the intersections: for every lane the intersection it flows into
+(downstream) and out of (upstream), and, in compressed sparse row (CSR) form, the intersections each intersection feeds.
+It is written against a lane type `LaneT` and give way rules `Rules`, like BasicIntersection.
+
+A network steps in one of two modes. In SM_SEQUENTIAL mode, the default, the intersections are simulated one after the
+other, each seeing the vehicles the ones before it moved, so a vehicle can cross several intersections in one tick and
+the result depends on the order of the intersections. In SM_SYNCHRONOUS mode every intersection decides from the lanes
+as they were at the start of the tick: the vehicles it moves wait in a staging buffer for their lane, and only join the
+lane at the end of the tick. Each intersection reads only its own incoming lanes and writes only its own slots of the
+staging buffers, so the result is the same whatever order the intersections are simulated in, and ranges of them may
+be simulated on different threads (see stageIntersections()). step(WorkerPool&) does that, and gives the same result as
+step() in SM_SYNCHRONOUS mode on any number of threads.
+
+Only the intersections with vehicles waiting are simulated. Every lane wakes the intersection it flows into when it goes
+from empty to holding a vehicle (see Lane::watch()), and the network keeps a bit for each intersection that is awake; an
+intersection found with nothing waiting goes back to sleep. A step takes time in proportion to the intersections
+awake, plus a scan of one bit per intersection, and gives exactly the same result as simulating every intersection.
+
+Neighbouring intersections run fastest when they sit close together in the arrays. reorder() renumbers the network so
+that they do, and moves the intersections and lanes to match; edgeCut() measures how well a numbering splits the
+network between threads.
+*/
+class RoadNetworkBase {
+public:
+	/*
+	How step() simulates the intersections; see BasicRoadNetwork.
+	*/
+	enum StepMode { SM_SEQUENTIAL, SM_SYNCHRONOUS };
+};
+
+template <class LaneT, class Rules = LeftHandTraffic>
+class BasicRoadNetwork : public RoadNetworkBase {
+public:
+	typedef BasicIntersection<LaneT, Rules> IntersectionType;
+
+	/*
+	Returned in place of an index where there is no intersection or lane.
+	*/
+	static const unsigned int NONE = ~0u;
+
+	/*
+	Create a network of `intersectionCount` intersections and `laneCount` empty lanes, none of them connected.
+	*/
+	BasicRoadNetwork(unsigned int intersectionCount, unsigned int laneCount);
+
+	/*
+	Destroy the network, its intersections, its lanes and the vehicles in them.
+	*/
+	~BasicRoadNetwork();
+
+	/*
+	Get the number of intersections and of lanes.
+	*/
+	unsigned int intersectionCount() const {
+		return intersectionTotal;
+	}
+	unsigned int laneCount() const {
+		return laneTotal;
+	}
+
+	/*
+	Get intersection `i` or lane `l`.
+	*/
+	IntersectionType& intersection(unsigned int i) {
+		return intersections[i];
+	}
+	LaneT& lane(unsigned int l) {
+		return lanes[l];
+	}
+
+	/*
+	Connect lane `l` to side `side` (0 north, 1 east, 2 south, 3 west) of intersection `i`, replacing whatever lane was
+	there. With `direction` LD_INCOMING the lane flows into the intersection, with LD_OUTGOING out of it. Passing NONE as
+	`l` disconnects the side.
+	*/
+	void connect(unsigned int i, int side, unsigned int l, IntersectionBase::LaneDirection direction);
+
+	/*
+	Get the lane connected to side `side` of intersection `i`, or NONE.
+	*/
+	unsigned int laneAt(unsigned int i, int side) const {
+		return sideLanes[4 * i + side];
+	}
+
+	/*
+	Get the intersection lane `l` flows into, or out of, or NONE if that end of the lane is not connected.
+	*/
+	unsigned int downstreamOf(unsigned int l) const {
+		return laneDownstream[l];
+	}
+	unsigned int upstreamOf(unsigned int l) const {
+		return laneUpstream[l];
+	}
+
+	/*
+	Get the intersections fed by intersection `i`'s outgoing lanes, as the range [downstreamBegin(i), downstreamEnd(i)).
+	An intersection appears once for each lane joining them.
+	*/
+	const unsigned int* downstreamBegin(unsigned int i) {
+		buildAdjacency();
+		return adjacency + adjacencyStart[i];
+	}
+	const unsigned int* downstreamEnd(unsigned int i) {
+		buildAdjacency();
+		return adjacency + adjacencyStart[i + 1];
+	}
+
+	/*
+	Return `true` if intersection `i` is awake, so the next step will simulate it. An intersection that is asleep has
+	no vehicles waiting.
+	*/
+	bool active(unsigned int i) const {
+		return (activeBits[i / 64].load(std::memory_order_relaxed) >> (i % 64)) & 1;
+	}
+
+	/*
+	Renumber intersection i as `newIntersection[i]`, which must be a permutation of the intersection indices, and move
+	every intersection and lane in memory to match. Each lane is renumbered to sit next to the intersection it flows into
+	(or, if it flows into none, out of), in the order of their sides; lanes connected to no intersection go last. If
+	`newLane` is not 0 it is filled with the new number of every lane. Vehicles, capacities and recorded times move with
+	their lanes and intersections, but the lane counters (see LaneStats) restart from the vehicles in the lane. No
+	synchronous step may be in progress.
+	*/
+	void relabel(const unsigned int* newIntersection, unsigned int* newLane = 0);
+
+	/*
+	Renumber the network in Reverse Cuthill-McKee order, a breadth-first order that keeps the lanes between
+	intersections short in index terms, so that neighbours share cache lines and pages, and a split of the intersections
+	into consecutive ranges, as step(WorkerPool&) makes, cuts few lanes. If `newIntersection` or `newLane` is not 0 it
+	is filled with the new number of every intersection or lane. See relabel().
+	*/
+	void reorder(unsigned int* newIntersection = 0, unsigned int* newLane = 0);
+
+	/*
+	Get the number of lanes joining two intersections that fall in different parts when the intersections are split
+	into `parts` consecutive ranges of equal size, as step(WorkerPool&) splits them between threads.
+	*/
+	unsigned int edgeCut(unsigned int parts) const;
+
+	/*
+	Get or set the step mode. Networks start in SM_SEQUENTIAL mode.
+	*/
+	StepMode stepMode() const {
+		return mode;
+	}
+	void setStepMode(StepMode newMode) {
+		mode = newMode;
+	}
+
+	/*
+	Advance the network by one tick: simulate every intersection once, in index order in SM_SEQUENTIAL mode or as
+	prepareLanes(), stageIntersections() and commitLanes() over the whole network in SM_SYNCHRONOUS mode, then advance
+	the SimClock. Only the intersections that are awake are simulated, and only their lanes prepared and committed.
+	*/
+	void step();
+
+	/*
+	Advance the network by one synchronous tick, whatever the step mode, running each phase across `pool`'s threads,
+	then advance the SimClock. The result is the same as step() in SM_SYNCHRONOUS mode. Different lanes of the network
+	must be safe to use from different threads at the same time.
+	*/
+	void step(WorkerPool& pool);
+
+	/*
+	The three phases of a synchronous step. Each phase must be finished for the whole network before the next begins,
+	but the ranges within a phase may be run in any order or at the same time. These simulate every intersection in the
+	range, awake or not.
+	 - prepareLanes() records which of lanes [first, last) have room for another vehicle at the start of the tick.
+	 - stageIntersections() simulates intersections [first, last). A vehicle that proceeds leaves its incoming lane
+	   straight away but is held in the staging buffer of the lane it is going to. A lane that had room at the start of
+	   the tick takes a vehicle from each intersection it is connected to, so a lane fed from both ends in one tick (only
+	   possible for a vehicle turning into another incoming lane) can end the tick one vehicle over its capacity.
+	 - commitLanes() enqueues the staged vehicles of lanes [first, last), those from the lane's upstream intersection
+	   first.
+	The lanes of every intersection must have been connected with connect().
+	*/
+	void prepareLanes(unsigned int first, unsigned int last);
+	void stageIntersections(unsigned int first, unsigned int last);
+	void commitLanes(unsigned int first, unsigned int last);
+
+private:
+	/*
+	Private copy constructor and copy assignment operator - networks cannot be copied.
+	*/
+	BasicRoadNetwork(const BasicRoadNetwork&);
+	BasicRoadNetwork& operator=(const BasicRoadNetwork&);
+
+	/*
+	Rebuild the CSR adjacency if the wiring has changed since it was last built.
+	*/
+	void buildAdjacency();
+
+	/*
+	Fill `order` with the intersections in Cuthill-McKee order: breadth first from a peripheral intersection of each
+	connected part of the network, visiting neighbours with fewer lanes first.
+	*/
+	void cuthillMcKee(unsigned int* order) const;
+
+	/*
+	Add to `queue` the intersections reachable from `start`, breadth first with neighbours with fewer lanes first,
+	marking each one in `mark` with `stamp`, and return how many were added. `degree` holds the number of neighbours of
+	every intersection.
+	*/
+	unsigned int breadthFirst(unsigned int start, unsigned int* queue, unsigned int* mark, unsigned int stamp,
+		const unsigned int* degree) const;
+
+	/*
+	Get the intersection at the other end of the lane on side `side` of intersection `i`, or NONE.
+	*/
+	unsigned int neighbour(unsigned int i, int side) const;
+
+	/*
+	Wake intersection `i`.
+	*/
+	void activate(unsigned int i) {
+		activeBits[i / 64].fetch_or(1ull << (i % 64), std::memory_order_relaxed);
+	}
+
+	/*
+	Make lane `l` wake the intersection it flows into, if any.
+	*/
+	void watchLane(unsigned int l);
+
+	/*
+	Run stageIntersections() on the intersections in [first, last) that are awake, putting to sleep those with nothing
+	waiting.
+	*/
+	void stageActive(unsigned int first, unsigned int last);
+
+	/*
+	The chunks step(WorkerPool&) splits each phase into: CHUNKS_PER_THREAD for each of the pool's threads, so that
+	threads finishing early have chunks to steal, but never more than there are lanes or intersections.
+	*/
+	static const unsigned int CHUNKS_PER_THREAD = 8;
+	static unsigned int chunkCount(unsigned int total, const WorkerPool& pool);
+	static void chunkRange(unsigned int total, unsigned int chunks, unsigned int chunk, unsigned int& first,
+		unsigned int& last);
+
+	/*
+	WorkerPool tasks running one chunk of each phase of a synchronous step, with the network as their context.
+	*/
+	static void prepareChunk(void* network, unsigned int chunk);
+	static void stageChunk(void* network, unsigned int chunk);
+	static void commitChunk(void* network, unsigned int chunk);
+
+	/*
+	The router step() simulates intersections with in SM_SEQUENTIAL mode, which enqueues vehicles straight away.
+	*/
+	struct DirectRouter {
+		bool hasRoom(LaneT* lane) {
+			return !lane->full();
+		}
+		void deliver(LaneT* lane, Vehicle* vehicle) {
+			lane->enqueue(vehicle);
+		}
+	};
+
+	/*
+	The router stageIntersections() simulates intersection `intersection` with, which stages vehicles rather than
+	enqueueing them.
+	*/
+	struct StagingRouter {
+		BasicRoadNetwork* network;
+		unsigned int intersection;
+
+		bool hasRoom(LaneT* lane) {
+			return network->laneRoom[lane - network->lanes];
+		}
+		void deliver(LaneT* lane, Vehicle* vehicle) {
+			unsigned int l = lane - network->lanes;
+			network->staged[2 * l + (network->laneDownstream[l] == intersection ? 1 : 0)] = vehicle;
+		}
+	};
+
+	IntersectionType* intersections;
+	LaneT* lanes;
+	unsigned int intersectionTotal;
+	unsigned int laneTotal;
+	// The lane on each side of each intersection, 4 per intersection, and bit `side` of incomingSides[i] set when that
+	// lane flows into the intersection
+	unsigned int* sideLanes;
+	unsigned char* incomingSides;
+	unsigned int* laneDownstream;
+	unsigned int* laneUpstream;
+	// adjacency[adjacencyStart[i]] to adjacency[adjacencyStart[i + 1] - 1] are the intersections fed by intersection i
+	unsigned int* adjacencyStart;
+	unsigned int* adjacency;
+	bool adjacencyStale;
+	StepMode mode;
+	// Whether each lane had room at the start of the synchronous step
+	bool* laneRoom;
+	// Two staging slots per lane, for vehicles from its upstream and its downstream intersection; an intersection moves
+	// at most one vehicle into a lane per step
+	Vehicle** staged;
+	// Bit i % 64 of activeBits[i / 64] is set while intersection i is awake
+	std::atomic<unsigned long long>* activeBits;
+	unsigned int activeWords;
+	// The number of chunks of lanes and of intersections in the current step(WorkerPool&)
+	unsigned int laneChunks;
+	unsigned int intersectionChunks;
+};
+
+/*
+A network of SimpleLanes.
+*/
+typedef BasicRoadNetwork<SimpleLane> RoadNetwork;
+
+#include "RoadNetwork.tpp"
+
+#endif /* end of include guard: ROADNETWORK_HPP */
@@ -0,0 +1,506 @@
+// Template definitions for BasicRoadNetwork, included at the end of RoadNetwork.hpp
+
+template <class LaneT, class Rules>
+BasicRoadNetwork<LaneT, Rules>::BasicRoadNetwork(unsigned int intersectionCount, unsigned int laneCount) :
+	intersectionTotal(intersectionCount), laneTotal(laneCount) {
+	intersections = new IntersectionType[intersectionCount];
+	lanes = new LaneT[laneCount];
+	sideLanes = new unsigned int[4 * intersectionCount];
+	for (unsigned int s = 0; s < 4 * intersectionCount; s++) {
+		sideLanes[s] = NONE;
+	}
+	incomingSides = new unsigned char[intersectionCount];
+	for (unsigned int i = 0; i < intersectionCount; i++) {
+		incomingSides[i] = 0;
+	}
+	laneDownstream = new unsigned int[laneCount];
+	laneUpstream = new unsigned int[laneCount];
+	for (unsigned int l = 0; l < laneCount; l++) {
+		laneDownstream[l] = NONE;
+		laneUpstream[l] = NONE;
+	}
+	adjacencyStart = new unsigned int[intersectionCount + 1];
+	adjacency = 0;
+	adjacencyStale = true;
+	mode = SM_SEQUENTIAL;
+	laneRoom = new bool[laneCount];
+	staged = new Vehicle*[2 * laneCount];
+	for (unsigned int s = 0; s < 2 * laneCount; s++) {
+		staged[s] = 0;
+	}
+	laneChunks = 0;
+	intersectionChunks = 0;
+	// Every intersection starts awake, and the ones with nothing waiting go to sleep in the first step
+	activeWords = (intersectionCount + 63) / 64;
+	activeBits = new std::atomic<unsigned long long>[activeWords > 0 ? activeWords : 1];
+	for (unsigned int w = 0; w < activeWords; w++) {
+		activeBits[w].store(0, std::memory_order_relaxed);
+	}
+	for (unsigned int i = 0; i < intersectionCount; i++) {
+		activate(i);
+	}
+}
+
+template <class LaneT, class Rules>
+BasicRoadNetwork<LaneT, Rules>::~BasicRoadNetwork() {
+	delete[] intersections;
+	delete[] lanes;
+	delete[] sideLanes;
+	delete[] incomingSides;
+	delete[] laneDownstream;
+	delete[] laneUpstream;
+	delete[] adjacencyStart;
+	delete[] adjacency;
+	delete[] laneRoom;
+	delete[] activeBits;
+	// Vehicles staged by a synchronous step that was never committed belong to no lane
+	for (unsigned int s = 0; s < 2 * laneTotal; s++) {
+		delete staged[s];
+	}
+	delete[] staged;
+}
+
+template <class LaneT, class Rules>
+void BasicRoadNetwork<LaneT, Rules>::connect(unsigned int i, int side, unsigned int l,
+	IntersectionBase::LaneDirection direction) {
+	// Forget the lane this one replaces
+	unsigned int previous = sideLanes[4 * i + side];
+	if (previous != NONE) {
+		if (laneDownstream[previous] == i) {
+			laneDownstream[previous] = NONE;
+			watchLane(previous);
+		}
+		if (laneUpstream[previous] == i) {
+			laneUpstream[previous] = NONE;
+		}
+	}
+	sideLanes[4 * i + side] = l;
+	incomingSides[i] &= ~(1 << side);
+	if (l != NONE) {
+		if (direction == IntersectionBase::LD_INCOMING) {
+			laneDownstream[l] = i;
+			incomingSides[i] |= 1 << side;
+			watchLane(l);
+		}
+		else {
+			laneUpstream[l] = i;
+		}
+	}
+	intersections[i].connect(side, l != NONE ? &lanes[l] : 0, direction);
+	activate(i);
+	adjacencyStale = true;
+}
+
+template <class LaneT, class Rules>
+void BasicRoadNetwork<LaneT, Rules>::watchLane(unsigned int l) {
+	unsigned int i = laneDownstream[l];
+	if (i != NONE) {
+		lanes[l].watch(&activeBits[i / 64], 1ull << (i % 64));
+	}
+	else {
+		lanes[l].watch(0, 0);
+	}
+}
+
+template <class LaneT, class Rules>
+void BasicRoadNetwork<LaneT, Rules>::buildAdjacency() {
+	if (!adjacencyStale) {
+		return;
+	}
+	// Count each intersection's downstream neighbours, then fill them in
+	unsigned int edges = 0;
+	for (unsigned int i = 0; i < intersectionTotal; i++) {
+		adjacencyStart[i] = edges;
+		for (int side = 0; side < 4; side++) {
+			unsigned int l = sideLanes[4 * i + side];
+			if (l != NONE && laneUpstream[l] == i && laneDownstream[l] != NONE) {
+				edges++;
+			}
+		}
+	}
+	adjacencyStart[intersectionTotal] = edges;
+	delete[] adjacency;
+	adjacency = new unsigned int[edges > 0 ? edges : 1];
+	for (unsigned int i = 0; i < intersectionTotal; i++) {
+		unsigned int e = adjacencyStart[i];
+		for (int side = 0; side < 4; side++) {
+			unsigned int l = sideLanes[4 * i + side];
+			if (l != NONE && laneUpstream[l] == i && laneDownstream[l] != NONE) {
+				adjacency[e++] = laneDownstream[l];
+			}
+		}
+	}
+	adjacencyStale = false;
+}
+
+template <class LaneT, class Rules>
+unsigned int BasicRoadNetwork<LaneT, Rules>::neighbour(unsigned int i, int side) const {
+	unsigned int l = sideLanes[4 * i + side];
+	if (l == NONE) {
+		return NONE;
+	}
+	unsigned int j = (incomingSides[i] & (1 << side)) ? laneUpstream[l] : laneDownstream[l];
+	return j != i ? j : NONE;
+}
+
+template <class LaneT, class Rules>
+void BasicRoadNetwork<LaneT, Rules>::relabel(const unsigned int* newIntersection, unsigned int* newLane) {
+	unsigned int* oldIntersection = new unsigned int[intersectionTotal];
+	for (unsigned int i = 0; i < intersectionTotal; i++) {
+		oldIntersection[newIntersection[i]] = i;
+	}
+
+	// Number each lane after the intersection it flows into, or out of if it flows into none
+	unsigned int* laneMap = new unsigned int[laneTotal];
+	for (unsigned int l = 0; l < laneTotal; l++) {
+		laneMap[l] = NONE;
+	}
+	unsigned int next = 0;
+	for (unsigned int position = 0; position < intersectionTotal; position++) {
+		unsigned int i = oldIntersection[position];
+		for (int side = 0; side < 4; side++) {
+			unsigned int l = sideLanes[4 * i + side];
+			if (l != NONE && laneMap[l] == NONE && (laneDownstream[l] == i || laneDownstream[l] == NONE)) {
+				laneMap[l] = next++;
+			}
+		}
+	}
+	for (unsigned int l = 0; l < laneTotal; l++) {
+		if (laneMap[l] == NONE) {
+			laneMap[l] = next++;
+		}
+	}
+
+	// Move the lanes' vehicles, then rebuild the intersections and wiring around them
+	LaneT* movedLanes = new LaneT[laneTotal];
+	unsigned int* movedDownstream = new unsigned int[laneTotal];
+	unsigned int* movedUpstream = new unsigned int[laneTotal];
+	for (unsigned int l = 0; l < laneTotal; l++) {
+		unsigned int m = laneMap[l];
+		movedLanes[m].setCapacity(lanes[l].capacity());
+		movedLanes[m].spliceFrom(lanes[l]);
+		movedDownstream[m] = laneDownstream[l] != NONE ? newIntersection[laneDownstream[l]] : NONE;
+		movedUpstream[m] = laneUpstream[l] != NONE ? newIntersection[laneUpstream[l]] : NONE;
+	}
+	IntersectionType* movedIntersections = new IntersectionType[intersectionTotal];
+	unsigned int* movedSides = new unsigned int[4 * intersectionTotal];
+	unsigned char* movedIncoming = new unsigned char[intersectionTotal];
+	for (unsigned int i = 0; i < intersectionTotal; i++) {
+		unsigned int n = newIntersection[i];
+		movedIncoming[n] = incomingSides[i];
+		movedIntersections[n].swapTiming(intersections[i]);
+		for (int side = 0; side < 4; side++) {
+			unsigned int l = sideLanes[4 * i + side];
+			movedSides[4 * n + side] = l != NONE ? laneMap[l] : NONE;
+			movedIntersections[n].connect(side, l != NONE ? &movedLanes[laneMap[l]] : 0,
+				(incomingSides[i] & (1 << side)) ? IntersectionBase::LD_INCOMING : IntersectionBase::LD_OUTGOING);
+		}
+	}
+
+	delete[] intersections;
+	delete[] lanes;
+	delete[] sideLanes;
+	delete[] incomingSides;
+	delete[] laneDownstream;
+	delete[] laneUpstream;
+	intersections = movedIntersections;
+	lanes = movedLanes;
+	sideLanes = movedSides;
+	incomingSides = movedIncoming;
+	laneDownstream = movedDownstream;
+	laneUpstream = movedUpstream;
+	adjacencyStale = true;
+	for (unsigned int l = 0; l < laneTotal; l++) {
+		watchLane(l);
+	}
+	for (unsigned int i = 0; i < intersectionTotal; i++) {
+		activate(i);
+	}
+
+	if (newLane != 0) {
+		for (unsigned int l = 0; l < laneTotal; l++) {
+			newLane[l] = laneMap[l];
+		}
+	}
+	delete[] laneMap;
+	delete[] oldIntersection;
+}
+
+template <class LaneT, class Rules>
+void BasicRoadNetwork<LaneT, Rules>::reorder(unsigned int* newIntersection, unsigned int* newLane) {
+	unsigned int* order = new unsigned int[intersectionTotal];
+	cuthillMcKee(order);
+	// Reversing the Cuthill-McKee order gives the same bandwidth with less fill, and is the usual choice
+	unsigned int* renumbering = new unsigned int[intersectionTotal];
+	for (unsigned int k = 0; k < intersectionTotal; k++) {
+		renumbering[order[k]] = intersectionTotal - 1 - k;
+	}
+	relabel(renumbering, newLane);
+	if (newIntersection != 0) {
+		for (unsigned int i = 0; i < intersectionTotal; i++) {
+			newIntersection[i] = renumbering[i];
+		}
+	}
+	delete[] renumbering;
+	delete[] order;
+}
+
+template <class LaneT, class Rules>
+void BasicRoadNetwork<LaneT, Rules>::cuthillMcKee(unsigned int* order) const {
+	// Sort the intersections by their number of neighbours, at most 4, keeping index order within each number
+	unsigned int* degree = new unsigned int[intersectionTotal];
+	unsigned int first[5] = {};
+	for (unsigned int i = 0; i < intersectionTotal; i++) {
+		degree[i] = 0;
+		for (int side = 0; side < 4; side++) {
+			if (neighbour(i, side) != NONE) {
+				degree[i]++;
+			}
+		}
+		for (unsigned int d = degree[i] + 1; d < 5; d++) {
+			first[d]++;
+		}
+	}
+	unsigned int* byDegree = new unsigned int[intersectionTotal];
+	for (unsigned int i = 0; i < intersectionTotal; i++) {
+		byDegree[first[degree[i]]++] = i;
+	}
+
+	unsigned int* mark = new unsigned int[intersectionTotal];
+	for (unsigned int i = 0; i < intersectionTotal; i++) {
+		mark[i] = 0;
+	}
+	unsigned int placed = 0;
+	unsigned int stamp = 0;
+	for (unsigned int k = 0; k < intersectionTotal; k++) {
+		unsigned int start = byDegree[k];
+		if (mark[start] != 0) {
+			continue;
+		}
+		// The last intersection reached from the one with fewest neighbours is as far from it as any, and starts the
+		// real search from the edge of this part of the network
+		unsigned int reached = breadthFirst(start, order + placed, mark, ++stamp, degree);
+		breadthFirst(order[placed + reached - 1], order + placed, mark, ++stamp, degree);
+		placed += reached;
+	}
+	delete[] mark;
+	delete[] byDegree;
+	delete[] degree;
+}
+
+template <class LaneT, class Rules>
+unsigned int BasicRoadNetwork<LaneT, Rules>::breadthFirst(unsigned int start, unsigned int* queue, unsigned int* mark,
+	unsigned int stamp, const unsigned int* degree) const {
+	unsigned int head = 0;
+	unsigned int tail = 0;
+	queue[tail++] = start;
+	mark[start] = stamp;
+	while (head < tail) {
+		unsigned int i = queue[head++];
+		unsigned int first = tail;
+		for (int side = 0; side < 4; side++) {
+			unsigned int j = neighbour(i, side);
+			if (j == NONE || mark[j] == stamp) {
+				continue;
+			}
+			mark[j] = stamp;
+			// Insertion sort by number of neighbours
+			unsigned int k = tail++;
+			while (k > first && degree[queue[k - 1]] > degree[j]) {
+				queue[k] = queue[k - 1];
+				k--;
+			}
+			queue[k] = j;
+		}
+	}
+	return tail;
+}
+
+template <class LaneT, class Rules>
+unsigned int BasicRoadNetwork<LaneT, Rules>::edgeCut(unsigned int parts) const {
+	if (parts == 0) {
+		parts = 1;
+	}
+	unsigned int* part = new unsigned int[intersectionTotal];
+	for (unsigned int p = 0; p < parts; p++) {
+		unsigned int first, last;
+		chunkRange(intersectionTotal, parts, p, first, last);
+		for (unsigned int i = first; i < last; i++) {
+			part[i] = p;
+		}
+	}
+	unsigned int cut = 0;
+	for (unsigned int l = 0; l < laneTotal; l++) {
+		if (laneDownstream[l] != NONE && laneUpstream[l] != NONE && part[laneDownstream[l]] != part[laneUpstream[l]]) {
+			cut++;
+		}
+	}
+	delete[] part;
+	return cut;
+}
+
+template <class LaneT, class Rules>
+void BasicRoadNetwork<LaneT, Rules>::step() {
+	if (mode == SM_SYNCHRONOUS) {
+		unsigned int awake = 0;
+		for (unsigned int w = 0; w < activeWords; w++) {
+			awake += __builtin_popcountll(activeBits[w].load(std::memory_order_relaxed));
+		}
+		// Visiting the four lanes of each intersection awake is slower than passing over every lane in order once it
+		// touches about half the lanes
+		if (8 * awake >= laneTotal) {
+			prepareLanes(0, laneTotal);
+			stageActive(0, intersectionTotal);
+			commitLanes(0, laneTotal);
+			SimClock::tick();
+			return;
+		}
+		// Only the lanes of intersections that are awake can have vehicles staged for them
+		for (unsigned int w = 0; w < activeWords; w++) {
+			for (unsigned long long bits = activeBits[w].load(std::memory_order_relaxed); bits != 0; bits &= bits - 1) {
+				unsigned int i = 64 * w + __builtin_ctzll(bits);
+				for (int side = 0; side < 4; side++) {
+					unsigned int l = sideLanes[4 * i + side];
+					if (l != NONE) {
+						prepareLanes(l, l + 1);
+					}
+				}
+			}
+		}
+		stageActive(0, intersectionTotal);
+		for (unsigned int w = 0; w < activeWords; w++) {
+			for (unsigned long long bits = activeBits[w].load(std::memory_order_relaxed); bits != 0; bits &= bits - 1) {
+				unsigned int i = 64 * w + __builtin_ctzll(bits);
+				for (int side = 0; side < 4; side++) {
+					unsigned int l = sideLanes[4 * i + side];
+					if (l != NONE) {
+						commitLanes(l, l + 1);
+					}
+				}
+			}
+		}
+	}
+	else {
+		DirectRouter router;
+		for (unsigned int w = 0; w < activeWords; w++) {
+			unsigned long long bits = activeBits[w].load(std::memory_order_relaxed);
+			while (bits != 0) {
+				unsigned int b = __builtin_ctzll(bits);
+				// An intersection with nothing waiting goes to sleep. Only this thread uses the bits, so there is no need
+				// for an atomic read-modify-write
+				if (!intersections[64 * w + b].simulateWith(router)) {
+					activeBits[w].store(activeBits[w].load(std::memory_order_relaxed) & ~(1ull << b),
+						std::memory_order_relaxed);
+				}
+				// The vehicles just moved may have woken intersections further on in this word
+				bits = activeBits[w].load(std::memory_order_relaxed) & ~((2ull << b) - 1);
+			}
+		}
+	}
+	SimClock::tick();
+}
+
+template <class LaneT, class Rules>
+void BasicRoadNetwork<LaneT, Rules>::stageActive(unsigned int first, unsigned int last) {
+	StagingRouter router;
+	router.network = this;
+	for (unsigned int w = first / 64; w < (last + 63) / 64; w++) {
+		unsigned long long bits = activeBits[w].load(std::memory_order_relaxed);
+		// Keep to the bits of [first, last) in this word
+		if (w == first / 64) {
+			bits &= ~0ull << (first % 64);
+		}
+		if (w == last / 64) {
+			bits &= (1ull << (last % 64)) - 1;
+		}
+		// Nothing is woken while vehicles are only staged, so the sleepers can be cleared once for the whole word; the
+		// word may be shared with another range
+		unsigned long long asleep = 0;
+		for (; bits != 0; bits &= bits - 1) {
+			unsigned int b = __builtin_ctzll(bits);
+			router.intersection = 64 * w + b;
+			if (!intersections[64 * w + b].simulateWith(router)) {
+				asleep |= 1ull << b;
+			}
+		}
+		if (asleep != 0) {
+			activeBits[w].fetch_and(~asleep, std::memory_order_relaxed);
+		}
+	}
+}
+
+template <class LaneT, class Rules>
+void BasicRoadNetwork<LaneT, Rules>::prepareLanes(unsigned int first, unsigned int last) {
+	for (unsigned int l = first; l < last; l++) {
+		laneRoom[l] = !lanes[l].full();
+	}
+}
+
+template <class LaneT, class Rules>
+void BasicRoadNetwork<LaneT, Rules>::stageIntersections(unsigned int first, unsigned int last) {
+	StagingRouter router;
+	router.network = this;
+	for (unsigned int i = first; i < last; i++) {
+		router.intersection = i;
+		intersections[i].simulateWith(router);
+	}
+}
+
+template <class LaneT, class Rules>
+void BasicRoadNetwork<LaneT, Rules>::commitLanes(unsigned int first, unsigned int last) {
+	for (unsigned int l = first; l < last; l++) {
+		for (unsigned int s = 2 * l; s < 2 * l + 2; s++) {
+			if (staged[s] != 0) {
+				lanes[l].enqueue(staged[s]);
+				staged[s] = 0;
+			}
+		}
+	}
+}
+
+template <class LaneT, class Rules>
+void BasicRoadNetwork<LaneT, Rules>::step(WorkerPool& pool) {
+	laneChunks = chunkCount(laneTotal, pool);
+	intersectionChunks = chunkCount(intersectionTotal, pool);
+	pool.run(laneChunks, &prepareChunk, this);
+	pool.run(intersectionChunks, &stageChunk, this);
+	pool.run(laneChunks, &commitChunk, this);
+	SimClock::tick();
+}
+
+template <class LaneT, class Rules>
+unsigned int BasicRoadNetwork<LaneT, Rules>::chunkCount(unsigned int total, const WorkerPool& pool) {
+	unsigned int chunks = pool.threadCount() * CHUNKS_PER_THREAD;
+	return chunks < total ? chunks : total;
+}
+
+template <class LaneT, class Rules>
+void BasicRoadNetwork<LaneT, Rules>::chunkRange(unsigned int total, unsigned int chunks, unsigned int chunk,
+	unsigned int& first, unsigned int& last) {
+	first = (unsigned long long)total * chunk / chunks;
+	last = (unsigned long long)total * (chunk + 1) / chunks;
+}
+
+template <class LaneT, class Rules>
+void BasicRoadNetwork<LaneT, Rules>::prepareChunk(void* network, unsigned int chunk) {
+	BasicRoadNetwork* self = (BasicRoadNetwork*)network;
+	unsigned int first, last;
+	chunkRange(self->laneTotal, self->laneChunks, chunk, first, last);
+	self->prepareLanes(first, last);
+}
+
+template <class LaneT, class Rules>
+void BasicRoadNetwork<LaneT, Rules>::stageChunk(void* network, unsigned int chunk) {
+	BasicRoadNetwork* self = (BasicRoadNetwork*)network;
+	unsigned int first, last;
+	chunkRange(self->intersectionTotal, self->intersectionChunks, chunk, first, last);
+	self->stageActive(first, last);
+}
+
+template <class LaneT, class Rules>
+void BasicRoadNetwork<LaneT, Rules>::commitChunk(void* network, unsigned int chunk) {
+	BasicRoadNetwork* self = (BasicRoadNetwork*)network;
+	unsigned int first, last;
+	chunkRange(self->laneTotal, self->laneChunks, chunk, first, last);
+	self->commitLanes(first, last);
+}
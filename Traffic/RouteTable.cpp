@@ -0,0 +1,112 @@
+#include "RouteTable.hpp"
+
+#include <algorithm>
+
+/*
+FNV-1a hash of a turn sequence.
+*/
+static unsigned int hashTurns(const Vehicle::TurnDirection* turns, unsigned int length) {
+	unsigned int hash = 2166136261u;
+	for (unsigned int i = 0; i < length; i++) {
+		hash = (hash ^ (unsigned int)turns[i]) * 16777619u;
+	}
+	return (hash ^ length) * 16777619u;
+}
+
+RouteTable::RouteTable()
+	: arena(0), arenaSlots(0), arenaWords(0), routes(0), routeCount(0), routeCapacity(0), index(0), indexMask(0) {
+}
+
+RouteTable::~RouteTable() {
+	delete[] arena;
+	delete[] routes;
+	delete[] index;
+}
+
+unsigned int RouteTable::intern(const Vehicle::TurnDirection* turns, unsigned int length) {
+	unsigned int hash = hashTurns(turns, length);
+	// Look for the sequence first; the index is kept at most half full so probing always finds an empty bucket
+	if (index != 0) {
+		for (unsigned int bucket = hash & indexMask; index[bucket] != 0; bucket = (bucket + 1) & indexMask) {
+			unsigned int route = index[bucket] - 1;
+			if (routes[route].hash == hash && matches(route, turns, length)) {
+				return route;
+			}
+		}
+	}
+
+	// Append the turns to the arena, doubling it if they do not fit
+	unsigned int wordsNeeded = (arenaSlots + length + 31) / 32;
+	if (wordsNeeded > arenaWords) {
+		unsigned int newWords = arenaWords != 0 ? arenaWords : 8;
+		while (newWords < wordsNeeded) {
+			newWords *= 2;
+		}
+		unsigned long long* newArena = new unsigned long long[newWords]();
+		std::copy(arena, arena + arenaWords, newArena);
+		delete[] arena;
+		arena = newArena;
+		arenaWords = newWords;
+	}
+	for (unsigned int i = 0; i < length; i++) {
+		unsigned int slot = arenaSlots + i;
+		arena[slot >> 5] |= (unsigned long long)turns[i] << ((slot & 31) * 2);
+	}
+
+	if (routeCount == routeCapacity) {
+		unsigned int newCapacity = routeCapacity != 0 ? routeCapacity * 2 : 8;
+		Route* newRoutes = new Route[newCapacity];
+		std::copy(routes, routes + routeCount, newRoutes);
+		delete[] routes;
+		routes = newRoutes;
+		routeCapacity = newCapacity;
+	}
+	unsigned int route = routeCount++;
+	routes[route].start = arenaSlots;
+	routes[route].length = length;
+	routes[route].hash = hash;
+	arenaSlots += length;
+
+	if (index == 0 || 2 * routeCount > indexMask + 1) {
+		growIndex();
+	}
+	else {
+		unsigned int bucket = hash & indexMask;
+		while (index[bucket] != 0) {
+			bucket = (bucket + 1) & indexMask;
+		}
+		index[bucket] = route + 1;
+	}
+	return route;
+}
+
+unsigned long long RouteTable::memoryUsage() const {
+	unsigned long long indexSize = index != 0 ? indexMask + 1 : 0;
+	return arenaWords * sizeof(unsigned long long) + routeCapacity * sizeof(Route) + indexSize * sizeof(unsigned int);
+}
+
+bool RouteTable::matches(unsigned int route, const Vehicle::TurnDirection* turns, unsigned int length) const {
+	if (routes[route].length != length) {
+		return false;
+	}
+	for (unsigned int i = 0; i < length; i++) {
+		if (slotTurn(routes[route].start + i) != turns[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void RouteTable::growIndex() {
+	unsigned int size = index != 0 ? 2 * (indexMask + 1) : 16;
+	delete[] index;
+	index = new unsigned int[size]();
+	indexMask = size - 1;
+	for (unsigned int route = 0; route < routeCount; route++) {
+		unsigned int bucket = routes[route].hash & indexMask;
+		while (index[bucket] != 0) {
+			bucket = (bucket + 1) & indexMask;
+		}
+		index[bucket] = route + 1;
+	}
+}
@@ -0,0 +1,106 @@
+#ifndef ROUTETABLE_HPP
+#define ROUTETABLE_HPP
+
+#include "Vehicle.hpp"
+
+/*
+The RouteTable class stores turn sequences that many vehicles share. Each distinct sequence is interned once, packed at
+2 bits per turn into a single contiguous arena, and identified by a route id. A Vehicle following a route (see
+Vehicle::followRoute) keeps only the route id and its position along the route, and reads its turns from the table.
+
+Interning a sequence that is already in the table returns the existing id, so a demand file with millions of vehicles
+and a few thousand distinct routes only stores each route once. Route ids are allocated from 0 in the order routes are
+first interned. Routes are never removed, and the table must outlive every vehicle following one of its routes.
+*/
+class RouteTable {
+public:
+	/*
+	Create a new empty route table. No storage is allocated until the first route is interned.
+	*/
+	RouteTable();
+
+	/*
+	Destroy the table and release the arena.
+	*/
+	~RouteTable();
+
+	/*
+	Add the route made of the `length` turns in `turns` (each TD_LEFT, TD_STRAIGHT or TD_RIGHT) and return its id. If
+	the same sequence has been interned before, its existing id is returned and nothing is added.
+	*/
+	unsigned int intern(const Vehicle::TurnDirection* turns, unsigned int length);
+
+	/*
+	Get the number of distinct routes in the table.
+	*/
+	unsigned int count() const {
+		return routeCount;
+	}
+
+	/*
+	Get the number of turns in route `route`.
+	*/
+	unsigned int length(unsigned int route) const {
+		return routes[route].length;
+	}
+
+	/*
+	Get turn `index` of route `route`; `index` must be less than length(route).
+	*/
+	Vehicle::TurnDirection turn(unsigned int route, unsigned int index) const {
+		return slotTurn(routes[route].start + index);
+	}
+
+	/*
+	Get the number of bytes of heap storage used by the table.
+	*/
+	unsigned long long memoryUsage() const;
+
+private:
+	/*
+	Private copy constructor and copy assignment operator - tables own their storage and cannot be copied.
+	*/
+	RouteTable(const RouteTable&);
+	RouteTable& operator=(const RouteTable&);
+
+	/*
+	The part of the arena holding one route.
+	*/
+	struct Route {
+		unsigned int start;
+		unsigned int length;
+		unsigned int hash;
+	};
+
+	/*
+	Read the turn in slot `slot` of the arena.
+	*/
+	Vehicle::TurnDirection slotTurn(unsigned int slot) const {
+		return (Vehicle::TurnDirection)((arena[slot >> 5] >> ((slot & 31) * 2)) & 3);
+	}
+
+	/*
+	Return `true` if route `route` holds exactly the `length` turns in `turns`.
+	*/
+	bool matches(unsigned int route, const Vehicle::TurnDirection* turns, unsigned int length) const;
+
+	/*
+	Double the hash index and re-insert every route.
+	*/
+	void growIndex();
+
+	// Packed turns of every route, back to back, 32 per word
+	unsigned long long* arena;
+	unsigned int arenaSlots;
+	unsigned int arenaWords;
+
+	Route* routes;
+	unsigned int routeCount;
+	unsigned int routeCapacity;
+
+	// Open-addressed hash index from route contents to route id + 1; 0 marks an empty bucket
+	unsigned int* index;
+	unsigned int indexMask;
+};
+
+#endif /* end of include guard: ROUTETABLE_HPP */
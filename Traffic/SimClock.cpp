@@ -0,0 +1,3 @@
+#include "SimClock.hpp"
+
+std::atomic<unsigned int> SimClock::ticks(0);
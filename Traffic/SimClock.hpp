@@ -0,0 +1,40 @@
+#ifndef SIMCLOCK_HPP
+#define SIMCLOCK_HPP
+
+#include <atomic>
+
+/*
+The SimClock class holds the global simulation time, counted in ticks. Whatever drives the simulation advances the
+clock once per simulation step; lanes stamp vehicles with the current tick as they enqueue them, and intersections use
+those stamps to measure how long vehicles waited (see LatencyHistogram).
+
+The clock starts at tick 0. It may be read from any thread.
+*/
+class SimClock {
+public:
+	/*
+	Get the current tick.
+	*/
+	static unsigned int now() {
+		return ticks.load(std::memory_order_relaxed);
+	}
+
+	/*
+	Advance the clock by one tick and return the new tick.
+	*/
+	static unsigned int tick() {
+		return ticks.fetch_add(1, std::memory_order_relaxed) + 1;
+	}
+
+	/*
+	Set the clock to `tick`, e.g. 0 at the start of a new scenario.
+	*/
+	static void reset(unsigned int tick = 0) {
+		ticks.store(tick, std::memory_order_relaxed);
+	}
+
+private:
+	static std::atomic<unsigned int> ticks;
+};
+
+#endif /* end of include guard: SIMCLOCK_HPP */
@@ -1,4 +1,5 @@
 #include "SimpleLane.hpp"
+#include <typeinfo>
 
 SimpleLane::SimpleLane() {
 	// Initializing variables
@@ -31,14 +32,15 @@ void SimpleLane::enqueue(Vehicle* vehicle) {
 		lastVehicle = nodeToAdd;
 	}
 	sum++;
+	recordEnqueue(vehicle, sum);
 }
 
 Vehicle* SimpleLane::dequeue() {
 	// If front vehicle's pointer is NULL then no vehicle can be dequeued and NULL is returned
 	// If front vehicle's pointer is equal to last vehicle's pointer then that's the last vehicle
 	// and both are set to NULL or else front vehicle is now the second enqueued vehicle
-	// the front vehicle node is saved and its vehicle is saved so it can be returned and
-	// sum of total vehicles is decremented
+	// the front vehicle node is saved and its vehicle is saved so it can be returned, the node is
+	// deleted and sum of total vehicles is decremented
 	if (frontVehicle == 0) {
 		return 0;
 	}
@@ -51,39 +53,112 @@ Vehicle* SimpleLane::dequeue() {
 		frontVehicle = frontVehicle->getNext();
 	}
 	Vehicle *toReturn = nodeToDelete->getQueued();
+	delete nodeToDelete;
 	sum--;
+	recordDequeue(toReturn);
 	return toReturn;
 }
 
-bool SimpleLane::empty() const {
-	// If sum of total vehicles is equal to 0, returns true which means it is empty or else returns false
-	if (sum == 0) {
-		return true;
+const Vehicle* SimpleLane::peek(unsigned int k) const {
+	// Walks k nodes from the front vehicle, returning NULL if the queue ends first
+	if (k >= (unsigned int)sum) {
+		return 0;
+	}
+	Node *ref = frontVehicle;
+	for (unsigned int i = 0; i < k; i++) {
+		ref = ref->getNext();
+	}
+	return ref->getQueued();
+}
+
+void SimpleLane::enqueueRange(Vehicle* const* vehicles, unsigned int n) {
+	if (n == 0) {
+		return;
+	}
+	// The new vehicles are linked into a chain first so the lane is only updated once
+	Node *first = new Node(vehicles[0]);
+	Node *last = first;
+	recordEnqueue(vehicles[0], sum + 1);
+	for (unsigned int i = 1; i < n; i++) {
+		Node *nodeToAdd = new Node(vehicles[i]);
+		last->setNext(nodeToAdd);
+		last = nodeToAdd;
+		recordEnqueue(vehicles[i], sum + i + 1);
+	}
+	if (frontVehicle == 0) {
+		frontVehicle = first;
 	}
 	else {
-		return false;
+		lastVehicle->setNext(first);
 	}
+	lastVehicle = last;
+	sum += n;
 }
 
-unsigned int SimpleLane::count() const {
-	// returns sum which is incremented and decremented everytime vehicles are enqueued or dequeued
-	return sum;
+unsigned int SimpleLane::dequeueInto(Vehicle** buffer, unsigned int max) {
+	// Unlinks nodes from the front until max vehicles have been removed or the lane is empty
+	unsigned int n = 0;
+	while (n < max && frontVehicle != 0) {
+		Node *nodeToDelete = frontVehicle;
+		frontVehicle = frontVehicle->getNext();
+		buffer[n++] = nodeToDelete->getQueued();
+		delete nodeToDelete;
+		recordDequeue(buffer[n - 1]);
+	}
+	if (frontVehicle == 0) {
+		lastVehicle = 0;
+	}
+	sum -= n;
+	return n;
 }
 
-const Vehicle* SimpleLane::front() const {
-	// If front vehicles pointer is NULL that means no vehicles are enqueued and returns NULL
-	// else it returns front vehicles pointer stored in the front vehicle node
-	if (frontVehicle != 0) {
-		return frontVehicle->getQueued();
+void SimpleLane::spliceFrom(Lane& other) {
+	// Subclasses such as ExpressLane keep extra state about their nodes, so only an exact SimpleLane can
+	// hand its nodes over directly
+	if (typeid(other) != typeid(SimpleLane)) {
+		Lane::spliceFrom(other);
+		return;
 	}
-	return 0;
+	SimpleLane &source = static_cast<SimpleLane&>(other);
+	if (&source == this || source.frontVehicle == 0) {
+		return;
+	}
+	if (frontVehicle == 0) {
+		frontVehicle = source.frontVehicle;
+	}
+	else {
+		lastVehicle->setNext(source.frontVehicle);
+	}
+	lastVehicle = source.lastVehicle;
+	sum += source.sum;
+	recordSplice(source, source.sum, sum);
+
+	source.frontVehicle = 0;
+	source.lastVehicle = 0;
+	source.sum = 0;
 }
 
-const Vehicle* SimpleLane::back() const {
-	// If last vehicles pointer is NULL that means no vehicles are enqueued and returns NULL
-	// else it returns last vehicles pointer stored in the last vehicle node
-	if (lastVehicle != 0) {
-		return lastVehicle->getQueued();
+unsigned int SimpleLane::snapshot(const Vehicle** out, unsigned int max) const {
+	unsigned int n = 0;
+	for (Node *node = frontVehicle; node != 0 && n < max; node = node->getNext()) {
+		out[n++] = node->getQueued();
+	}
+	return n;
+}
+
+LaneCursor SimpleLane::cursorBegin() const {
+	LaneCursor cursor;
+	cursor.node = frontVehicle;
+	cursor.index = 0;
+	return cursor;
+}
+
+const Vehicle* SimpleLane::cursorNext(LaneCursor& cursor) const {
+	const Node *node = static_cast<const Node*>(cursor.node);
+	if (node == 0) {
+		return 0;
 	}
-	return 0;
+	cursor.node = node->getNext();
+	cursor.index++;
+	return node->getQueued();
 }
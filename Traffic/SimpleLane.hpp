@@ -9,6 +9,9 @@ The SimpleLane class simulates a single lane of a road. It is a FIFO queue for V
 
 Vehicles can be added to the back of the lane with the enqueue() method and removed from the front of the lane using the
 dequeue() method.
+
+Subclasses may change where vehicles are enqueued, but not how the queue is inspected, so the inspection methods are
+final and defined in this header where they can be inlined.
 */
 class SimpleLane : public Lane {
 protected:
@@ -41,25 +44,92 @@ public:
 	Return whether or not the lane is empty; the returned value is `true` if there are no vehicles in the lane, or
 	`false` if there is at least one vehicle in the lane.
 	*/
-	virtual bool empty() const;
+	virtual bool empty() const final;
 
 	/*
 	Get the exact number of vehicles currently in the lane; e.g. should return 0 if there are no vehicles in the lane,
 	or 4 if there are four vehicles in the lane.
 	*/
-	virtual unsigned int count() const;
+	virtual unsigned int count() const final;
 
 	/*
 	Return a pointer to the vehicle at the front of the lane without removing it from the lane. If there are no vehicles
 	in the lane this method should return 0.
 	*/
-	virtual const Vehicle* front() const;
+	virtual const Vehicle* front() const final;
 
 	/*
 	Return a pointer to the vehicle at the back of the lane without removing it from the lane. If there are no vehicles
 	in the lane this method should return 0.
 	*/
-	virtual const Vehicle* back() const;
+	virtual const Vehicle* back() const final;
+
+	/*
+	Return a pointer to the vehicle `k` places behind the front of the lane without removing it, or 0 if there are `k`
+	or fewer vehicles in the lane. This walks `k` nodes of the queue.
+	*/
+	virtual const Vehicle* peek(unsigned int k) const final;
+
+	/*
+	Add `n` vehicles to the back of the lane. The new nodes are linked together before being attached to the lane.
+	*/
+	virtual void enqueueRange(Vehicle* const* vehicles, unsigned int n);
+
+	/*
+	Remove up to `max` vehicles from the front of the lane into `buffer`, returning the number removed.
+	*/
+	virtual unsigned int dequeueInto(Vehicle** buffer, unsigned int max);
+
+	/*
+	Move every vehicle from `other` to the back of this lane. If `other` is also a SimpleLane its node chain is
+	attached to this lane in O(1) time.
+	*/
+	virtual void spliceFrom(Lane& other);
+
+	/*
+	Copy pointers to up to `max` vehicles from the front of the lane into `out` by walking the nodes.
+	*/
+	virtual unsigned int snapshot(const Vehicle** out, unsigned int max) const final;
+
+protected:
+	/*
+	Iterate the lane node by node, so each step is O(1) rather than a peek() from the front.
+	*/
+	virtual LaneCursor cursorBegin() const final;
+	virtual const Vehicle* cursorNext(LaneCursor& cursor) const final;
 };
 
+inline bool SimpleLane::empty() const {
+	// If sum of total vehicles is equal to 0, returns true which means it is empty or else returns false
+	if (sum == 0) {
+		return true;
+	}
+	else {
+		return false;
+	}
+}
+
+inline unsigned int SimpleLane::count() const {
+	// returns sum which is incremented and decremented everytime vehicles are enqueued or dequeued
+	return sum;
+}
+
+inline const Vehicle* SimpleLane::front() const {
+	// If front vehicles pointer is NULL that means no vehicles are enqueued and returns NULL
+	// else it returns front vehicles pointer stored in the front vehicle node
+	if (frontVehicle != 0) {
+		return frontVehicle->getQueued();
+	}
+	return 0;
+}
+
+inline const Vehicle* SimpleLane::back() const {
+	// If last vehicles pointer is NULL that means no vehicles are enqueued and returns NULL
+	// else it returns last vehicles pointer stored in the last vehicle node
+	if (lastVehicle != 0) {
+		return lastVehicle->getQueued();
+	}
+	return 0;
+}
+
 #endif /* end of include guard: SIMPLELANE_HPP */
@@ -0,0 +1,123 @@
+#include "SpscLane.hpp"
+#include "Vehicle.hpp"
+
+#include <thread>
+
+SpscLane::SpscLane(unsigned int capacity) : head(0), cachedTail(0), tail(0), cachedHead(0) {
+	// The capacity is rounded up to a power of two so positions can be wrapped with a mask
+	unsigned int size = 2;
+	while (size < capacity) {
+		size *= 2;
+	}
+	slots = new Vehicle*[size];
+	mask = size - 1;
+	vehicleLimit = size;
+}
+
+SpscLane::~SpscLane() {
+	// dequeues all vehicles until no vehicles are left and deletes the vehicle
+	while (!empty()) {
+		delete dequeue();
+	}
+	delete[] slots;
+}
+
+bool SpscLane::tryEnqueue(Vehicle* vehicle) {
+	unsigned int t = tail.load(std::memory_order_relaxed);
+	// Only re-read the consumer's position when the lane looks full
+	if (t - cachedHead > mask) {
+		cachedHead = head.load(std::memory_order_acquire);
+		if (t - cachedHead > mask) {
+			return false;
+		}
+	}
+	slots[t & mask] = vehicle;
+#ifndef TRAFFIC_NO_TIMING
+	vehicle->recordMove(SimClock::now());
+#endif
+#ifndef TRAFFIC_NO_LANE_STATS
+	// Counted before publishing, so the consumer cannot count the vehicle leaving first
+	atomicStats.recordEnqueue(vehicle, t + 1 - head.load(std::memory_order_relaxed));
+#endif
+	if (watched() && t + 1 - head.load(std::memory_order_relaxed) == 1) {
+		recordOccupied();
+	}
+	// Publishing the new tail makes the slot visible to the consumer
+	tail.store(t + 1, std::memory_order_release);
+	return true;
+}
+
+void SpscLane::enqueue(Vehicle* vehicle) {
+	while (!tryEnqueue(vehicle)) {
+		std::this_thread::yield();
+	}
+}
+
+Vehicle* SpscLane::dequeue() {
+	unsigned int h = head.load(std::memory_order_relaxed);
+	// Only re-read the producer's position when the lane looks empty
+	if (h == cachedTail) {
+		cachedTail = tail.load(std::memory_order_acquire);
+		if (h == cachedTail) {
+			return 0;
+		}
+	}
+	Vehicle* vehicle = slots[h & mask];
+#ifndef TRAFFIC_NO_LANE_STATS
+	atomicStats.recordDequeue(vehicle);
+#endif
+	// Publishing the new head hands the slot back to the producer
+	head.store(h + 1, std::memory_order_release);
+	return vehicle;
+}
+
+bool SpscLane::empty() const {
+	return front() == 0;
+}
+
+unsigned int SpscLane::count() const {
+	// head is read first; tail never falls behind it, so the difference cannot underflow
+	unsigned int h = head.load(std::memory_order_acquire);
+	unsigned int t = tail.load(std::memory_order_acquire);
+	return t - h;
+}
+
+const Vehicle* SpscLane::front() const {
+	return peek(0);
+}
+
+const Vehicle* SpscLane::back() const {
+	// Acquire so the consumer thread also sees the vehicle written before the tail was published
+	unsigned int t = tail.load(std::memory_order_acquire);
+	if (t == head.load(std::memory_order_acquire)) {
+		return 0;
+	}
+	return slots[(t - 1) & mask];
+}
+
+const Vehicle* SpscLane::peek(unsigned int k) const {
+	unsigned int h = head.load(std::memory_order_relaxed);
+	if (cachedTail - h <= k) {
+		cachedTail = tail.load(std::memory_order_acquire);
+		if (cachedTail - h <= k) {
+			return 0;
+		}
+	}
+	return slots[(h + k) & mask];
+}
+
+void SpscLane::setCapacity(unsigned int capacity) {
+	// The ring cannot grow, so the limit stays within it
+	if (capacity == 0 || capacity > mask + 1) {
+		capacity = mask + 1;
+	}
+	Lane::setCapacity(capacity);
+}
+
+LaneStats SpscLane::stats() const {
+#ifndef TRAFFIC_NO_LANE_STATS
+	return atomicStats.snapshot();
+#else
+	return LaneStats();
+#endif
+}
@@ -0,0 +1,114 @@
+#ifndef SPSCLANE_HPP
+#define SPSCLANE_HPP
+
+#include <atomic>
+
+#include "Lane.hpp"
+
+/*
+The SpscLane class is a FIFO lane that can be shared between two threads: one producer thread that enqueues vehicles
+(e.g. the upstream intersection, or a demand injector) and one consumer thread that dequeues them (the downstream
+intersection). It is a bounded, lock-free ring buffer.
+
+The producer owns the back of the lane and the consumer owns the front:
+ - enqueue and tryEnqueue may only be called from the producer thread.
+ - dequeue, front, peek and empty may only be called from the consumer thread.
+ - back and count may be called from either thread. The result is exact when the other thread is idle and a
+   consistent snapshot otherwise.
+When only one thread uses the lane it behaves exactly like SimpleLane, up to its capacity.
+
+The head and tail positions sit on separate cache lines, and each side caches the last position it read from the
+other, so the two threads only share a cache line when the lane is close to empty or full.
+*/
+class SpscLane final : public Lane {
+public:
+	/*
+	Create a new empty lane holding up to `capacity` vehicles, rounded up to a power of two. capacity() reports the
+	rounded size.
+	*/
+	explicit SpscLane(unsigned int capacity = 1024);
+
+	/*
+	Destroy the lane; the destructor deletes *all* vehicles currently enqueued in the lane. Neither thread may be using
+	the lane at this point.
+	*/
+	virtual ~SpscLane();
+
+	/*
+	Add a Vehicle to the back of the lane. If the lane is full this waits for the consumer to make room.
+	*/
+	virtual void enqueue(Vehicle* vehicle);
+
+	/*
+	Add a Vehicle to the back of the lane if there is room, returning `true`, or return `false` if the lane is full.
+	*/
+	bool tryEnqueue(Vehicle* vehicle);
+
+	/*
+	Remove a vehicle from the front of the lane, returning a pointer to the removed vehicle. If there is no vehicle to
+	remove, this method returns 0 instead.
+	*/
+	virtual Vehicle* dequeue();
+
+	/*
+	Return `true` if there are no vehicles in the lane, otherwise `false`.
+	*/
+	virtual bool empty() const;
+
+	/*
+	Get the number of vehicles currently in the lane.
+	*/
+	virtual unsigned int count() const;
+
+	/*
+	Return a pointer to the vehicle at the front of the lane without removing it, or 0 if the lane is empty.
+	*/
+	virtual const Vehicle* front() const;
+
+	/*
+	Return a pointer to the vehicle most recently enqueued, or 0 if the lane is empty.
+	*/
+	virtual const Vehicle* back() const;
+
+	/*
+	Return a pointer to the vehicle `k` places behind the front of the lane, or 0 if there are `k` or fewer vehicles.
+	*/
+	virtual const Vehicle* peek(unsigned int k) const;
+
+	/*
+	Limit the lane to `capacity` vehicles. The limit cannot be removed or raised above the size of the ring, which is
+	the lane's initial capacity.
+	*/
+	virtual void setCapacity(unsigned int capacity);
+
+	/*
+	Get the lane's traffic counters. Enqueue and dequeue update them from different threads, so they are kept in
+	atomics and copied out here.
+	*/
+	virtual LaneStats stats() const;
+
+private:
+	/*
+	Private copy constructor and copy assignment operator - lanes cannot be copied.
+	*/
+	SpscLane(const SpscLane&);
+	SpscLane& operator=(const SpscLane&);
+
+	Vehicle** slots;
+	unsigned int mask;
+#ifndef TRAFFIC_NO_LANE_STATS
+	AtomicLaneStats atomicStats;
+#endif
+
+	// Consumer side: position of the front vehicle, and the last tail position the consumer has seen
+	alignas(64) std::atomic<unsigned int> head;
+	mutable unsigned int cachedTail;
+
+	// Producer side: position one past the back vehicle, and the last head position the producer has seen
+	alignas(64) std::atomic<unsigned int> tail;
+	unsigned int cachedHead;
+
+	char padding[64 - sizeof(std::atomic<unsigned int>) - sizeof(unsigned int)];
+};
+
+#endif /* end of include guard: SPSCLANE_HPP */
@@ -1,10 +1,23 @@
 #include "Vehicle.hpp"
+#include "RouteTable.hpp"
 
-Vehicle::Vehicle(Type newType, unsigned int occupantCount) : vehicleType(newType), occupants(occupantCount) {
+Vehicle::Vehicle(Type newType, unsigned int occupantCount)
+    : inlineTurns(0), spilledTurns(0), turnHead(0), turnCount(0), occupants(occupantCount), vehicleType(newType),
+      turnCapacityLog2(0), followingRoute(false) {
+#ifndef TRAFFIC_NO_TIMING
+    journeyStart = NO_TICK;
+    lastMove = NO_TICK;
+#endif
+}
+
+Vehicle::~Vehicle() {
+    if (!this->followingRoute) {
+        delete[] spilledTurns;
+    }
 }
 
 Vehicle::Type Vehicle::type() const {
-    return this->vehicleType;
+    return (Type)this->vehicleType;
 }
 
 unsigned int Vehicle::occupantCount() const {
@@ -13,31 +26,108 @@ unsigned int Vehicle::occupantCount() const {
 
 Vehicle::TurnDirection Vehicle::nextTurn() const {
     // Handle case where turn queue is empty; return TD_INVALID by default.
-    if (this->turns.empty()) {
+    if (this->turnCount == 0) {
         return TD_INVALID;
     }
-    return this->turns.front();
+    if (this->followingRoute) {
+        return this->routeTable->turn(this->routeId, this->turnHead);
+    }
+    return turnAt(this->turnHead);
 }
 
 Vehicle::TurnDirection Vehicle::makeTurn() {
     // Return TD_INVALID by default
     TurnDirection td = TD_INVALID;
     // Make sure turn queue is not empty
-    if (!this->turns.empty()) {
-        td = this->turns.front();
-        this->turns.pop();
+    if (this->turnCount != 0 && this->followingRoute) {
+        td = this->routeTable->turn(this->routeId, this->turnHead);
+        this->turnHead++;
+        this->turnCount--;
+    }
+    else if (this->turnCount != 0) {
+        td = turnAt(this->turnHead);
+        this->turnHead = (this->turnHead + 1) & ((32u << this->turnCapacityLog2) - 1);
+        this->turnCount--;
     }
     return td;
 }
 
+unsigned int Vehicle::turnsLeft() const {
+    return this->turnCount;
+}
+
 void Vehicle::turnLeft() {
-    this->turns.push(TD_LEFT);
+    pushTurn(TD_LEFT);
 }
 
 void Vehicle::turnRight() {
-    this->turns.push(TD_RIGHT);
+    pushTurn(TD_RIGHT);
 }
 
 void Vehicle::turnStraight() {
-    this->turns.push(TD_STRAIGHT);
-}
\ No newline at end of file
+    pushTurn(TD_STRAIGHT);
+}
+
+Vehicle::TurnDirection Vehicle::turnAt(unsigned int slot) const {
+    unsigned long long word = slot < 32 ? this->inlineTurns : this->spilledTurns[(slot >> 5) - 1];
+    return (TurnDirection)((word >> ((slot & 31) * 2)) & 3);
+}
+
+void Vehicle::setTurnAt(unsigned int slot, TurnDirection turn) {
+    unsigned long long& word = slot < 32 ? this->inlineTurns : this->spilledTurns[(slot >> 5) - 1];
+    unsigned int shift = (slot & 31) * 2;
+    word = (word & ~(3ull << shift)) | ((unsigned long long)turn << shift);
+}
+
+void Vehicle::followRoute(const RouteTable& table, unsigned int route) {
+    if (!this->followingRoute) {
+        delete[] this->spilledTurns;
+    }
+    this->routeId = route;
+    this->routeTable = &table;
+    this->turnHead = 0;
+    this->turnCount = table.length(route);
+    this->turnCapacityLog2 = 0;
+    this->followingRoute = true;
+}
+
+void Vehicle::leaveRoute() {
+    const RouteTable* table = this->routeTable;
+    unsigned int route = this->routeId;
+    unsigned int position = this->turnHead;
+    unsigned int remaining = this->turnCount;
+    this->inlineTurns = 0;
+    this->spilledTurns = 0;
+    this->turnHead = 0;
+    this->turnCount = 0;
+    this->followingRoute = false;
+    for (unsigned int i = 0; i < remaining; i++) {
+        pushTurn(table->turn(route, position + i));
+    }
+}
+
+void Vehicle::pushTurn(TurnDirection turn) {
+    if (this->followingRoute) {
+        leaveRoute();
+    }
+    unsigned int capacity = 32u << this->turnCapacityLog2;
+    if (this->turnCount == capacity) {
+        // Unpack the full ring into storage twice the size, starting again from slot 0
+        unsigned int spilledWords = 2 * capacity / 32 - 1;
+        unsigned long long newInline = 0;
+        unsigned long long* newSpilled = new unsigned long long[spilledWords]();
+        for (unsigned int i = 0; i < this->turnCount; i++) {
+            unsigned long long value = turnAt((this->turnHead + i) & (capacity - 1));
+            unsigned long long& word = i < 32 ? newInline : newSpilled[(i >> 5) - 1];
+            word |= value << ((i & 31) * 2);
+        }
+        delete[] this->spilledTurns;
+        this->inlineTurns = newInline;
+        this->spilledTurns = newSpilled;
+        this->turnHead = 0;
+        this->turnCapacityLog2++;
+        capacity *= 2;
+    }
+    setTurnAt((this->turnHead + this->turnCount) & (capacity - 1), turn);
+    this->turnCount++;
+}
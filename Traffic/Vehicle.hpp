@@ -1,15 +1,19 @@
 #ifndef VEHICLE_HPP
 #define VEHICLE_HPP
 
-// This use of <queue> is allowed, but you should not use it in your own code.
-#include <queue>
+class RouteTable;
 
 /*
 The vehicle class represents a single vehicle travelling along a road. Each vehicle has a type, a number of occupants,
 and a queue of turns it must make along its journey. If the vehicle's turn queue is empty, by default it will attempt to
 keep going straight.
 
-You should not modify this class.
+The turn queue is packed at 2 bits per turn. The first 32 turns are stored inside the vehicle itself, so most vehicles
+never allocate; longer routes spill into a heap array that doubles as needed. Alternatively a vehicle can follow a
+route interned in a RouteTable, in which case it only stores the route id and how far along the route it is.
+
+Each vehicle also records the simulation tick (see SimClock) at which it first entered a lane and at which it last
+moved into one; lanes stamp these as vehicles are enqueued. Building with TRAFFIC_NO_TIMING defined removes the stamps.
 */
 class Vehicle {
 public:
@@ -31,6 +35,11 @@ public:
     */
     enum TurnDirection { TD_LEFT, TD_STRAIGHT, TD_RIGHT, TD_INVALID };
 
+    /*
+    Tick value meaning a vehicle has not been stamped.
+    */
+    static const unsigned int NO_TICK = 0xFFFFFFFFu;
+
     /*
     The Vehicle constructor; sets the type of the vehicle (which cannot change) and the number of occupants in the
     vehicle. By default, the direction the car wants to turn in will be set to TD_STRAIGHT; to change it, call the
@@ -38,6 +47,11 @@ public:
     */
     Vehicle(Type newType, unsigned int occupantCount);
 
+    /*
+    The Vehicle destructor; releases the spilled part of the turn queue, if any.
+    */
+    ~Vehicle();
+
     /*
     Get the type of this vehicle. Inspect the definition of the Type enum for more information about vehicle types.
     */
@@ -60,6 +74,11 @@ public:
     */
     TurnDirection makeTurn();
 
+    /*
+    Get the number of turns left in the turn queue.
+    */
+    unsigned int turnsLeft() const;
+
     /*
     Add a left turn (TD_RIGHT) to the turn queue, indicating this Vehicle will turn left at the corresponding
     intersection if possible.
@@ -78,11 +97,54 @@ public:
     */
     void turnStraight();
 
+    /*
+    Replace the turn queue with route `route` of `table`; the vehicle then makes the route's turns in order. This does
+    not allocate. The table must outlive the vehicle, or at least its use of the route. Adding a turn with turnLeft(),
+    turnRight() or turnStraight() afterwards copies the remaining turns of the route into the vehicle's own queue first.
+    */
+    void followRoute(const RouteTable& table, unsigned int route);
+
+    /*
+    Get the tick at which the vehicle was first enqueued into a lane, or NO_TICK if it never has been.
+    */
+    unsigned int journeyStartTick() const {
+#ifndef TRAFFIC_NO_TIMING
+        return journeyStart;
+#else
+        return NO_TICK;
+#endif
+    }
+
+    /*
+    Get the tick at which the vehicle was last enqueued into a lane, or NO_TICK if it never has been.
+    */
+    unsigned int lastMoveTick() const {
+#ifndef TRAFFIC_NO_TIMING
+        return lastMove;
+#else
+        return NO_TICK;
+#endif
+    }
+
+    /*
+    Stamp the vehicle as moving into a lane at tick `tick`. Lanes call this from enqueue.
+    */
+    void recordMove(unsigned int tick) {
+#ifndef TRAFFIC_NO_TIMING
+        if (journeyStart == NO_TICK) {
+            journeyStart = tick;
+        }
+        lastMove = tick;
+#else
+        (void)tick;
+#endif
+    }
+
 private:
     /*
     Private Vehicle copy constructor - vehicles cannot be copied, must be passed around via pointers and references.
     */
-    Vehicle(const Vehicle&){};
+    Vehicle(const Vehicle&);
 
     /*
     Private Vehicle copy assignment operator - vehicles cannot be copied, must be passed around via pointers and
@@ -92,9 +154,44 @@ private:
         return *this;
     };
 
-    Type vehicleType;
+    /*
+    Read or write the turn in slot `slot` of the turn queue. Slots 0-31 are in inlineTurns, the rest in spilledTurns.
+    */
+    TurnDirection turnAt(unsigned int slot) const;
+    void setTurnAt(unsigned int slot, TurnDirection turn);
+
+    /*
+    Add a turn to the back of the turn queue, doubling its storage first if it is full.
+    */
+    void pushTurn(TurnDirection turn);
+
+    /*
+    Stop following a route, moving its remaining turns into the vehicle's own turn queue.
+    */
+    void leaveRoute();
+
+    // Owned turns: a ring of 32 << turnCapacityLog2 two-bit slots, starting at slot turnHead.
+    // Following a route: turn turnHead of route routeId in routeTable is next.
+    // Either way turnCount turns are left.
+    union {
+        unsigned long long inlineTurns;
+        unsigned int routeId;
+    };
+    union {
+        unsigned long long* spilledTurns;
+        const RouteTable* routeTable;
+    };
+    unsigned int turnHead;
+    unsigned int turnCount;
+    // Kept next to the turn cursor, which an intersection updates in the same move
+#ifndef TRAFFIC_NO_TIMING
+    unsigned int lastMove;
+    unsigned int journeyStart;
+#endif
     unsigned int occupants;
-    std::queue<TurnDirection> turns;
+    unsigned char vehicleType;
+    unsigned char turnCapacityLog2;
+    bool followingRoute;
 };
 
 #endif /* end of include guard: VEHICLE_HPP */
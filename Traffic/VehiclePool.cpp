@@ -0,0 +1,84 @@
+#include "VehiclePool.hpp"
+
+#include <algorithm>
+#include <new>
+
+VehiclePool::VehiclePool() : slabs(0), slabCount(0), slabCapacity(0), freeHead(END_OF_FREE_LIST), liveCount(0) {
+}
+
+VehiclePool::~VehiclePool() {
+	clear();
+	for (unsigned int s = 0; s < slabCount; s++) {
+		delete[] slabs[s];
+	}
+	delete[] slabs;
+}
+
+VehicleId VehiclePool::create(Vehicle::Type newType, unsigned int occupantCount) {
+	if (freeHead == END_OF_FREE_LIST && !addSlab()) {
+		return 0;
+	}
+	Slot& slot = slabs[freeHead / SLAB_SIZE][freeHead % SLAB_SIZE];
+	freeHead = slot.nextFree;
+	slot.nextFree = SLOT_LIVE;
+	new (slot.storage) Vehicle(newType, occupantCount);
+	liveCount++;
+	return slot.id;
+}
+
+void VehiclePool::destroy(VehicleId id) {
+	Vehicle* vehicle = get(id);
+	if (vehicle == 0) {
+		return;
+	}
+	vehicle->~Vehicle();
+	unsigned int index = id & INDEX_MASK;
+	Slot& slot = slabs[index / SLAB_SIZE][index % SLAB_SIZE];
+	// Move to the next generation, skipping 0 so that no handle is ever 0
+	unsigned int generation = (id >> INDEX_BITS) + 1;
+	if (generation > 0xFF) {
+		generation = 1;
+	}
+	slot.id = (generation << INDEX_BITS) | index;
+	slot.nextFree = freeHead;
+	freeHead = index;
+	liveCount--;
+}
+
+void VehiclePool::clear() {
+	for (unsigned int s = 0; s < slabCount && liveCount != 0; s++) {
+		for (unsigned int i = 0; i < SLAB_SIZE; i++) {
+			if (slabs[s][i].nextFree == SLOT_LIVE) {
+				destroy(slabs[s][i].id);
+			}
+		}
+	}
+}
+
+unsigned long long VehiclePool::memoryUsage() const {
+	return (unsigned long long)slabCount * SLAB_SIZE * sizeof(Slot) + slabCapacity * sizeof(Slot*);
+}
+
+bool VehiclePool::addSlab() {
+	if ((slabCount + 1) * SLAB_SIZE > INDEX_MASK + 1) {
+		return false;
+	}
+	if (slabCount == slabCapacity) {
+		unsigned int newCapacity = slabCapacity != 0 ? slabCapacity * 2 : 8;
+		Slot** newSlabs = new Slot*[newCapacity];
+		std::copy(slabs, slabs + slabCount, newSlabs);
+		delete[] slabs;
+		slabs = newSlabs;
+		slabCapacity = newCapacity;
+	}
+	Slot* slab = new Slot[SLAB_SIZE];
+	unsigned int first = slabCount * SLAB_SIZE;
+	// Chain the new slots in order so vehicles are handed out from the start of the slab
+	for (unsigned int i = 0; i < SLAB_SIZE; i++) {
+		slab[i].id = (1u << INDEX_BITS) | (first + i);
+		slab[i].nextFree = i + 1 < SLAB_SIZE ? first + i + 1 : freeHead;
+	}
+	slabs[slabCount++] = slab;
+	freeHead = first;
+	return true;
+}
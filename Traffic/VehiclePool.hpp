@@ -0,0 +1,135 @@
+#ifndef VEHICLEPOOL_HPP
+#define VEHICLEPOOL_HPP
+
+#include "Vehicle.hpp"
+
+/*
+A compact handle to a Vehicle owned by a VehiclePool. The low 24 bits are the vehicle's slot in the pool and the high 8
+bits the slot's generation, which changes every time the slot is reused, so a handle to a destroyed vehicle can be told
+apart from a handle to whatever vehicle took its slot. 0 is never a valid handle.
+*/
+typedef unsigned int VehicleId;
+
+/*
+The VehiclePool class allocates vehicles from fixed-size slabs instead of one at a time with `new`. Destroyed vehicles
+return their slot to a free list, so a long run that keeps creating and destroying vehicles reuses the same memory
+instead of fragmenting the heap, and destroying the whole pool frees a handful of slabs.
+
+Vehicles are referred to by VehicleId, which is half the size of a pointer. get() turns a handle back into a pointer
+(or 0 for a stale handle) and idOf() finds the handle of a pooled vehicle from its pointer.
+
+Vehicles created by a pool must be destroyed with destroy() or by destroying the pool, never with `delete`. A pool holds
+up to 2^24 vehicles at once.
+*/
+class VehiclePool {
+public:
+	/*
+	Number of vehicles in each slab.
+	*/
+	static const unsigned int SLAB_SIZE = 1024;
+
+	/*
+	Create a new empty pool. No storage is allocated until the first vehicle is created.
+	*/
+	VehiclePool();
+
+	/*
+	Destroy the pool, destroying every vehicle still in it.
+	*/
+	~VehiclePool();
+
+	/*
+	Create a new vehicle in the pool, constructed as Vehicle(newType, occupantCount), and return its handle. If the pool
+	already holds its maximum number of vehicles this returns 0 instead.
+	*/
+	VehicleId create(Vehicle::Type newType, unsigned int occupantCount);
+
+	/*
+	Destroy the vehicle with handle `id`, returning its slot to the pool. A stale handle is ignored.
+	*/
+	void destroy(VehicleId id);
+
+	/*
+	Destroy every vehicle in the pool. The slabs are kept for reuse.
+	*/
+	void clear();
+
+	/*
+	Get the vehicle with handle `id`, or 0 if `id` does not refer to a vehicle currently in the pool.
+	*/
+	Vehicle* get(VehicleId id) const {
+		unsigned int index = id & INDEX_MASK;
+		if (index >= slabCount * SLAB_SIZE) {
+			return 0;
+		}
+		Slot& slot = slabs[index / SLAB_SIZE][index % SLAB_SIZE];
+		if (slot.id != id || slot.nextFree != SLOT_LIVE) {
+			return 0;
+		}
+		return reinterpret_cast<Vehicle*>(slot.storage);
+	}
+
+	/*
+	Get the vehicle with handle `id` without checking the handle; `id` must refer to a vehicle currently in the pool.
+	*/
+	Vehicle* at(VehicleId id) const {
+		unsigned int index = id & INDEX_MASK;
+		return reinterpret_cast<Vehicle*>(slabs[index / SLAB_SIZE][index % SLAB_SIZE].storage);
+	}
+
+	/*
+	Get the handle of `vehicle`, which must have been created by this pool and not yet destroyed. This takes O(1) time.
+	*/
+	VehicleId idOf(const Vehicle* vehicle) const {
+		// The vehicle is stored at the start of its slot, so the slot's handle sits just after it
+		return reinterpret_cast<const Slot*>(vehicle)->id;
+	}
+
+	/*
+	Get the number of vehicles currently in the pool.
+	*/
+	unsigned int count() const {
+		return liveCount;
+	}
+
+	/*
+	Get the number of bytes of heap storage used by the pool.
+	*/
+	unsigned long long memoryUsage() const;
+
+private:
+	/*
+	Private copy constructor and copy assignment operator - pools own their vehicles and cannot be copied.
+	*/
+	VehiclePool(const VehiclePool&);
+	VehiclePool& operator=(const VehiclePool&);
+
+	static const unsigned int INDEX_BITS = 24;
+	static const unsigned int INDEX_MASK = (1u << INDEX_BITS) - 1;
+	// nextFree values that are not slot indexes
+	static const unsigned int END_OF_FREE_LIST = 0xFFFFFFFFu;
+	static const unsigned int SLOT_LIVE = 0xFFFFFFFEu;
+
+	/*
+	Storage for one vehicle, followed by the handle of the slot's current (or next) vehicle and, for a free slot, the
+	index of the next free slot.
+	*/
+	struct Slot {
+		alignas(Vehicle) unsigned char storage[sizeof(Vehicle)];
+		VehicleId id;
+		unsigned int nextFree;
+	};
+
+	/*
+	Allocate a new slab and put its slots on the free list.
+	*/
+	bool addSlab();
+
+	Slot** slabs;
+	unsigned int slabCount;
+	unsigned int slabCapacity;
+	unsigned int freeHead;
+	unsigned int liveCount;
+};
+
+#endif /* end of include guard: VEHICLEPOOL_HPP */
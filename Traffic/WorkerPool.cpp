@@ -0,0 +1,123 @@
+#include "WorkerPool.hpp"
+
+WorkerPool::WorkerPool(unsigned int threadCount) : threadTotal(threadCount > 0 ? threadCount : 1), task(0),
+	context(0), generation(0), running(0), stopping(false) {
+	blocks = new Block[threadTotal];
+	for (unsigned int w = 0; w < threadTotal; w++) {
+		blocks[w].range.store(0, std::memory_order_relaxed);
+	}
+	threads = new std::thread[threadTotal - 1];
+	for (unsigned int w = 1; w < threadTotal; w++) {
+		threads[w - 1] = std::thread(&WorkerPool::threadMain, this, w);
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (unsigned int w = 1; w < threadTotal; w++) {
+		threads[w - 1].join();
+	}
+	delete[] threads;
+	delete[] blocks;
+}
+
+void WorkerPool::run(unsigned int chunks, Task newTask, void* newContext) {
+	if (threadTotal == 1 || chunks <= 1) {
+		for (unsigned int chunk = 0; chunk < chunks; chunk++) {
+			newTask(newContext, chunk);
+		}
+		return;
+	}
+
+	// Give each thread an equal block of consecutive chunks
+	for (unsigned int w = 0; w < threadTotal; w++) {
+		unsigned long long begin = (unsigned long long)chunks * w / threadTotal;
+		unsigned long long end = (unsigned long long)chunks * (w + 1) / threadTotal;
+		blocks[w].range.store(begin | end << 32, std::memory_order_relaxed);
+	}
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		task = newTask;
+		context = newContext;
+		running = threadTotal - 1;
+		generation++;
+	}
+	wake.notify_all();
+
+	work(0);
+
+	std::unique_lock<std::mutex> guard(lock);
+	while (running > 0) {
+		done.wait(guard);
+	}
+}
+
+bool WorkerPool::take(unsigned int owner, unsigned int& chunk) {
+	unsigned long long range = blocks[owner].range.load(std::memory_order_relaxed);
+	while ((unsigned int)range < (unsigned int)(range >> 32)) {
+		if (blocks[owner].range.compare_exchange_weak(range, range + 1, std::memory_order_relaxed)) {
+			chunk = (unsigned int)range;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool WorkerPool::steal(unsigned int victim, unsigned int& chunk) {
+	unsigned long long range = blocks[victim].range.load(std::memory_order_relaxed);
+	while ((unsigned int)range < (unsigned int)(range >> 32)) {
+		unsigned long long last = (range >> 32) - 1;
+		if (blocks[victim].range.compare_exchange_weak(range, (unsigned int)range | last << 32,
+			std::memory_order_relaxed)) {
+			chunk = (unsigned int)last;
+			return true;
+		}
+	}
+	return false;
+}
+
+void WorkerPool::work(unsigned int worker) {
+	unsigned int chunk;
+	while (take(worker, chunk)) {
+		task(context, chunk);
+	}
+	// Blocks only ever shrink, so once a pass over the other threads finds nothing to steal the run is fully handed out
+	bool stole = true;
+	while (stole) {
+		stole = false;
+		for (unsigned int k = 1; k < threadTotal; k++) {
+			unsigned int victim = (worker + k) % threadTotal;
+			while (steal(victim, chunk)) {
+				task(context, chunk);
+				stole = true;
+			}
+		}
+	}
+}
+
+void WorkerPool::threadMain(unsigned int worker) {
+	unsigned int seen = 0;
+	std::unique_lock<std::mutex> guard(lock);
+	while (true) {
+		while (generation == seen && !stopping) {
+			wake.wait(guard);
+		}
+		if (stopping) {
+			return;
+		}
+		seen = generation;
+		guard.unlock();
+
+		work(worker);
+
+		guard.lock();
+		running--;
+		if (running == 0) {
+			done.notify_one();
+		}
+	}
+}
@@ -0,0 +1,98 @@
+#ifndef WORKERPOOL_HPP
+#define WORKERPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/*
+The WorkerPool class runs a parallel loop over a fixed set of threads. run() splits the loop's chunks into one block per
+thread, and a thread that finishes its own block steals the remaining chunks of the others one at a time from the end of
+their blocks, so uneven chunks still keep every thread busy.
+
+The thread calling run() works as the pool's first thread, and the pool starts `threads - 1` more. Between calls they
+sleep on a condition variable. Everything a chunk writes is visible to the caller, and to every chunk of the next run(),
+once run() returns.
+*/
+class WorkerPool {
+public:
+	/*
+	A loop body: process chunk `chunk` of the loop, with `context` as passed to run().
+	*/
+	typedef void (*Task)(void* context, unsigned int chunk);
+
+	/*
+	Create a pool of `threads` threads, counting the one that calls run(). A pool of 0 or 1 threads runs every chunk on
+	the calling thread.
+	*/
+	explicit WorkerPool(unsigned int threads);
+
+	/*
+	Stop and join the pool's threads. No run() may be in progress.
+	*/
+	~WorkerPool();
+
+	/*
+	Get the number of threads, counting the one that calls run().
+	*/
+	unsigned int threadCount() const {
+		return threadTotal;
+	}
+
+	/*
+	Call `task(context, chunk)` once for every chunk from 0 to `chunks` - 1, spread across the pool, and return when
+	they have all finished. Chunks may run in any order and at the same time, so they must not write to the same data.
+	Only one thread may call run() at a time.
+	*/
+	void run(unsigned int chunks, Task task, void* context);
+
+private:
+	/*
+	Private copy constructor and copy assignment operator - pools cannot be copied.
+	*/
+	WorkerPool(const WorkerPool&);
+	WorkerPool& operator=(const WorkerPool&);
+
+	/*
+	The chunks still to run in one thread's block: the next one in the low 32 bits and one past the last in the high 32
+	bits, changed only with compare-and-swap. The owner takes chunks from the front and thieves from the back.
+	*/
+	struct alignas(64) Block {
+		std::atomic<unsigned long long> range;
+	};
+
+	/*
+	Take the next chunk of thread `owner`'s block from the front, or from the back when stealing, returning `false` if
+	the block is empty.
+	*/
+	bool take(unsigned int owner, unsigned int& chunk);
+	bool steal(unsigned int victim, unsigned int& chunk);
+
+	/*
+	Run thread `worker`'s block, then steal from the others until every block is empty.
+	*/
+	void work(unsigned int worker);
+
+	/*
+	The loop each of the pool's own threads runs until the pool is destroyed.
+	*/
+	void threadMain(unsigned int worker);
+
+	unsigned int threadTotal;
+	std::thread* threads;
+	Block* blocks;
+
+	// The current run, published to the threads by bumping `generation` under `lock`
+	Task task;
+	void* context;
+	std::mutex lock;
+	std::condition_variable wake;
+	std::condition_variable done;
+	unsigned int generation;
+	// Threads still working on the current run, not counting the caller
+	unsigned int running;
+	bool stopping;
+};
+
+#endif /* end of include guard: WORKERPOOL_HPP */
@@ -0,0 +1,737 @@
+#include <iostream>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <chrono>
+#include <thread>
+
+#include "Traffic/Vehicle.hpp"
+#include "Traffic/RouteTable.hpp"
+#include "Traffic/VehiclePool.hpp"
+#include "Traffic/PooledLane.hpp"
+#include "Traffic/FleetStore.hpp"
+#include "Traffic/Lane.hpp"
+#include "Traffic/SimpleLane.hpp"
+#include "Traffic/RingLane.hpp"
+#include "Traffic/ExpressLane.hpp"
+#include "Traffic/Intersection.hpp"
+#include "Traffic/Junction.hpp"
+#include "Traffic/RoadNetwork.hpp"
+#include "Traffic/WorkerPool.hpp"
+#include "Traffic/EventEngine.hpp"
+
+using namespace std;
+
+/*
+Every heap allocation made by the benchmarks goes through these replacements so allocation counts can be reported next
+to the timings. GCC cannot tell that the replacement operator delete is paired with the replacement operator new once
+both are inlined, so its mismatch warning is turned off for them.
+*/
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+static unsigned long long allocationCount = 0;
+static unsigned long long allocatedBytes = 0;
+
+void* operator new(size_t size) {
+    allocationCount++;
+    allocatedBytes += size;
+    void* p = malloc(size != 0 ? size : 1);
+    if (p == 0) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+/*
+Helper to read a monotonic clock in nanoseconds.
+*/
+static double nowNs() {
+    return chrono::duration<double, nano>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+Prevent the compiler from optimizing away a value computed by a benchmark.
+*/
+static volatile unsigned long long benchSink = 0;
+
+/*
+Enqueue/dequeue throughput of a lane type. The lane is primed with a short queue and then one million enqueue/dequeue
+pairs are made, moving the same vehicles around the queue the way an intersection does every tick.
+*/
+template <class LaneT>
+void benchLaneThroughput(const char* name) {
+    const unsigned int depth = 64;
+    const unsigned int pairs = 1000000;
+
+    LaneT lane;
+    for (unsigned int i = 0; i < depth; i++) {
+        lane.enqueue(new Vehicle(Vehicle::VT_CAR, 1));
+    }
+    // let the lane reach its working size before measuring
+    for (unsigned int i = 0; i < depth; i++) {
+        lane.enqueue(lane.dequeue());
+    }
+
+    Lane* polymorphic = &lane;
+    unsigned long long allocationsBefore = allocationCount;
+    double start = nowNs();
+    for (unsigned int i = 0; i < pairs; i++) {
+        polymorphic->enqueue(polymorphic->dequeue());
+    }
+    double elapsed = nowNs() - start;
+    unsigned long long allocations = allocationCount - allocationsBefore;
+    benchSink += lane.count();
+
+    cout << "  " << name << ": " << elapsed / pairs << " ns/pair, " << allocations << " allocations per "
+         << pairs << " pairs" << endl;
+}
+
+void bench_LaneThroughput() {
+    cout << "Lane enqueue/dequeue throughput" << endl;
+    benchLaneThroughput<SimpleLane>("SimpleLane");
+    benchLaneThroughput<RingLane>("RingLane  ");
+}
+
+/*
+Attach a lane to approach 0 (north), 1 (east), 2 (south) or 3 (west) of a four-way intersection or junction.
+*/
+template <class AcceptedLaneT, class Rules, class LaneT>
+void connectApproach(BasicIntersection<AcceptedLaneT, Rules>& intersection, unsigned int approach, LaneT* lane,
+                     IntersectionBase::LaneDirection direction) {
+    if (approach == 0) {
+        intersection.connectNorth(lane, direction);
+    }
+    else if (approach == 1) {
+        intersection.connectEast(lane, direction);
+    }
+    else if (approach == 2) {
+        intersection.connectSouth(lane, direction);
+    }
+    else {
+        intersection.connectWest(lane, direction);
+    }
+}
+
+template <class AcceptedLaneT, class LaneT>
+void connectApproach(Junction<4, AcceptedLaneT>& junction, unsigned int approach, LaneT* lane,
+                     IntersectionBase::LaneDirection direction) {
+    junction.connect(approach, lane, direction);
+}
+
+/*
+A square torus of intersections used by the network benchmarks. Each intersection has an incoming lane from the west
+and from the north, and outgoing lanes to the east and south, so every intersection takes two incoming queues through
+the give way rules each tick. Vehicles travel straight along their row or column for the whole run.
+*/
+template <class IntersectionT, class LaneT>
+struct TorusNetwork {
+    unsigned int size;
+    IntersectionT* intersections;
+    LaneT* lanes;
+
+    TorusNetwork(unsigned int gridSize, unsigned int vehiclesPerLane, unsigned int routeLength) : size(gridSize) {
+        intersections = new IntersectionT[size * size];
+        // lane 2*i is the eastbound lane leaving intersection i, lane 2*i+1 the southbound lane leaving it
+        lanes = new LaneT[2 * size * size];
+        for (unsigned int y = 0; y < size; y++) {
+            for (unsigned int x = 0; x < size; x++) {
+                unsigned int i = y * size + x;
+                unsigned int west = y * size + (x + size - 1) % size;
+                unsigned int north = ((y + size - 1) % size) * size + x;
+                connectApproach(intersections[i], 0, &lanes[2 * north + 1], IntersectionBase::LD_INCOMING);
+                connectApproach(intersections[i], 1, &lanes[2 * i], IntersectionBase::LD_OUTGOING);
+                connectApproach(intersections[i], 2, &lanes[2 * i + 1], IntersectionBase::LD_OUTGOING);
+                connectApproach(intersections[i], 3, &lanes[2 * west], IntersectionBase::LD_INCOMING);
+            }
+        }
+        for (unsigned int l = 0; l < 2 * size * size; l++) {
+            for (unsigned int v = 0; v < vehiclesPerLane; v++) {
+                Vehicle* vehicle = new Vehicle(v % 4 == 0 ? Vehicle::VT_MOTORCYCLE : Vehicle::VT_CAR, 1);
+                for (unsigned int t = 0; t < routeLength; t++) {
+                    vehicle->turnStraight();
+                }
+                lanes[l].enqueue(vehicle);
+            }
+        }
+    }
+
+    ~TorusNetwork() {
+        delete[] intersections;
+        delete[] lanes;
+    }
+
+    void step() {
+        for (unsigned int i = 0; i < size * size; i++) {
+            intersections[i].simulate();
+        }
+        SimClock::tick();
+    }
+
+    // One coarse tick in which up to `maxPerApproach` vehicles leave each incoming lane
+    void step(unsigned int maxPerApproach) {
+        for (unsigned int i = 0; i < size * size; i++) {
+            intersections[i].simulate(maxPerApproach);
+        }
+        SimClock::tick();
+    }
+};
+
+/*
+Run `ticks` ticks over a torus network and report the number of whole-network ticks per second.
+*/
+template <class IntersectionT, class LaneT>
+void benchNetworkTicks(const char* name, unsigned int gridSize, unsigned int ticks) {
+    TorusNetwork<IntersectionT, LaneT> network(gridSize, 4, ticks);
+    double start = nowNs();
+    for (unsigned int t = 0; t < ticks; t++) {
+        network.step();
+    }
+    double elapsed = nowNs() - start;
+    benchSink += network.lanes[0].count();
+    cout << "  " << name << ": " << ticks / (elapsed * 1e-9) << " ticks/s (" << gridSize * gridSize
+         << " intersections, " << elapsed / ((double)ticks * gridSize * gridSize) << " ns/intersection)" << endl;
+}
+
+/*
+Wire `network` as the torus of TorusNetwork, with the same lane numbering, and fill every `spacing`th lane with vehicles
+going straight on for `ticks` ticks.
+*/
+template <class LaneT>
+void buildRoadNetworkTorus(BasicRoadNetwork<LaneT>& network, unsigned int gridSize, unsigned int ticks,
+                           unsigned int spacing = 1) {
+    for (unsigned int y = 0; y < gridSize; y++) {
+        for (unsigned int x = 0; x < gridSize; x++) {
+            unsigned int i = y * gridSize + x;
+            unsigned int west = y * gridSize + (x + gridSize - 1) % gridSize;
+            unsigned int north = ((y + gridSize - 1) % gridSize) * gridSize + x;
+            network.connect(i, 0, 2 * north + 1, IntersectionBase::LD_INCOMING);
+            network.connect(i, 1, 2 * i, IntersectionBase::LD_OUTGOING);
+            network.connect(i, 2, 2 * i + 1, IntersectionBase::LD_OUTGOING);
+            network.connect(i, 3, 2 * west, IntersectionBase::LD_INCOMING);
+        }
+    }
+    for (unsigned int l = 0; l < network.laneCount(); l += spacing) {
+        for (unsigned int v = 0; v < 4; v++) {
+            Vehicle* vehicle = new Vehicle(v % 4 == 0 ? Vehicle::VT_MOTORCYCLE : Vehicle::VT_CAR, 1);
+            for (unsigned int t = 0; t < ticks; t++) {
+                vehicle->turnStraight();
+            }
+            network.lane(l).enqueue(vehicle);
+        }
+    }
+}
+
+/*
+The torus of TorusNetwork built as a BasicRoadNetwork, stepped in `mode`.
+*/
+template <class LaneT>
+void benchRoadNetworkTicks(const char* name, unsigned int gridSize, unsigned int ticks,
+                           RoadNetworkBase::StepMode mode = RoadNetworkBase::SM_SEQUENTIAL) {
+    BasicRoadNetwork<LaneT> network(gridSize * gridSize, 2 * gridSize * gridSize);
+    network.setStepMode(mode);
+    buildRoadNetworkTorus(network, gridSize, ticks);
+    double start = nowNs();
+    for (unsigned int t = 0; t < ticks; t++) {
+        network.step();
+    }
+    double elapsed = nowNs() - start;
+    benchSink += network.lane(0).count();
+    cout << "  " << name << ": " << ticks / (elapsed * 1e-9) << " ticks/s (" << gridSize * gridSize
+         << " intersections, " << elapsed / ((double)ticks * gridSize * gridSize) << " ns/intersection)" << endl;
+}
+
+void bench_IntersectionDispatch() {
+    cout << "Intersection dispatch, 64x64 torus" << endl;
+    benchNetworkTicks<Intersection, ExpressLane>("Intersection over ExpressLane         ", 64, 1000);
+    benchNetworkTicks<BasicIntersection<ExpressLane>, ExpressLane>("BasicIntersection<ExpressLane>        ", 64, 1000);
+    benchNetworkTicks<Intersection, RingLane>("Intersection over RingLane            ", 64, 1000);
+    benchNetworkTicks<BasicIntersection<RingLane>, RingLane>("BasicIntersection<RingLane>           ", 64, 1000);
+    benchNetworkTicks<Junction<4, RingLane>, RingLane>("Junction<4, RingLane>                 ", 64, 1000);
+    benchRoadNetworkTicks<RingLane>("BasicRoadNetwork<RingLane>            ", 64, 1000);
+    benchRoadNetworkTicks<RingLane>("BasicRoadNetwork<RingLane> synchronous", 64, 1000, RoadNetworkBase::SM_SYNCHRONOUS);
+}
+
+/*
+Saturation flow over a torus with long queues: the same number of intersection iterations run as single ticks and as
+coarse ticks of `k` iterations each.
+*/
+template <class IntersectionT, class LaneT>
+void benchSaturationFlow(const char* name, unsigned int gridSize, unsigned int iterations, unsigned int k) {
+    TorusNetwork<IntersectionT, LaneT> network(gridSize, 32, iterations);
+    double start = nowNs();
+    if (k == 1) {
+        for (unsigned int t = 0; t < iterations; t++) {
+            network.step();
+        }
+    }
+    else {
+        for (unsigned int t = 0; t < iterations / k; t++) {
+            network.step(k);
+        }
+    }
+    double elapsed = nowNs() - start;
+    benchSink += network.lanes[0].count();
+    cout << "  " << name << " k=" << k << (k < 10 ? " " : "") << ": " << elapsed * 1e-6 << " ms ("
+         << elapsed / ((double)iterations * gridSize * gridSize) << " ns/intersection iteration)" << endl;
+}
+
+void bench_SaturationFlow() {
+    cout << "Saturation flow, 64x64 torus, 32 vehicles per lane, 256 iterations" << endl;
+    benchSaturationFlow<BasicIntersection<ExpressLane>, ExpressLane>("BasicIntersection<ExpressLane>", 64, 256, 1);
+    benchSaturationFlow<BasicIntersection<ExpressLane>, ExpressLane>("BasicIntersection<ExpressLane>", 64, 256, 16);
+    benchSaturationFlow<BasicIntersection<RingLane>, RingLane>("BasicIntersection<RingLane>   ", 64, 256, 1);
+    benchSaturationFlow<BasicIntersection<RingLane>, RingLane>("BasicIntersection<RingLane>   ", 64, 256, 16);
+}
+
+/*
+Strong scaling of step(WorkerPool&): the same torus stepped on 1, 2, 4, ... threads, up to at least 4 and the number of
+hardware threads, against a serial synchronous step().
+*/
+template <class LaneT>
+void benchParallelStep(unsigned int gridSize, unsigned int ticks, unsigned int maxThreads) {
+    cout << "  " << gridSize << "x" << gridSize << " torus (" << gridSize * gridSize << " intersections)" << endl;
+    double serialRate = 0;
+    {
+        BasicRoadNetwork<LaneT> network(gridSize * gridSize, 2 * gridSize * gridSize);
+        network.setStepMode(RoadNetworkBase::SM_SYNCHRONOUS);
+        buildRoadNetworkTorus(network, gridSize, ticks);
+        double start = nowNs();
+        for (unsigned int t = 0; t < ticks; t++) {
+            network.step();
+        }
+        serialRate = ticks / ((nowNs() - start) * 1e-9);
+        benchSink += network.lane(0).count();
+        cout << "    serial step()  : " << serialRate << " ticks/s" << endl;
+    }
+    for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+        BasicRoadNetwork<LaneT> network(gridSize * gridSize, 2 * gridSize * gridSize);
+        buildRoadNetworkTorus(network, gridSize, ticks);
+        WorkerPool pool(threads);
+        double start = nowNs();
+        for (unsigned int t = 0; t < ticks; t++) {
+            network.step(pool);
+        }
+        double rate = ticks / ((nowNs() - start) * 1e-9);
+        benchSink += network.lane(0).count();
+        cout << "    " << threads << (threads < 10 ? " " : "") << " threads     : " << rate << " ticks/s ("
+             << rate / serialRate << "x serial)" << endl;
+    }
+}
+
+void bench_ParallelStep() {
+    unsigned int hardware = thread::hardware_concurrency();
+    unsigned int maxThreads = hardware > 4 ? hardware : 4;
+    cout << "Parallel step strong scaling, " << hardware << " hardware thread(s)" << endl;
+    benchParallelStep<RingLane>(128, 200, maxThreads);
+    benchParallelStep<RingLane>(224, 100, maxThreads);
+}
+
+/*
+Time `ticks` steps of `network` and report them with the lanes cut by an 8-way split of its numbering.
+*/
+template <class LaneT>
+void benchNetworkOrder(const char* name, BasicRoadNetwork<LaneT>& network, unsigned int ticks) {
+    double start = nowNs();
+    for (unsigned int t = 0; t < ticks; t++) {
+        network.step();
+    }
+    double elapsed = nowNs() - start;
+    benchSink += network.lane(0).count();
+    cout << "  " << name << ": " << ticks / (elapsed * 1e-9) << " ticks/s ("
+         << elapsed / ((double)ticks * network.intersectionCount()) << " ns/intersection), edge cut "
+         << network.edgeCut(8) << " of " << network.laneCount() << " lanes" << endl;
+}
+
+/*
+A torus numbered in random order, as a caller building a city from unsorted data might number it, then renumbered in
+Reverse Cuthill-McKee order with reorder(), against its natural row-by-row numbering.
+*/
+template <class LaneT>
+void benchNetworkOrdering(unsigned int gridSize, unsigned int ticks, RoadNetworkBase::StepMode mode) {
+    unsigned int n = gridSize * gridSize;
+    BasicRoadNetwork<LaneT> network(n, 2 * n);
+    network.setStepMode(mode);
+    buildRoadNetworkTorus(network, gridSize, 3 * ticks);
+    benchNetworkOrder("row by row   ", network, ticks);
+
+    vector<unsigned int> shuffled(n);
+    for (unsigned int i = 0; i < n; i++) {
+        shuffled[i] = i;
+    }
+    unsigned int seed = 2024;
+    for (unsigned int i = n - 1; i > 0; i--) {
+        seed = seed * 1103515245 + 12345;
+        unsigned int j = (seed >> 8) % (i + 1);
+        swap(shuffled[i], shuffled[j]);
+    }
+    network.relabel(&shuffled[0]);
+    benchNetworkOrder("shuffled     ", network, ticks);
+
+    double start = nowNs();
+    network.reorder();
+    double reorderMs = (nowNs() - start) * 1e-6;
+    benchNetworkOrder("RCM reordered", network, ticks);
+    cout << "  reorder() took " << reorderMs << " ms" << endl;
+}
+
+void bench_NetworkOrdering() {
+    cout << "Network ordering, 224x224 torus (50176 intersections), BasicRoadNetwork<RingLane>" << endl;
+    cout << " sequential step" << endl;
+    benchNetworkOrdering<RingLane>(224, 100, RoadNetworkBase::SM_SEQUENTIAL);
+    cout << " synchronous step" << endl;
+    benchNetworkOrdering<RingLane>(224, 100, RoadNetworkBase::SM_SYNCHRONOUS);
+}
+
+/*
+Off-peak traffic: vehicles in one lane in `spacing`, stepped by simulating every intersection and by step(), which only
+simulates those that are awake.
+*/
+template <class LaneT>
+void benchActiveSet(unsigned int gridSize, unsigned int ticks, unsigned int spacing, RoadNetworkBase::StepMode mode) {
+    unsigned int n = gridSize * gridSize;
+    double rates[2];
+    unsigned int awake = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        BasicRoadNetwork<LaneT> network(n, 2 * n);
+        network.setStepMode(mode);
+        buildRoadNetworkTorus(network, gridSize, ticks, spacing);
+        double start = nowNs();
+        for (unsigned int t = 0; t < ticks; t++) {
+            if (pass == 1) {
+                network.step();
+            }
+            else if (mode == RoadNetworkBase::SM_SEQUENTIAL) {
+                for (unsigned int i = 0; i < n; i++) {
+                    network.intersection(i).simulate();
+                }
+                SimClock::tick();
+            }
+            else {
+                network.prepareLanes(0, 2 * n);
+                network.stageIntersections(0, n);
+                network.commitLanes(0, 2 * n);
+                SimClock::tick();
+            }
+        }
+        rates[pass] = ticks / ((nowNs() - start) * 1e-9);
+        benchSink += network.lane(0).count();
+        for (unsigned int i = 0; pass == 1 && i < n; i++) {
+            awake += network.active(i) ? 1 : 0;
+        }
+    }
+    cout << "  1 lane in " << spacing << (spacing < 10 ? "  " : " ") << (mode == RoadNetworkBase::SM_SEQUENTIAL ?
+            "sequential " : "synchronous") << ": every intersection " << rates[0] << " ticks/s, awake only "
+         << rates[1] << " ticks/s (" << rates[1] / rates[0] << "x, " << 100.0 * awake / n << "% awake)" << endl;
+}
+
+void bench_ActiveSet() {
+    cout << "Active set, 224x224 torus (50176 intersections), BasicRoadNetwork<RingLane>" << endl;
+    const unsigned int spacings[4] = { 1, 4, 20, 100 };
+    for (int k = 0; k < 4; k++) {
+        benchActiveSet<RingLane>(224, 100, spacings[k], RoadNetworkBase::SM_SEQUENTIAL);
+        benchActiveSet<RingLane>(224, 100, spacings[k], RoadNetworkBase::SM_SYNCHRONOUS);
+    }
+}
+
+/*
+The torus of buildRoadNetworkTorus() with one lane in `spacing` holding vehicles, run for `ticks` ticks by a
+BasicEventEngine with every lane taking `travel` ticks to travel along. With no travel time the same network is also
+stepped synchronously, which gives the same traffic.
+*/
+template <class LaneT>
+void benchEventEngine(unsigned int gridSize, unsigned int ticks, unsigned int spacing, unsigned int travel) {
+    unsigned int n = gridSize * gridSize;
+    double stepElapsed = 0;
+    if (travel == 0) {
+        BasicRoadNetwork<LaneT> network(n, 2 * n);
+        network.setStepMode(RoadNetworkBase::SM_SYNCHRONOUS);
+        buildRoadNetworkTorus(network, gridSize, ticks, spacing);
+        double start = nowNs();
+        for (unsigned int t = 0; t < ticks; t++) {
+            network.step();
+        }
+        stepElapsed = nowNs() - start;
+        benchSink += network.lane(0).count();
+    }
+
+    BasicRoadNetwork<LaneT> network(n, 2 * n);
+    buildRoadNetworkTorus(network, gridSize, ticks, spacing);
+    BasicEventEngine<LaneT> engine(network, 64);
+    for (unsigned int l = 0; l < 2 * n; l++) {
+        engine.setTravelTime(l, travel);
+    }
+    double start = nowNs();
+    engine.run(SimClock::now() + ticks);
+    double elapsed = nowNs() - start;
+    benchSink += network.lane(0).count();
+
+    // Both move the same vehicles, so their times per movement compare directly
+    cout << "  1 lane in " << spacing << (spacing < 10 ? "   " : spacing < 100 ? "  " : " ") << "travel " << travel
+         << (travel < 10 ? " : " : ": ") << "events " << ticks / (elapsed * 1e-9) << " ticks/s, "
+         << elapsed / engine.movements() << " ns/movement";
+    if (travel == 0) {
+        cout << " (step() " << ticks / (stepElapsed * 1e-9) << " ticks/s, " << stepElapsed / engine.movements()
+             << " ns/movement)";
+    }
+    cout << ", " << engine.movements() << " movements" << endl;
+}
+
+void bench_EventEngine() {
+    cout << "Event engine, 224x224 torus (50176 intersections), BasicEventEngine<RingLane>" << endl;
+    const unsigned int spacings[3] = { 1, 20, 100 };
+    for (int k = 0; k < 3; k++) {
+        benchEventEngine<RingLane>(224, 100, spacings[k], 0);
+    }
+    for (int k = 0; k < 3; k++) {
+        benchEventEngine<RingLane>(224, 1000, spacings[k], 30);
+    }
+}
+
+/*
+Heap memory used per vehicle, for vehicles built with `routeLength` turns, and the time taken to read the turns back
+with nextTurn()/makeTurn() the way an intersection does. With `routes` non-zero the vehicles follow one of that many
+routes interned in a RouteTable instead of storing their own turns; the table's memory is shared out between them.
+*/
+void benchVehicleMemory(unsigned int routeLength, unsigned int routes) {
+    const unsigned int fleet = 100000;
+    vector<Vehicle*> vehicles(fleet);
+
+    unsigned long long allocationsBefore = allocationCount;
+    unsigned long long bytesBefore = allocatedBytes;
+    double start = nowNs();
+    RouteTable table;
+    Vehicle::TurnDirection route[128];
+    unsigned int* routeIds = new unsigned int[routes + 1];
+    for (unsigned int r = 0; r < routes; r++) {
+        for (unsigned int t = 0; t < routeLength; t++) {
+            route[t] = (Vehicle::TurnDirection)((r + t * (r % 7 + 1)) % 3);
+        }
+        routeIds[r] = table.intern(route, routeLength);
+    }
+    for (unsigned int v = 0; v < fleet; v++) {
+        Vehicle* vehicle = new Vehicle(Vehicle::VT_CAR, 1);
+        if (routes != 0) {
+            vehicle->followRoute(table, routeIds[v % routes]);
+        }
+        else {
+            for (unsigned int t = 0; t < routeLength; t++) {
+                route[t] = (Vehicle::TurnDirection)((v + t * (v % 7 + 1)) % 3);
+            }
+            for (unsigned int t = 0; t < routeLength; t++) {
+                switch (route[t]) {
+                    case Vehicle::TD_LEFT: vehicle->turnLeft(); break;
+                    case Vehicle::TD_STRAIGHT: vehicle->turnStraight(); break;
+                    default: vehicle->turnRight(); break;
+                }
+            }
+        }
+        vehicles[v] = vehicle;
+    }
+    double build = nowNs() - start;
+    // the list of route ids is not part of any vehicle
+    double bytes = (double)(allocatedBytes - bytesBefore - (routes + 1) * sizeof(unsigned int)) / fleet;
+    double allocations = (double)(allocationCount - allocationsBefore - 1) / fleet;
+    delete[] routeIds;
+
+    start = nowNs();
+    unsigned long long turns = 0;
+    for (unsigned int v = 0; v < fleet; v++) {
+        while (vehicles[v]->nextTurn() != Vehicle::TD_INVALID) {
+            turns += vehicles[v]->makeTurn();
+        }
+    }
+    double elapsed = nowNs() - start;
+    benchSink += turns;
+    for (unsigned int v = 0; v < fleet; v++) {
+        delete vehicles[v];
+    }
+
+    cout << "  " << routeLength << " turns, ";
+    if (routes != 0) {
+        cout << routes << " shared routes: ";
+    }
+    else {
+        cout << "own turns: ";
+    }
+    cout << bytes << " bytes/vehicle, " << allocations << " allocations/vehicle, " << build / fleet
+         << " ns/vehicle to build, " << (routeLength != 0 ? elapsed / ((double)fleet * routeLength) : 0.0)
+         << " ns/turn" << endl;
+}
+
+void bench_VehicleMemory() {
+    cout << "Vehicle memory (sizeof(Vehicle) = " << sizeof(Vehicle) << ")" << endl;
+    benchVehicleMemory(0, 0);
+    benchVehicleMemory(4, 0);
+    benchVehicleMemory(32, 0);
+    benchVehicleMemory(100, 0);
+    benchVehicleMemory(100, 1000);
+}
+
+/*
+Vehicle churn as in a long run: a fleet is created, then vehicles are repeatedly destroyed and replaced, then the whole
+fleet is destroyed. Compares `new`/`delete` with a VehiclePool, and the memory a queue of the fleet takes in a RingLane
+and in a PooledLane.
+*/
+void bench_VehiclePool() {
+    const unsigned int fleet = 1000000;
+    const unsigned int churn = 4000000;
+    cout << "Vehicle pool, " << fleet << " vehicles" << endl;
+
+    {
+        vector<Vehicle*> vehicles(fleet);
+        unsigned long long allocationsBefore = allocationCount;
+        double start = nowNs();
+        for (unsigned int v = 0; v < fleet; v++) {
+            vehicles[v] = new Vehicle(Vehicle::VT_CAR, 1);
+        }
+        for (unsigned int c = 0; c < churn; c++) {
+            unsigned int v = (c * 2654435761u) % fleet;
+            delete vehicles[v];
+            vehicles[v] = new Vehicle(Vehicle::VT_BUS, 2);
+        }
+        double churned = nowNs();
+        for (unsigned int v = 0; v < fleet; v++) {
+            delete vehicles[v];
+        }
+        double end = nowNs();
+        cout << "  new/delete : " << (churned - start) / (fleet + churn) << " ns/create, "
+             << (end - churned) * 1e-6 << " ms to destroy all, " << allocationCount - allocationsBefore
+             << " allocations" << endl;
+    }
+
+    {
+        vector<VehicleId> vehicles(fleet);
+        unsigned long long allocationsBefore = allocationCount;
+        double start = nowNs();
+        VehiclePool* pool = new VehiclePool();
+        for (unsigned int v = 0; v < fleet; v++) {
+            vehicles[v] = pool->create(Vehicle::VT_CAR, 1);
+        }
+        for (unsigned int c = 0; c < churn; c++) {
+            unsigned int v = (c * 2654435761u) % fleet;
+            pool->destroy(vehicles[v]);
+            vehicles[v] = pool->create(Vehicle::VT_BUS, 2);
+        }
+        double churned = nowNs();
+        benchSink += pool->memoryUsage();
+        delete pool;
+        double end = nowNs();
+        cout << "  VehiclePool: " << (churned - start) / (fleet + churn) << " ns/create, "
+             << (end - churned) * 1e-6 << " ms to destroy all, " << allocationCount - allocationsBefore
+             << " allocations" << endl;
+    }
+
+    {
+        VehiclePool pool;
+        unsigned long long bytesBefore = allocatedBytes;
+        RingLane ringLane(fleet);
+        unsigned long long ringBytes = allocatedBytes - bytesBefore;
+        bytesBefore = allocatedBytes;
+        PooledLane pooledLane(pool);
+        pooledLane.setCapacity(fleet);
+        unsigned long long pooledBytes = allocatedBytes - bytesBefore;
+        cout << "  queue storage for the fleet: RingLane " << ringBytes / 1024 << " KiB, PooledLane "
+             << pooledBytes / 1024 << " KiB" << endl;
+    }
+}
+
+/*
+Fleet-wide queries (bus occupants, vehicles with turns left, a histogram of turns left) over a fleet of vehicles,
+answered by chasing a pointer to every Vehicle and by scanning a FleetStore at each SIMD level the CPU supports.
+*/
+void bench_FleetStore() {
+    const unsigned int fleet = 4000000;
+    cout << "Fleet queries, " << fleet << " vehicles" << endl;
+    vector<Vehicle*> vehicles(fleet);
+    FleetStore store;
+    for (unsigned int v = 0; v < fleet; v++) {
+        vehicles[v] = new Vehicle((Vehicle::Type)(v % 3), v % 50);
+        for (unsigned int t = 0; t < v % 7; t++) {
+            vehicles[v]->turnStraight();
+        }
+    }
+    // shuffle the pointers so they are not visited in allocation order, as in a fleet spread over many lanes
+    for (unsigned int v = fleet - 1; v > 0; v--) {
+        swap(vehicles[v], vehicles[(v * 2654435761u) % (v + 1)]);
+    }
+    for (unsigned int v = 0; v < fleet; v++) {
+        store.add(*vehicles[v], 0, 0);
+    }
+
+    double start = nowNs();
+    unsigned long long busOccupants = 0;
+    unsigned int withTurns = 0;
+    unsigned int histogram[8] = { 0 };
+    for (unsigned int v = 0; v < fleet; v++) {
+        const Vehicle* vehicle = vehicles[v];
+        busOccupants += vehicle->type() == Vehicle::VT_BUS ? vehicle->occupantCount() : 0;
+        withTurns += vehicle->turnsLeft() != 0;
+        histogram[min(vehicle->turnsLeft(), 7u)]++;
+    }
+    double elapsed = nowNs() - start;
+    benchSink += busOccupants + withTurns + histogram[7];
+    cout << "  Vehicle pointers  : " << elapsed * 1e-6 << " ms" << endl;
+
+    const char* names[3] = { "FleetStore scalar", "FleetStore SSE2  ", "FleetStore AVX2  " };
+    for (int level = FleetStore::SL_SCALAR; level <= FleetStore::supportedSimdLevel(); level++) {
+        store.setSimdLevel((FleetStore::SimdLevel)level);
+        start = nowNs();
+        unsigned long long storeOccupants = store.occupantsOf(Vehicle::VT_BUS);
+        unsigned int storeWithTurns = store.countWithTurnsLeft();
+        unsigned int storeHistogram[8];
+        store.turnsLeftHistogram(storeHistogram, 8);
+        elapsed = nowNs() - start;
+        benchSink += storeOccupants + storeWithTurns + storeHistogram[7];
+        cout << "  " << names[level] << " : " << elapsed * 1e-6 << " ms"
+             << (storeOccupants == busOccupants && storeWithTurns == withTurns ? "" : " (MISMATCH)") << endl;
+    }
+
+    for (unsigned int v = 0; v < fleet; v++) {
+        delete vehicles[v];
+    }
+}
+
+/*
+This function collects up all the benchmarks as a vector of function pointers. Add new benchmarks to the vector here.
+*/
+vector<void (*)()> generateBenchmarks() {
+    vector<void (*)()> benchmarks;
+    benchmarks.push_back(&bench_LaneThroughput);
+    benchmarks.push_back(&bench_IntersectionDispatch);
+    benchmarks.push_back(&bench_VehicleMemory);
+    benchmarks.push_back(&bench_VehiclePool);
+    benchmarks.push_back(&bench_FleetStore);
+    benchmarks.push_back(&bench_SaturationFlow);
+    benchmarks.push_back(&bench_ParallelStep);
+    benchmarks.push_back(&bench_NetworkOrdering);
+    benchmarks.push_back(&bench_ActiveSet);
+    benchmarks.push_back(&bench_EventEngine);
+    return benchmarks;
+}
+
+int main(int argc, char const* argv[]) {
+    // If one or more benchmark numbers are passed as command-line parameters, run only those
+    vector<void (*)()> benchmarks = generateBenchmarks();
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            unsigned int bench_num = atoi(argv[i]);
+            if (bench_num >= benchmarks.size()) {
+                cout << "ERROR: unknown benchmark " << bench_num << endl;
+                continue;
+            }
+            benchmarks[bench_num]();
+        }
+    } else {
+        for (unsigned int b = 0; b < benchmarks.size(); ++b) {
+            benchmarks[b]();
+        }
+    }
+    return 0;
+}
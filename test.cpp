@@ -2,6 +2,7 @@
 #include <cctype>
 #include <cstdlib>
 #include <vector>
+#include <thread>
 
 // flags to enable tests for the later parts of the assignment
 #define ENABLE_VEHICLE_TESTS
@@ -10,16 +11,31 @@
 
 // include headers for classes being tested
 #include "Traffic/Vehicle.hpp"
+#include "Traffic/RouteTable.hpp"
+#include "Traffic/VehiclePool.hpp"
 #ifdef ENABLE_T1_TESTS
 #include "Traffic/Lane.hpp"
 #include "Traffic/SimpleLane.hpp"
 #include "Traffic/ExpressLane.hpp"
+#include "Traffic/RingLane.hpp"
+#include "Traffic/PriorityLane.hpp"
+#include "Traffic/SpscLane.hpp"
+#include "Traffic/MpscLane.hpp"
+#include "Traffic/PooledLane.hpp"
+#include "Traffic/FleetStore.hpp"
+#include "Traffic/LatencyHistogram.hpp"
 #endif /*ENABLE_T1_TESTS*/
 #ifdef ENABLE_T2_TESTS
 #include "Traffic/Lane.hpp"
 #include "Traffic/SimpleLane.hpp"
 #include "Traffic/ExpressLane.hpp"
 #include "Traffic/Intersection.hpp"
+#include "Traffic/GiveWay.hpp"
+#include "Traffic/Junction.hpp"
+#include "Traffic/RoadNetwork.hpp"
+#include "Traffic/WorkerPool.hpp"
+#include "Traffic/CalendarQueue.hpp"
+#include "Traffic/EventEngine.hpp"
 #endif /*ENABLE_T2_TESTS*/
 
 using namespace std;
@@ -115,6 +131,159 @@ TestResult test_VehicleTurning() {
 
     return TR_PASS;
 }
+
+/*
+Test routes longer than the turns a Vehicle stores inline, with turns made while more are still being added.
+*/
+TestResult test_VehicleLongRoute() {
+    Vehicle c(Vehicle::VT_BUS, 30);
+    Vehicle::TurnDirection expected[300];
+    unsigned int added = 0;
+    unsigned int made = 0;
+    // add three turns for every one made, so the queue wraps around and grows several times
+    while (added < 300) {
+        for (int i = 0; i < 3 && added < 300; i++) {
+            expected[added] = (Vehicle::TurnDirection)((added * 7 / 3) % 3);
+            if (expected[added] == Vehicle::TD_LEFT) {
+                c.turnLeft();
+            }
+            else if (expected[added] == Vehicle::TD_RIGHT) {
+                c.turnRight();
+            }
+            else {
+                c.turnStraight();
+            }
+            added++;
+        }
+        ASSERT(c.makeTurn() == expected[made++]);
+    }
+    while (made < 300) {
+        ASSERT(c.nextTurn() == expected[made]);
+        ASSERT(c.makeTurn() == expected[made++]);
+    }
+    ASSERT(c.nextTurn() == Vehicle::TD_INVALID);
+    ASSERT(c.makeTurn() == Vehicle::TD_INVALID);
+    ASSERT(c.type() == Vehicle::VT_BUS);
+    ASSERT(c.occupantCount() == 30);
+
+    return TR_PASS;
+}
+
+/*
+Test interning routes in a RouteTable and vehicles following them.
+*/
+TestResult test_RouteTable() {
+    RouteTable table;
+    Vehicle::TurnDirection longRoute[70];
+    for (int i = 0; i < 70; i++) {
+        longRoute[i] = (Vehicle::TurnDirection)(i % 3);
+    }
+    Vehicle::TurnDirection shortRoute[3] = { Vehicle::TD_RIGHT, Vehicle::TD_LEFT, Vehicle::TD_STRAIGHT };
+
+    ASSERT(table.count() == 0);
+    ASSERT(table.intern(longRoute, 70) == 0);
+    ASSERT(table.intern(shortRoute, 3) == 1);
+    ASSERT(table.intern(longRoute, 3) == 2);
+    ASSERT(table.intern(shortRoute, 0) == 3);
+    // interning the same sequences again finds the existing routes
+    ASSERT(table.intern(longRoute, 70) == 0);
+    ASSERT(table.intern(shortRoute, 3) == 1);
+    ASSERT(table.intern(longRoute, 3) == 2);
+    ASSERT(table.count() == 4);
+    ASSERT(table.length(0) == 70 && table.length(3) == 0);
+    for (int i = 0; i < 70; i++) {
+        ASSERT(table.turn(0, i) == longRoute[i]);
+    }
+
+    // many routes force the arena and index to grow without disturbing earlier routes
+    for (unsigned int r = 0; r < 1000; r++) {
+        Vehicle::TurnDirection route[10];
+        for (unsigned int i = 0; i < 10; i++) {
+            route[i] = (Vehicle::TurnDirection)((r >> (i % 5)) % 3);
+        }
+        unsigned int id = table.intern(route, 10);
+        ASSERT(table.intern(route, 10) == id);
+        ASSERT(table.turn(id, 9) == route[9]);
+    }
+    ASSERT(table.turn(1, 0) == Vehicle::TD_RIGHT);
+
+    Vehicle a(Vehicle::VT_CAR, 1);
+    Vehicle b(Vehicle::VT_CAR, 1);
+    a.followRoute(table, 0);
+    b.followRoute(table, 0);
+    for (int i = 0; i < 70; i++) {
+        ASSERT(a.nextTurn() == longRoute[i]);
+        ASSERT(a.makeTurn() == longRoute[i]);
+    }
+    ASSERT(a.makeTurn() == Vehicle::TD_INVALID);
+    // b keeps its own position along the shared route
+    ASSERT(b.makeTurn() == longRoute[0]);
+
+    // adding a turn copies the rest of the route into the vehicle
+    b.turnRight();
+    for (int i = 1; i < 70; i++) {
+        ASSERT(b.makeTurn() == longRoute[i]);
+    }
+    ASSERT(b.makeTurn() == Vehicle::TD_RIGHT);
+    ASSERT(b.makeTurn() == Vehicle::TD_INVALID);
+
+    // following a route replaces the vehicle's own turns
+    Vehicle c(Vehicle::VT_BUS, 10);
+    for (int i = 0; i < 40; i++) {
+        c.turnLeft();
+    }
+    c.followRoute(table, 1);
+    ASSERT(c.makeTurn() == Vehicle::TD_RIGHT);
+    c.followRoute(table, 3);
+    ASSERT(c.nextTurn() == Vehicle::TD_INVALID);
+
+    return TR_PASS;
+}
+
+/*
+Test creating, looking up and destroying vehicles in a VehiclePool.
+*/
+TestResult test_VehiclePool() {
+    VehiclePool pool;
+    ASSERT(pool.count() == 0);
+    ASSERT(pool.get(0) == 0);
+
+    VehicleId car = pool.create(Vehicle::VT_CAR, 2);
+    VehicleId bus = pool.create(Vehicle::VT_BUS, 40);
+    ASSERT(car != 0 && bus != 0 && car != bus);
+    ASSERT(pool.count() == 2);
+    ASSERT(pool.get(car)->type() == Vehicle::VT_CAR);
+    ASSERT(pool.get(bus)->occupantCount() == 40);
+    ASSERT(pool.idOf(pool.get(bus)) == bus);
+    ASSERT(pool.at(car) == pool.get(car));
+
+    // a destroyed vehicle's handle goes stale, even once its slot is reused
+    Vehicle* busPointer = pool.get(bus);
+    pool.destroy(bus);
+    ASSERT(pool.get(bus) == 0);
+    ASSERT(pool.count() == 1);
+    VehicleId motorcycle = pool.create(Vehicle::VT_MOTORCYCLE, 1);
+    ASSERT(motorcycle != bus);
+    ASSERT(pool.get(motorcycle) == busPointer);
+    ASSERT(pool.get(bus) == 0);
+    pool.destroy(bus);
+    ASSERT(pool.count() == 2);
+
+    // fill several slabs, with routes long enough to allocate, then clear them all
+    for (unsigned int i = 0; i < 3 * VehiclePool::SLAB_SIZE; i++) {
+        VehicleId id = pool.create(Vehicle::VT_CAR, 1);
+        for (int t = 0; t < 40; t++) {
+            pool.get(id)->turnLeft();
+        }
+    }
+    ASSERT(pool.count() == 3 * VehiclePool::SLAB_SIZE + 2);
+    ASSERT(pool.get(car)->occupantCount() == 2);
+    pool.clear();
+    ASSERT(pool.count() == 0);
+    ASSERT(pool.get(car) == 0 && pool.get(motorcycle) == 0);
+
+    return TR_PASS;
+}
 #endif /*ENABLE_VEHICLE_TESTS*/
 
 #ifdef ENABLE_T1_TESTS
@@ -466,586 +635,1512 @@ TestResult test_ExpressLaneEnqueue2() {
     return TR_PASS;
 }
 
-#endif /*ENABLE_T1_TESTS*/
-
-#ifdef ENABLE_T2_TESTS
 /*
-Test Intersection construction and initial state.
+Test ExpressLane ordering when motorcycles are enqueued after earlier motorcycles have already been dequeued, and when the
+last motorcycle is also the last vehicle in the lane.
 */
-TestResult test_IntersectionConstruction() {
-    Intersection* intersection = new Intersection();
-    // check the intersection is initially invalid
-    ASSERT(!intersection->valid());
-    // invoke the destructor (if any)
-    delete intersection;
+TestResult test_ExpressLaneInterleaved() {
+    ExpressLane lane;
+    Vehicle* c1 = new Vehicle(Vehicle::VT_CAR, 1);
+    Vehicle* c2 = new Vehicle(Vehicle::VT_BUS, 12);
+    Vehicle* m1 = new Vehicle(Vehicle::VT_MOTORCYCLE, 1);
+    Vehicle* m2 = new Vehicle(Vehicle::VT_MOTORCYCLE, 1);
+    Vehicle* m3 = new Vehicle(Vehicle::VT_MOTORCYCLE, 2);
+
+    // a lane of only motorcycles keeps them in order
+    lane.enqueue(m1);
+    lane.enqueue(m2);
+    ASSERT(lane.back() == m2);
+    ASSERT(lane.dequeue() == m1);
+    ASSERT(lane.dequeue() == m2);
+    ASSERT(lane.empty());
+
+    // once the last motorcycle has left, the next one goes to the front again
+    lane.enqueue(m1);
+    lane.enqueue(c1);
+    ASSERT(lane.dequeue() == m1);
+    lane.enqueue(m2);
+    ASSERT(lane.front() == m2);
+    ASSERT(lane.back() == c1);
+    lane.enqueue(c2);
+    lane.enqueue(m3);
+    ASSERT(lane.count() == 4);
+    ASSERT(lane.dequeue() == m2);
+    ASSERT(lane.dequeue() == m3);
+    ASSERT(lane.dequeue() == c1);
+    ASSERT(lane.dequeue() == c2);
+    ASSERT(lane.dequeue() == 0);
+
+    // a motorcycle that is the last vehicle must still become the back of the lane
+    lane.enqueue(m1);
+    ASSERT(lane.back() == m1);
+    lane.enqueue(m2);
+    ASSERT(lane.back() == m2);
+    lane.enqueue(c1);
+    ASSERT(lane.back() == c1);
+    lane.enqueue(m3);
+    ASSERT(lane.back() == c1);
+    ASSERT(lane.dequeue() == m1);
+    ASSERT(lane.dequeue() == m2);
+    ASSERT(lane.dequeue() == m3);
+    ASSERT(lane.dequeue() == c1);
+
+    delete c1;
+    delete c2;
+    delete m1;
+    delete m2;
+    delete m3;
 
     return TR_PASS;
 }
 
 /*
-Test intersection Lane overwriting behavior; i.e. when a new Lane is assigned in a position already occupied by another
-Lane connected to the Intersection.
+Make sure RingLane exhibits the same initial state as SimpleLane
 */
-TestResult test_IntersectionOverwrite() {
-    Intersection intersection;
+TestResult test_RingLaneInitialState() {
+    RingLane lane;
 
-    Lane* l1 = new SimpleLane();
-    Lane* l2 = new SimpleLane();
-    Lane* l3 = new SimpleLane();
-    Lane* l4 = new SimpleLane();
-    Lane* l5 = new SimpleLane();
+    ASSERT(lane.front() == 0);
+    ASSERT(lane.back() == 0);
+    ASSERT(lane.dequeue() == 0);
+    ASSERT(lane.empty() == true);
+    ASSERT(lane.count() == 0);
 
-    // connect first lanes
-    ASSERT(intersection.connectNorth(l1, Intersection::LD_INCOMING) == 0);
-    ASSERT(!intersection.valid());
-    ASSERT(intersection.connectEast(l2, Intersection::LD_OUTGOING) == 0);
-    ASSERT(!intersection.valid());
-    ASSERT(intersection.connectSouth(l3, Intersection::LD_INCOMING) == 0);
-    ASSERT(!intersection.valid());
-    ASSERT(intersection.connectWest(l4, Intersection::LD_OUTGOING) == 0);
-    ASSERT(intersection.valid());
+    return TR_PASS;
+}
 
-    // assign a new lane for each direction
-    ASSERT(intersection.connectNorth(l5, Intersection::LD_INCOMING) == l1);
-    ASSERT(intersection.valid());
-    ASSERT(intersection.connectEast(l5, Intersection::LD_OUTGOING) == l2);
-    ASSERT(intersection.valid());
-    ASSERT(intersection.connectSouth(l5, Intersection::LD_INCOMING) == l3);
-    ASSERT(intersection.valid());
-    ASSERT(intersection.connectWest(l5, Intersection::LD_OUTGOING) == l4);
-    ASSERT(intersection.valid());
+/*
+Test RingLane FIFO order while the buffer grows and while the queue wraps around the end of the buffer.
+*/
+TestResult test_RingLaneEnqueueDequeue() {
+    RingLane lane;
+    Vehicle* vehicles[20];
+    for (int i = 0; i < 20; i++) {
+        vehicles[i] = new Vehicle(i % 3 == 0 ? Vehicle::VT_MOTORCYCLE : Vehicle::VT_CAR, 1);
+    }
 
-    // de-assign all lanes
-    ASSERT(intersection.connectNorth(0, Intersection::LD_INCOMING) == l5);
-    ASSERT(!intersection.valid());
-    ASSERT(intersection.connectEast(0, Intersection::LD_OUTGOING) == l5);
-    ASSERT(!intersection.valid());
-    ASSERT(intersection.connectSouth(0, Intersection::LD_INCOMING) == l5);
-    ASSERT(!intersection.valid());
-    ASSERT(intersection.connectWest(0, Intersection::LD_OUTGOING) == l5);
-    ASSERT(!intersection.valid());
+    // grow past the initial capacity
+    for (int i = 0; i < 12; i++) {
+        lane.enqueue(vehicles[i]);
+        ASSERT(lane.count() == (unsigned int)i + 1);
+        ASSERT(lane.front() == vehicles[0]);
+        ASSERT(lane.back() == vehicles[i]);
+    }
 
-    delete l1;
-    delete l2;
-    delete l3;
-    delete l4;
-    delete l5;
+    // drain most of the queue, then refill so the queue wraps around the end of the buffer
+    for (int i = 0; i < 10; i++) {
+        ASSERT(lane.dequeue() == vehicles[i]);
+    }
+    for (int i = 12; i < 20; i++) {
+        lane.enqueue(vehicles[i]);
+        ASSERT(lane.back() == vehicles[i]);
+    }
+    ASSERT(lane.count() == 10);
+    ASSERT(lane.front() == vehicles[10]);
+
+    // motorcycles get no special treatment in a RingLane
+    for (int i = 10; i < 20; i++) {
+        ASSERT(lane.dequeue() == vehicles[i]);
+    }
+    ASSERT(lane.empty());
+    ASSERT(lane.front() == 0);
+    ASSERT(lane.back() == 0);
+    ASSERT(lane.dequeue() == 0);
+
+    // remaining vehicles should be deleted by the lane
+    lane.enqueue(vehicles[0]);
+    lane.enqueue(vehicles[1]);
+    for (int i = 2; i < 20; i++) {
+        delete vehicles[i];
+    }
 
     return TR_PASS;
 }
 
 /*
-Test an intersection with four Lanes attached, one incoming and three outgoing. This should be the simplest intersection
-it is possible to create; no give way rules have to be applied. Only tested using the SimpleLane class, so motorcycle
-filtering behavior shouldn't affect this test.
+Test that a PriorityLane using the MotorcyclesFirst policy orders vehicles the same way as ExpressLane.
 */
-TestResult test_IntersectionOneIn() {
-    Intersection intersection;
+TestResult test_PriorityLaneMotorcyclesFirst() {
+    PriorityLane<MotorcyclesFirst, 2> lane;
+    ExpressLane reference;
+    Vehicle* vehicles[8];
+    Vehicle::Type types[8] = { Vehicle::VT_CAR, Vehicle::VT_MOTORCYCLE, Vehicle::VT_BUS, Vehicle::VT_MOTORCYCLE,
+                               Vehicle::VT_CAR, Vehicle::VT_CAR, Vehicle::VT_MOTORCYCLE, Vehicle::VT_BUS };
 
-    // vehicles for testing
-    Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
-    v1->turnLeft();
-    Vehicle* v2 = new Vehicle(Vehicle::VT_BUS, 10);
-    v2->turnRight();
-    Vehicle* v3 = new Vehicle(Vehicle::VT_CAR, 1);
-    v3->turnStraight();
-    Vehicle* v4 = new Vehicle(Vehicle::VT_MOTORCYCLE, 2);
-    v4->turnLeft();
-    v4->turnRight();
+    ASSERT(lane.front() == 0);
+    ASSERT(lane.back() == 0);
+    ASSERT(lane.dequeue() == 0);
+    ASSERT(lane.empty());
+
+    for (int i = 0; i < 8; i++) {
+        vehicles[i] = new Vehicle(types[i], 1);
+        lane.enqueue(vehicles[i]);
+        reference.enqueue(vehicles[i]);
+        ASSERT(lane.count() == reference.count());
+        ASSERT(lane.front() == reference.front());
+        ASSERT(lane.back() == reference.back());
+        // take one out part way through so classes empty and refill
+        if (i == 4) {
+            ASSERT(lane.dequeue() == reference.dequeue());
+            ASSERT(lane.dequeue() == reference.dequeue());
+        }
+    }
+    while (!reference.empty()) {
+        ASSERT(lane.front() == reference.front());
+        ASSERT(lane.dequeue() == reference.dequeue());
+    }
+    ASSERT(lane.empty());
+    ASSERT(lane.dequeue() == 0);
 
-    // create the RoadWays
-    Lane* roadIn = new SimpleLane();
-    roadIn->enqueue(v1);
-    roadIn->enqueue(v2);
-    roadIn->enqueue(v3);
-    roadIn->enqueue(v4);
+    for (int i = 0; i < 8; i++) {
+        delete vehicles[i];
+    }
 
-    Lane* roadLeft = new SimpleLane();
-    Lane* roadStraight = new SimpleLane();
-    Lane* roadRight = new SimpleLane();
+    return TR_PASS;
+}
 
-    // add RoadWays to the Intersection
-    ASSERT(intersection.connectNorth(roadIn, Intersection::LD_INCOMING) == 0); // entry
-    ASSERT(intersection.connectEast(roadLeft, Intersection::LD_OUTGOING) == 0); // exit left
-    ASSERT(intersection.connectSouth(roadStraight, Intersection::LD_OUTGOING) == 0); // exit straight
-    ASSERT(intersection.connectWest(roadRight, Intersection::LD_OUTGOING) == 0); // exit right
-    // check intersection is valid
-    ASSERT(intersection.valid());
+/*
+Three class policy used to test PriorityLane: buses first, then motorcycles, then cars.
+*/
+struct BusesThenMotorcycles {
+    static unsigned int classify(const Vehicle* vehicle) {
+        switch (vehicle->type()) {
+        case Vehicle::VT_BUS:
+            return 0;
+        case Vehicle::VT_MOTORCYCLE:
+            return 1;
+        default:
+            return 2;
+        }
+    }
+};
 
-    // simulate a single tick
-    intersection.simulate();
-    // check results (only one vehicle should proceed)
-    ASSERT(roadIn->front() == v2);
-    ASSERT(roadLeft->front() == v1);
-    ASSERT(roadRight->empty());
-    ASSERT(roadStraight->empty());
+/*
+Test PriorityLane with more than two classes, and with the HOV policy.
+*/
+TestResult test_PriorityLaneCustomPolicies() {
+    {
+        PriorityLane<BusesThenMotorcycles, 3> lane;
+        Vehicle* c1 = new Vehicle(Vehicle::VT_CAR, 1);
+        Vehicle* m1 = new Vehicle(Vehicle::VT_MOTORCYCLE, 1);
+        Vehicle* b1 = new Vehicle(Vehicle::VT_BUS, 20);
+        Vehicle* c2 = new Vehicle(Vehicle::VT_CAR, 2);
+        Vehicle* b2 = new Vehicle(Vehicle::VT_BUS, 30);
+
+        lane.enqueue(c1);
+        lane.enqueue(m1);
+        ASSERT(lane.front() == m1);
+        ASSERT(lane.back() == c1);
+        lane.enqueue(b1);
+        lane.enqueue(c2);
+        lane.enqueue(b2);
+        ASSERT(lane.count() == 5);
+        ASSERT(lane.front() == b1);
+        ASSERT(lane.back() == c2);
+
+        ASSERT(lane.dequeue() == b1);
+        ASSERT(lane.dequeue() == b2);
+        ASSERT(lane.front() == m1);
+        ASSERT(lane.dequeue() == m1);
+        ASSERT(lane.dequeue() == c1);
+        ASSERT(lane.count() == 1);
+        // c2 should be deleted by the lane
+        delete c1;
+        delete m1;
+        delete b1;
+        delete b2;
+    }
 
-    // run the simulation for 3 more ticks to allow the other vehicles to proceed
-    for (int i = 0; i < 3; ++i) {
-        intersection.simulate();
+    {
+        PriorityLane<HighOccupancyFirst<3>, 2> lane;
+        Vehicle* solo = new Vehicle(Vehicle::VT_CAR, 1);
+        Vehicle* pair = new Vehicle(Vehicle::VT_CAR, 2);
+        Vehicle* carpool = new Vehicle(Vehicle::VT_CAR, 4);
+        Vehicle* bus = new Vehicle(Vehicle::VT_BUS, 3);
+
+        lane.enqueue(solo);
+        lane.enqueue(carpool);
+        lane.enqueue(pair);
+        lane.enqueue(bus);
+        ASSERT(lane.dequeue() == carpool);
+        ASSERT(lane.dequeue() == bus);
+        ASSERT(lane.dequeue() == solo);
+        ASSERT(lane.dequeue() == pair);
+        ASSERT(lane.empty());
+
+        delete solo;
+        delete pair;
+        delete carpool;
+        delete bus;
     }
 
-    // check all vehicles passed through the intersection successfully
-    ASSERT(roadIn->front() == 0);
-    ASSERT(roadLeft->dequeue() == v1);
-    ASSERT(roadLeft->dequeue() == v4);
-    ASSERT(roadLeft->front() == 0);
-    ASSERT(roadStraight->dequeue() == v3);
-    ASSERT(roadStraight->front() == 0);
-    ASSERT(roadRight->dequeue() == v2);
-    ASSERT(roadRight->front() == 0);
+    return TR_PASS;
+}
 
-    delete roadIn;
-    delete roadLeft;
-    delete roadStraight;
-    delete roadRight;
+/*
+Helper for the batch tests: check that `lane` holds exactly `expected[0..n)` from front to back, using peek().
+*/
+bool laneHolds(const Lane& lane, Vehicle* const* expected, unsigned int n) {
+    if (lane.count() != n || lane.peek(n) != 0) {
+        return false;
+    }
+    for (unsigned int i = 0; i < n; i++) {
+        if (lane.peek(i) != expected[i]) {
+            return false;
+        }
+    }
+    return true;
+}
 
-    delete v1;
-    delete v2;
-    delete v3;
-    delete v4;
+/*
+Test enqueueRange, dequeueInto and peek on each lane type, which should behave exactly like repeated enqueue and dequeue
+calls.
+*/
+TestResult test_LaneBatchOperations() {
+    Vehicle* vehicles[6];
+    for (int i = 0; i < 6; i++) {
+        vehicles[i] = new Vehicle(Vehicle::VT_CAR, i + 1);
+    }
+
+    Lane* lanes[4] = { new SimpleLane(), new ExpressLane(), new RingLane(), new PriorityLane<BusesFirst, 2>() };
+    for (int l = 0; l < 4; l++) {
+        Lane* lane = lanes[l];
+        Vehicle* out[6];
+
+        ASSERT(lane->peek(0) == 0);
+        ASSERT(lane->dequeueInto(out, 6) == 0);
+        lane->enqueueRange(vehicles, 0);
+        ASSERT(lane->empty());
+
+        lane->enqueue(vehicles[0]);
+        lane->enqueueRange(vehicles + 1, 5);
+        ASSERT(laneHolds(*lane, vehicles, 6));
+        ASSERT(lane->front() == vehicles[0]);
+        ASSERT(lane->back() == vehicles[5]);
+
+        ASSERT(lane->dequeueInto(out, 2) == 2);
+        ASSERT(out[0] == vehicles[0]);
+        ASSERT(out[1] == vehicles[1]);
+        ASSERT(laneHolds(*lane, vehicles + 2, 4));
+
+        ASSERT(lane->dequeueInto(out, 6) == 4);
+        ASSERT(out[3] == vehicles[5]);
+        ASSERT(lane->empty());
+        ASSERT(lane->front() == 0);
+        ASSERT(lane->back() == 0);
+
+        // the lane must still work normally after being drained
+        lane->enqueueRange(vehicles, 3);
+        ASSERT(laneHolds(*lane, vehicles, 3));
+        ASSERT(lane->dequeueInto(out, 3) == 3);
+        delete lane;
+    }
+
+    for (int i = 0; i < 6; i++) {
+        delete vehicles[i];
+    }
 
     return TR_PASS;
 }
 
 /*
-Test an intersection with four Lanes attached, two incoming and two outgoing, arranged so that Lanes attached to the
-intersection in the same direction (e.g. incoming) are directly opposite each other.
+Test batch operations and splicing on ExpressLane, where motorcycles from the batch or the other lane must still be
+placed behind motorcycles already queued but ahead of cars and buses.
 */
-TestResult test_IntersectionTwoInOpposing() {
-    Intersection intersection;
+TestResult test_ExpressLaneBatchAndSplice() {
+    Vehicle* c1 = new Vehicle(Vehicle::VT_CAR, 1);
+    Vehicle* c2 = new Vehicle(Vehicle::VT_CAR, 1);
+    Vehicle* b1 = new Vehicle(Vehicle::VT_BUS, 1);
+    Vehicle* m1 = new Vehicle(Vehicle::VT_MOTORCYCLE, 1);
+    Vehicle* m2 = new Vehicle(Vehicle::VT_MOTORCYCLE, 1);
+    Vehicle* m3 = new Vehicle(Vehicle::VT_MOTORCYCLE, 1);
 
-    // vehicles for testing
-    Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
-    v1->turnLeft();
-    Vehicle* v2 = new Vehicle(Vehicle::VT_BUS, 10);
-    v2->turnRight();
-    Vehicle* v3 = new Vehicle(Vehicle::VT_CAR, 1);
-    v3->turnRight();
-    Vehicle* v4 = new Vehicle(Vehicle::VT_MOTORCYCLE, 2);
-    v4->turnLeft();
-    v4->turnRight();
-    Vehicle* v5 = new Vehicle(Vehicle::VT_CAR, 3);
-    v5->turnRight();
-    Vehicle* v6 = new Vehicle(Vehicle::VT_CAR, 2);
-    v6->turnRight();
-    v6->turnLeft();
-    Vehicle* v7 = new Vehicle(Vehicle::VT_BUS, 8);
-    v7->turnRight();
-    Vehicle* v8 = new Vehicle(Vehicle::VT_MOTORCYCLE, 1);
-    v8->turnLeft();
+    {
+        ExpressLane lane;
+        Vehicle* batch[4] = { c1, m1, c2, m2 };
+        lane.enqueueRange(batch, 4);
+        Vehicle* expected[4] = { m1, m2, c1, c2 };
+        ASSERT(laneHolds(lane, expected, 4));
+
+        // draining the motorcycles with dequeueInto must reset the motorcycle boundary
+        Vehicle* out[2];
+        ASSERT(lane.dequeueInto(out, 2) == 2);
+        ASSERT(out[0] == m1 && out[1] == m2);
+        lane.enqueue(m3);
+        Vehicle* expected2[3] = { m3, c1, c2 };
+        ASSERT(laneHolds(lane, expected2, 3));
+        ASSERT(lane.dequeueInto(out, 2) == 2);
+        ASSERT(lane.dequeue() == c2);
+    }
 
-    // create the Lanes
-    Lane* roadInNorth = new SimpleLane();
-    roadInNorth->enqueue(v1);
-    roadInNorth->enqueue(v2);
-    roadInNorth->enqueue(v3);
-    roadInNorth->enqueue(v4);
+    {
+        // lane has a motorcycle and a car, other has motorcycles and a bus
+        ExpressLane lane;
+        ExpressLane other;
+        lane.enqueue(c1);
+        lane.enqueue(m1);
+        other.enqueue(b1);
+        other.enqueue(m2);
+        other.enqueue(m3);
+        lane.spliceFrom(other);
+        ASSERT(other.empty());
+        ASSERT(other.front() == 0);
+        Vehicle* expected[5] = { m1, m2, m3, c1, b1 };
+        ASSERT(laneHolds(lane, expected, 5));
+        // the spliced motorcycles are now the lane's last bikes
+        lane.enqueue(c2);
+        Vehicle* out[6];
+        ASSERT(lane.dequeueInto(out, 6) == 6);
+        ASSERT(out[2] == m3 && out[5] == c2);
+        lane.enqueue(c2);
+        ASSERT(lane.front() == c2);
+        ASSERT(lane.dequeue() == c2);
+
+        // splicing into an empty lane, and a lane of only motorcycles
+        other.enqueue(m1);
+        other.enqueue(c1);
+        lane.spliceFrom(other);
+        other.enqueue(m2);
+        lane.spliceFrom(other);
+        Vehicle* expected2[3] = { m1, m2, c1 };
+        ASSERT(laneHolds(lane, expected2, 3));
+        ASSERT(lane.back() == c1);
+        ASSERT(lane.dequeueInto(out, 6) == 3);
+    }
 
-    Lane* roadInSouth = new SimpleLane();
-    roadInSouth->enqueue(v5);
-    roadInSouth->enqueue(v6);
-    roadInSouth->enqueue(v7);
-    roadInSouth->enqueue(v8);
-
-    Lane* roadOutEast = new SimpleLane();
-    Lane* roadOutWest = new SimpleLane();
+    {
+        // splicing lanes of different types moves the vehicles one at a time
+        ExpressLane lane;
+        SimpleLane other;
+        RingLane ring;
+        lane.enqueue(c1);
+        other.enqueue(c2);
+        other.enqueue(m1);
+        lane.spliceFrom(other);
+        Vehicle* expected[3] = { m1, c1, c2 };
+        ASSERT(laneHolds(lane, expected, 3));
+        ring.spliceFrom(lane);
+        ASSERT(lane.empty());
+        ASSERT(laneHolds(ring, expected, 3));
+        other.spliceFrom(ring);
+        ASSERT(laneHolds(other, expected, 3));
+        ASSERT(other.dequeue() == m1);
+        ASSERT(other.dequeue() == c1);
+        ASSERT(other.dequeue() == c2);
+    }
 
-    // add Lanes to the Intersection
-    ASSERT(intersection.connectNorth(roadInNorth, Intersection::LD_INCOMING) == 0); // entry
-    ASSERT(intersection.connectEast(roadOutEast, Intersection::LD_OUTGOING) == 0); // exit
-    ASSERT(intersection.connectSouth(roadInSouth, Intersection::LD_INCOMING) == 0); // entry
-    ASSERT(intersection.connectWest(roadOutWest, Intersection::LD_OUTGOING) == 0); // exit
-    // check intersection is valid
-    ASSERT(intersection.valid());
+    delete c1;
+    delete c2;
+    delete b1;
+    delete m1;
+    delete m2;
+    delete m3;
 
-    // simulate a single tick
-    intersection.simulate();
-    // check results (exactly one vehicle should proceed)
-    ASSERT(roadInNorth->front() == v2);
-    ASSERT(roadOutEast->front() == v1);
-    ASSERT(roadInSouth->front() == v5);
-    ASSERT(roadOutWest->front() == 0);
+    return TR_PASS;
+}
 
-    // run the simulation for 5 more ticks to allow the other vehicles to proceed (should be enough if road rules are
-    // followed)
-    for (int i = 0; i < 5; ++i) {
-        intersection.simulate();
+/*
+Test splicing lanes of the same type, which hands over the queued vehicles without moving them one at a time.
+*/
+TestResult test_LaneSpliceSameType() {
+    Vehicle* vehicles[5];
+    for (int i = 0; i < 5; i++) {
+        vehicles[i] = new Vehicle(Vehicle::VT_BUS, i);
     }
 
-    // check all vehicles passed through the intersection successfully
-    // check inbound lanes
-    ASSERT(roadInNorth->front() == 0);
-    ASSERT(roadInSouth->front() == 0);
-    // check eastbound out lane
-    ASSERT(roadOutEast->dequeue() == v1);
-    ASSERT(roadOutEast->dequeue() == v5);
-    ASSERT(roadOutEast->dequeue() == v6);
-    ASSERT(roadOutEast->dequeue() == v4);
-    ASSERT(roadOutEast->dequeue() == v7);
-    ASSERT(roadOutEast->dequeue() == 0);
-    // check westbound out lane
-    ASSERT(roadOutWest->dequeue() == v2);
-    ASSERT(roadOutWest->dequeue() == v3);
-    ASSERT(roadOutWest->dequeue() == v8);
-    ASSERT(roadOutWest->dequeue() == 0);
+    {
+        SimpleLane lane;
+        SimpleLane other;
+        lane.spliceFrom(other);
+        ASSERT(lane.empty());
+        other.enqueueRange(vehicles, 2);
+        lane.spliceFrom(other);
+        ASSERT(other.empty() && other.count() == 0 && other.back() == 0);
+        other.enqueueRange(vehicles + 2, 3);
+        lane.spliceFrom(other);
+        ASSERT(laneHolds(lane, vehicles, 5));
+        ASSERT(other.dequeue() == 0);
+        Vehicle* out[5];
+        ASSERT(lane.dequeueInto(out, 5) == 5);
+    }
 
-    delete roadInNorth;
-    delete roadOutEast;
-    delete roadInSouth;
-    delete roadOutWest;
+    {
+        RingLane lane;
+        RingLane other;
+        other.enqueueRange(vehicles, 2);
+        lane.spliceFrom(other);
+        ASSERT(other.empty());
+        other.enqueueRange(vehicles + 2, 3);
+        lane.spliceFrom(other);
+        ASSERT(laneHolds(lane, vehicles, 5));
+        ASSERT(other.empty());
+        Vehicle* out[5];
+        ASSERT(lane.dequeueInto(out, 5) == 5);
+    }
 
-    delete v1;
-    delete v2;
-    delete v3;
-    delete v4;
-    delete v5;
-    delete v6;
-    delete v7;
-    delete v8;
+    for (int i = 0; i < 5; i++) {
+        delete vehicles[i];
+    }
 
     return TR_PASS;
 }
 
-// from piazza @418
-TestResult test_IntersectionTwoInAdjacent() {
-    Intersection intersection;
+/*
+Test the concurrent lanes from a single thread, where they must behave like SimpleLane up to their capacity.
+*/
+TestResult test_ConcurrentLanesSingleThread() {
+    SpscLane spsc(3);
+    MpscLane mpsc(4);
+    Lane* lanes[2] = { &spsc, &mpsc };
+    ASSERT(spsc.capacity() == 4);
+    ASSERT(mpsc.capacity() == 4);
+
+    Vehicle* vehicles[5];
+    for (int i = 0; i < 5; i++) {
+        vehicles[i] = new Vehicle(Vehicle::VT_CAR, 1);
+    }
 
-    // vehicles for testing
-    Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
-    v1->turnStraight();
-    Vehicle* v2 = new Vehicle(Vehicle::VT_BUS, 10);
-    v2->turnLeft();
-    Vehicle* v3 = new Vehicle(Vehicle::VT_CAR, 1);
-    v3->turnStraight();
-    Vehicle* v4 = new Vehicle(Vehicle::VT_MOTORCYCLE, 2);
-    v4->turnLeft();
-    Vehicle* v5 = new Vehicle(Vehicle::VT_CAR, 3);
-    v5->turnStraight();
-    Vehicle* v6 = new Vehicle(Vehicle::VT_CAR, 2);
-    v6->turnStraight();
-    Vehicle* v7 = new Vehicle(Vehicle::VT_BUS, 8);
-    v7->turnRight();
-    Vehicle* v8 = new Vehicle(Vehicle::VT_MOTORCYCLE, 1);
-    v8->turnStraight();
+    for (int l = 0; l < 2; l++) {
+        Lane* lane = lanes[l];
+        ASSERT(lane->front() == 0);
+        ASSERT(lane->back() == 0);
+        ASSERT(lane->dequeue() == 0);
+        ASSERT(lane->empty());
+        ASSERT(lane->count() == 0);
+
+        // go around the ring a few times
+        for (int round = 0; round < 3; round++) {
+            for (int i = 0; i < 4; i++) {
+                lane->enqueue(vehicles[i]);
+                ASSERT(lane->back() == vehicles[i]);
+                ASSERT(lane->front() == vehicles[0]);
+                ASSERT(lane->count() == (unsigned int)i + 1);
+            }
+            ASSERT(lane->peek(3) == vehicles[3]);
+            ASSERT(lane->peek(4) == 0);
+            for (int i = 0; i < 4; i++) {
+                ASSERT(lane->dequeue() == vehicles[i]);
+            }
+            ASSERT(lane->empty());
+        }
+    }
 
-    // create the Lanes
-    Lane* roadInSouth = new SimpleLane();
-    roadInSouth->enqueue(v1);
-    roadInSouth->enqueue(v2);
-    roadInSouth->enqueue(v3);
-    roadInSouth->enqueue(v4);
+    // a full lane refuses more vehicles
+    for (int i = 0; i < 4; i++) {
+        ASSERT(spsc.tryEnqueue(vehicles[i]));
+        ASSERT(mpsc.tryEnqueue(vehicles[i]));
+    }
+    ASSERT(!spsc.tryEnqueue(vehicles[4]));
+    ASSERT(!mpsc.tryEnqueue(vehicles[4]));
+    ASSERT(spsc.dequeue() == vehicles[0]);
+    ASSERT(mpsc.dequeue() == vehicles[0]);
+    ASSERT(spsc.tryEnqueue(vehicles[4]));
+    ASSERT(mpsc.tryEnqueue(vehicles[4]));
+    ASSERT(spsc.back() == vehicles[4]);
+    ASSERT(mpsc.back() == vehicles[4]);
+    for (int i = 1; i < 5; i++) {
+        ASSERT(spsc.dequeue() == vehicles[i]);
+        ASSERT(mpsc.dequeue() == vehicles[i]);
+    }
 
-    Lane* roadInEast = new SimpleLane();
-    roadInEast->enqueue(v5);
-    roadInEast->enqueue(v6);
-    roadInEast->enqueue(v7);
-    roadInEast->enqueue(v8);
+    for (int i = 0; i < 5; i++) {
+        delete vehicles[i];
+    }
 
-    Lane* roadOutNorth = new SimpleLane();
-    Lane* roadOutWest = new SimpleLane();
+    return TR_PASS;
+}
 
-    // add Lanes to the Intersection
-    ASSERT(intersection.connectNorth(roadOutNorth, Intersection::LD_OUTGOING) == 0); // exit
-    ASSERT(intersection.connectEast(roadInEast, Intersection::LD_INCOMING) == 0); // entry
-    ASSERT(intersection.connectSouth(roadInSouth, Intersection::LD_INCOMING) == 0); // entry
-    ASSERT(intersection.connectWest(roadOutWest, Intersection::LD_OUTGOING) == 0); // exit
-    // check intersection is valid
-    ASSERT(intersection.valid());
+/*
+Stress test an SpscLane with a producer and a consumer thread. The consumer must see every vehicle exactly once, in the
+order the producer enqueued them. Run this under ThreadSanitizer with `make tsan`.
+*/
+TestResult test_SpscLaneStress() {
+    const unsigned int total = 100000;
+    SpscLane lane(64);
+    vector<Vehicle*> vehicles(total);
+    for (unsigned int i = 0; i < total; i++) {
+        vehicles[i] = new Vehicle(Vehicle::VT_CAR, i);
+    }
 
-    // simulate a single tick
-    intersection.simulate();
-    // check results (exactly one vehicle should proceed)
-    ASSERT(roadInSouth->front() == v2);
-    ASSERT(roadInEast->front() == v6);
-    ASSERT(roadOutNorth->front() == v1);
-    ASSERT(roadOutWest->front() == v5);
+    thread producer([&]() {
+        for (unsigned int i = 0; i < total; i++) {
+            lane.enqueue(vehicles[i]);
+        }
+    });
+
+    bool inOrder = true;
+    unsigned int received = 0;
+    while (received < total) {
+        const Vehicle* next = lane.front();
+        if (next == 0) {
+            this_thread::yield();
+            continue;
+        }
+        if (lane.dequeue() != next || next != vehicles[received]) {
+            inOrder = false;
+        }
+        received++;
+    }
+    producer.join();
 
+    ASSERT(inOrder);
+    ASSERT(lane.empty());
+    ASSERT(lane.count() == 0);
+    for (unsigned int i = 0; i < total; i++) {
+        delete vehicles[i];
+    }
 
-    // run the simulation for 7 more ticks to allow the other vehicles to proceed (should be enough if road rules are
-    // followed)
-    for (int i = 0; i < 8; ++i) {
-        intersection.simulate();
+    return TR_PASS;
+}
+
+/*
+Stress test an MpscLane with several producer threads and one consumer. The consumer must see every vehicle exactly
+once, and each producer's vehicles in the order that producer enqueued them. Run this under ThreadSanitizer with
+`make tsan`.
+*/
+TestResult test_MpscLaneStress() {
+    const unsigned int producers = 4;
+    const unsigned int perProducer = 25000;
+    MpscLane lane(64);
+    vector<Vehicle*> vehicles(producers * perProducer);
+    for (unsigned int i = 0; i < producers * perProducer; i++) {
+        // the occupant count records the index of the vehicle within its producer's sequence
+        vehicles[i] = new Vehicle(Vehicle::VT_CAR, i % perProducer);
     }
 
-    // check all vehicles passed through the intersection successfully
-    // check inbound lanes
-    ASSERT(roadInEast->front() == 0);
-    ASSERT(roadInSouth->front() == 0);
-    // check northbound out lane
-    ASSERT(roadOutNorth->dequeue() == v1);
-    ASSERT(roadOutNorth->dequeue() == v3);
-    ASSERT(roadOutNorth->dequeue() == v7);
-    ASSERT(roadOutNorth->dequeue() == 0);
-    // check westbound out lane
-    ASSERT(roadOutWest->dequeue() == v5);
-    ASSERT(roadOutWest->dequeue() == v6);
-    ASSERT(roadOutWest->dequeue() == v2);
-    ASSERT(roadOutWest->dequeue() == v4);
-    ASSERT(roadOutWest->dequeue() == v8);
-    ASSERT(roadOutWest->dequeue() == 0);
+    vector<thread> threads;
+    for (unsigned int p = 0; p < producers; p++) {
+        threads.push_back(thread([&, p]() {
+            for (unsigned int i = 0; i < perProducer; i++) {
+                lane.enqueue(vehicles[p * perProducer + i]);
+            }
+        }));
+    }
 
-    delete roadInEast;
-    delete roadOutNorth;
-    delete roadInSouth;
-    delete roadOutWest;
+    bool inOrder = true;
+    vector<unsigned int> nextExpected(producers, 0);
+    unsigned int received = 0;
+    while (received < producers * perProducer) {
+        Vehicle* vehicle = lane.dequeue();
+        if (vehicle == 0) {
+            this_thread::yield();
+            continue;
+        }
+        // find which producer enqueued the vehicle from its position in the array
+        unsigned int p = 0;
+        while (vehicles[p * perProducer + vehicle->occupantCount()] != vehicle) {
+            p++;
+        }
+        if (vehicle->occupantCount() != nextExpected[p]) {
+            inOrder = false;
+        }
+        nextExpected[p]++;
+        received++;
+    }
+    for (unsigned int p = 0; p < producers; p++) {
+        threads[p].join();
+    }
 
-    delete v1;
-    delete v2;
-    delete v3;
-    delete v4;
-    delete v5;
-    delete v6;
-    delete v7;
-    delete v8;
+    ASSERT(inOrder);
+    ASSERT(lane.empty());
+    ASSERT(lane.count() == 0);
+    for (unsigned int i = 0; i < producers * perProducer; i++) {
+        delete vehicles[i];
+    }
 
     return TR_PASS;
 }
 
-// from piazza @418, modified by hamish
-TestResult test_IntersectionThreeIn() {
-    Intersection intersection;
+/*
+Test lane capacity limits; lanes are unbounded by default and report full() once they hold `capacity` vehicles.
+*/
+TestResult test_LaneCapacity() {
+    Vehicle* vehicles[3];
+    for (int i = 0; i < 3; i++) {
+        vehicles[i] = new Vehicle(Vehicle::VT_CAR, 1);
+    }
 
-    // vehicles for testing
-    Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
-    v1->turnLeft();
-    Vehicle* v2 = new Vehicle(Vehicle::VT_BUS, 10);
-    v2->turnLeft();
-    Vehicle* v3 = new Vehicle(Vehicle::VT_CAR, 1);
-    v3->turnLeft();
-    Vehicle* v4 = new Vehicle(Vehicle::VT_MOTORCYCLE, 2);
-    v4->turnStraight();
-    Vehicle* v5 = new Vehicle(Vehicle::VT_CAR, 3);
-    v5->turnStraight();
-    Vehicle* v6 = new Vehicle(Vehicle::VT_CAR, 2);
-    v6->turnStraight();
-    Vehicle* v7 = new Vehicle(Vehicle::VT_BUS, 8);
-    v7->turnRight();
-    Vehicle* v8 = new Vehicle(Vehicle::VT_MOTORCYCLE, 1);
-    v8->turnRight();
-    Vehicle* v9 = new Vehicle(Vehicle::VT_MOTORCYCLE, 1);
-    v9->turnRight();
+    Lane* lanes[4] = { new SimpleLane(), new ExpressLane(), new RingLane(), new PriorityLane<BusesFirst, 2>() };
+    for (int l = 0; l < 4; l++) {
+        Lane* lane = lanes[l];
+        ASSERT(lane->capacity() == 0);
+        lane->enqueueRange(vehicles, 3);
+        ASSERT(!lane->full());
+
+        lane->setCapacity(2);
+        ASSERT(lane->capacity() == 2);
+        ASSERT(lane->full());
+        lane->dequeue();
+        ASSERT(lane->full());
+        lane->dequeue();
+        ASSERT(!lane->full());
+
+        lane->setCapacity(0);
+        lane->dequeue();
+        ASSERT(!lane->full());
+        delete lane;
+    }
 
-    // create the Lanes
-    Lane* roadInSouth = new SimpleLane();
-    roadInSouth->enqueue(v1);
-    roadInSouth->enqueue(v2);
-    roadInSouth->enqueue(v3);
+    // the ring of a concurrent lane cannot grow, so its limit stays within the ring
+    SpscLane spsc(4);
+    ASSERT(spsc.capacity() == 4);
+    spsc.setCapacity(2);
+    ASSERT(spsc.capacity() == 2);
+    spsc.setCapacity(0);
+    ASSERT(spsc.capacity() == 4);
+    MpscLane mpsc(4);
+    mpsc.setCapacity(100);
+    ASSERT(mpsc.capacity() == 4);
+    mpsc.enqueueRange(vehicles, 3);
+    ASSERT(!mpsc.full());
+    mpsc.enqueue(vehicles[0]);
+    ASSERT(mpsc.full());
+    Vehicle* out[4];
+    ASSERT(mpsc.dequeueInto(out, 4) == 4);
+
+    for (int i = 0; i < 3; i++) {
+        delete vehicles[i];
+    }
 
-    Lane* roadInEast = new SimpleLane();
-    roadInEast->enqueue(v4);
-    roadInEast->enqueue(v5);
-    roadInEast->enqueue(v6);
+    return TR_PASS;
+}
 
-    Lane* roadInNorth = new SimpleLane();
-    roadInNorth->enqueue(v7);
-    roadInNorth->enqueue(v8);
-    roadInNorth->enqueue(v9);
 
-    Lane* roadOutWest = new SimpleLane();
+TestResult test_LaneStats() {
+    Lane* lanes[6] = { new SimpleLane(), new ExpressLane(), new RingLane(), new PriorityLane<BusesFirst, 2>(),
+                       new SpscLane(8), new MpscLane(8) };
+    for (int l = 0; l < 6; l++) {
+        Lane* lane = lanes[l];
+        LaneStats stats = lane->stats();
+        ASSERT(stats.passed == 0 && stats.peakDepth == 0 && stats.occupants == 0);
+
+        Vehicle* vehicles[3] = { new Vehicle(Vehicle::VT_CAR, 2), new Vehicle(Vehicle::VT_BUS, 20),
+                                 new Vehicle(Vehicle::VT_MOTORCYCLE, 1) };
+        lane->enqueue(vehicles[0]);
+        lane->enqueueRange(vehicles + 1, 2);
+        stats = lane->stats();
+#ifndef TRAFFIC_NO_LANE_STATS
+        ASSERT(stats.peakDepth == 3);
+        ASSERT(stats.occupants == 23);
+        ASSERT(stats.typeCount[Vehicle::VT_CAR] == 1);
+        ASSERT(stats.typeCount[Vehicle::VT_BUS] == 1);
+        ASSERT(stats.typeCount[Vehicle::VT_MOTORCYCLE] == 1);
+
+        Vehicle* out[2];
+        delete lane->dequeue();
+        unsigned int n = lane->dequeueInto(out, 2);
+        for (unsigned int i = 0; i < n; i++) {
+            delete out[i];
+        }
+        stats = lane->stats();
+        ASSERT(stats.passed == 3);
+        ASSERT(stats.peakDepth == 3);
+        ASSERT(stats.occupants == 0);
+        ASSERT(stats.typeCount[Vehicle::VT_CAR] == 0 && stats.typeCount[Vehicle::VT_BUS] == 0);
+#else
+        ASSERT(stats.passed == 0 && stats.peakDepth == 0);
+#endif
+        delete lane;
+    }
 
-    // add Lanes to the Intersection
-    ASSERT(intersection.connectNorth(roadInNorth, Intersection::LD_INCOMING) == 0); // entry
-    ASSERT(intersection.connectEast(roadInEast, Intersection::LD_INCOMING) == 0); // entry
-    ASSERT(intersection.connectSouth(roadInSouth, Intersection::LD_INCOMING) == 0); // entry
-    ASSERT(intersection.connectWest(roadOutWest, Intersection::LD_OUTGOING) == 0); // exit
-    // check intersection is valid
-    ASSERT(intersection.valid());
+    // splicing moves the queued counters along with the vehicles
+    RingLane from, to;
+    to.enqueue(new Vehicle(Vehicle::VT_CAR, 1));
+    from.enqueue(new Vehicle(Vehicle::VT_BUS, 10));
+    from.enqueue(new Vehicle(Vehicle::VT_CAR, 3));
+    to.spliceFrom(from);
+    LaneStats fromStats = from.stats();
+    LaneStats toStats = to.stats();
+#ifndef TRAFFIC_NO_LANE_STATS
+    ASSERT(fromStats.occupants == 0 && fromStats.typeCount[Vehicle::VT_CAR] == 0 && fromStats.passed == 2);
+    ASSERT(toStats.occupants == 14 && toStats.typeCount[Vehicle::VT_CAR] == 2 && toStats.peakDepth == 3);
+#else
+    ASSERT(fromStats.passed == 0 && toStats.passed == 0);
+#endif
+    return TR_PASS;
+}
 
-    // simulate a single tick
-    intersection.simulate();
-    // check results (exactly one vehicle should proceed)
-    ASSERT(roadInSouth->front() == v1);
-    ASSERT(roadInEast->front() == v5);
-    ASSERT(roadInNorth->front() == v7);
-    ASSERT(roadOutWest->front() == v4);
 
-    // run the simulation for 9 more ticks to allow the other vehicles to proceed (should be enough if road rules are
-    // followed)
-    for (int i = 0; i < 9; ++i) {
-        intersection.simulate();
+TestResult test_LaneIteration() {
+    Lane* lanes[6] = { new SimpleLane(), new ExpressLane(), new RingLane(8), new PriorityLane<BusesFirst, 2>(),
+                       new SpscLane(8), new MpscLane(8) };
+    for (int l = 0; l < 6; l++) {
+        Lane* lane = lanes[l];
+        const Vehicle* out[8];
+        ASSERT(lane->begin() == lane->end());
+        ASSERT(lane->snapshot(out, 8) == 0);
+
+        // cycle vehicles through the lane so ring buffers wrap around
+        for (int i = 0; i < 6; i++) {
+            lane->enqueue(new Vehicle(i % 3 == 0 ? Vehicle::VT_BUS : Vehicle::VT_MOTORCYCLE, 1));
+        }
+        for (int i = 0; i < 4; i++) {
+            delete lane->dequeue();
+        }
+        for (int i = 0; i < 5; i++) {
+            lane->enqueue(new Vehicle(Vehicle::VT_CAR, 1));
+        }
+
+        unsigned int n = 0;
+        for (Lane::const_iterator it = lane->begin(); it != lane->end(); it++) {
+            ASSERT(*it == lane->peek(n));
+            n++;
+        }
+        ASSERT(n == lane->count());
+        ASSERT((unsigned int)std::distance(lane->begin(), lane->end()) == lane->count());
+
+        ASSERT(lane->snapshot(out, 8) == 7);
+        for (unsigned int i = 0; i < 7; i++) {
+            ASSERT(out[i] == lane->peek(i));
+        }
+        ASSERT(lane->snapshot(out, 3) == 3);
+        ASSERT(out[2] == lane->peek(2));
+        // iterating does not change the lane
+        ASSERT(lane->count() == 7);
+        delete lane;
     }
 
-    // check all vehicles passed through the intersection successfully
-    // check inbound lanes
-    ASSERT(roadInEast->front() == 0);
-    ASSERT(roadInSouth->front() == 0);
-    ASSERT(roadInNorth->front() == 0);
-    // check westbound out lane
-    ASSERT(roadOutWest->dequeue() == v4);
-    ASSERT(roadOutWest->dequeue() == v5);
-    ASSERT(roadOutWest->dequeue() == v6);
-    ASSERT(roadOutWest->dequeue() == v1);
-    ASSERT(roadOutWest->dequeue() == v2);
-    ASSERT(roadOutWest->dequeue() == v3);
-    ASSERT(roadOutWest->dequeue() == v7);
-    ASSERT(roadOutWest->dequeue() == v8);
-    ASSERT(roadOutWest->dequeue() == v9);
-    ASSERT(roadOutWest->dequeue() == 0);
+    // a vehicle queued twice is still visited twice
+    RingLane lane;
+    Vehicle* vehicle = new Vehicle(Vehicle::VT_CAR, 1);
+    lane.enqueue(vehicle);
+    lane.enqueue(vehicle);
+    ASSERT(std::distance(lane.begin(), lane.end()) == 2);
+    lane.dequeue();
+    return TR_PASS;
+}
 
-    delete roadInEast;
-    delete roadInNorth;
-    delete roadInSouth;
-    delete roadOutWest;
+TestResult test_PooledLane() {
+    VehiclePool pool;
+    PooledLane lane(pool);
+    ASSERT(lane.empty());
+    ASSERT(lane.dequeue() == 0 && lane.dequeueId() == 0);
 
-    delete v1;
-    delete v2;
-    delete v3;
-    delete v4;
-    delete v5;
-    delete v6;
-    delete v7;
-    delete v8;
-    delete v9;
+    VehicleId ids[4];
+    for (int i = 0; i < 4; i++) {
+        ids[i] = pool.create(i == 2 ? Vehicle::VT_BUS : Vehicle::VT_CAR, i + 1);
+    }
+    lane.enqueueId(ids[0]);
+    lane.enqueue(pool.get(ids[1]));
+    Vehicle* rest[2] = { pool.get(ids[2]), pool.get(ids[3]) };
+    lane.enqueueRange(rest, 2);
+    ASSERT(lane.count() == 4);
+    ASSERT(lane.front() == pool.get(ids[0]));
+    ASSERT(lane.back() == pool.get(ids[3]));
+    ASSERT(lane.peek(2)->type() == Vehicle::VT_BUS);
+#ifndef TRAFFIC_NO_LANE_STATS
+    ASSERT(lane.stats().occupants == 10);
+#endif
+
+    ASSERT(lane.dequeueId() == ids[0]);
+    ASSERT(lane.dequeue() == pool.get(ids[1]));
+
+    // splicing between lanes over the same pool moves the handles
+    PooledLane other(pool);
+    other.enqueueId(ids[0]);
+    other.spliceFrom(lane);
+    ASSERT(lane.empty());
+    ASSERT(other.count() == 3);
+    ASSERT(other.peek(1) == pool.get(ids[2]));
+
+    // vehicles left in a lane are destroyed in the pool with it
+    {
+        PooledLane scoped(pool);
+        scoped.spliceFrom(other);
+    }
+    ASSERT(pool.get(ids[0]) == 0 && pool.get(ids[3]) == 0);
+    ASSERT(pool.count() == 1);
+    pool.destroy(ids[1]);
+    return TR_PASS;
+}
+
+TestResult test_FleetStore() {
+    FleetStore store;
+    ASSERT(store.count() == 0);
+    ASSERT(store.occupantsOf(Vehicle::VT_BUS) == 0);
+
+    RingLane lane;
+    Vehicle* bus = new Vehicle(Vehicle::VT_BUS, 40);
+    bus->turnLeft();
+    bus->turnRight();
+    lane.enqueue(new Vehicle(Vehicle::VT_CAR, 2));
+    lane.enqueue(bus);
+    store.addLane(lane, 7, 100);
+    ASSERT(store.count() == 2);
+    ASSERT(store.row(1).type() == Vehicle::VT_BUS);
+    ASSERT(store.row(1).occupantCount() == 40);
+    ASSERT(store.row(1).turnsLeft() == 2);
+    ASSERT(store.row(0).lane() == 7 && store.row(0).entryTick() == 100);
+    store.setLane(0, 8, 101);
+    ASSERT(store.row(0).lane() == 8 && store.row(0).entryTick() == 101);
+
+    // enough rows, with an odd count, to cover both the vector loops and their leftovers
+    for (unsigned int i = 0; i < 1001; i++) {
+        store.add((Vehicle::Type)(i % 3), i * 7919 % 50, i % 5 == 0 ? 0 : i % 23, i, 0);
+    }
+    store.setOccupants(2, 4000000000u);
+    store.setTurnsLeft(3, 0xFFFFFFFFu);
+
+    store.setSimdLevel(FleetStore::SL_SCALAR);
+    ASSERT(store.simdLevel() == FleetStore::SL_SCALAR);
+    unsigned long long occupants[Vehicle::VT_INVALID];
+    for (int t = 0; t < Vehicle::VT_INVALID; t++) {
+        occupants[t] = store.occupantsOf((Vehicle::Type)t);
+    }
+    unsigned int types[Vehicle::VT_INVALID + 1];
+    store.countByType(types);
+    ASSERT(types[Vehicle::VT_CAR] == 335 && types[Vehicle::VT_BUS] == 335 && types[Vehicle::VT_MOTORCYCLE] == 333);
+    ASSERT(types[Vehicle::VT_INVALID] == 0);
+    unsigned int withTurns = store.countWithTurnsLeft();
+    ASSERT(withTurns == 766);
+    unsigned int histogram[40];
+    store.turnsLeftHistogram(histogram, 40);
+    unsigned int shortHistogram[8];
+    store.turnsLeftHistogram(shortHistogram, 8);
+    ASSERT(shortHistogram[0] == 237);
+    ASSERT(histogram[39] == 1);
+
+    // every SIMD level the CPU supports gives the same answers as the plain loops
+    for (int level = FleetStore::SL_SSE2; level <= FleetStore::supportedSimdLevel(); level++) {
+        store.setSimdLevel((FleetStore::SimdLevel)level);
+        for (int t = 0; t < Vehicle::VT_INVALID; t++) {
+            ASSERT(store.occupantsOf((Vehicle::Type)t) == occupants[t]);
+        }
+        unsigned int simdTypes[Vehicle::VT_INVALID + 1];
+        store.countByType(simdTypes);
+        for (int t = 0; t <= Vehicle::VT_INVALID; t++) {
+            ASSERT(simdTypes[t] == types[t]);
+        }
+        ASSERT(store.countWithTurnsLeft() == withTurns);
+        unsigned int simdHistogram[8];
+        store.turnsLeftHistogram(simdHistogram, 8);
+        for (int b = 0; b < 8; b++) {
+            ASSERT(simdHistogram[b] == shortHistogram[b]);
+        }
+    }
 
+    store.clear();
+    ASSERT(store.count() == 0 && store.countWithTurnsLeft() == 0);
     return TR_PASS;
 }
 
-// made by hamish
-TestResult test_TrafficNetwork() {
+TestResult test_LatencyHistogram() {
+    LatencyHistogram histogram;
+    ASSERT(histogram.count() == 0);
+    ASSERT(histogram.p50() == 0 && histogram.max() == 0);
 
-	Intersection i1, i2, i3, i4;
-	Lane *lanes[12];
-	for (int i=0; i<12; i++) lanes[i] = new ExpressLane();
+    // short durations are recorded exactly
+    for (unsigned int i = 1; i <= 10; i++) {
+        histogram.record(i);
+    }
+    ASSERT(histogram.count() == 10);
+    ASSERT(histogram.p50() == 5);
+    ASSERT(histogram.percentile(1.0) == 10);
+    ASSERT(histogram.percentile(0.0) == 1);
+    ASSERT(histogram.mean() == 5.5);
+
+    // long durations are reported within 1/16 of the true value
+    LatencyHistogram spread;
+    for (unsigned int i = 1; i <= 100000; i++) {
+        spread.record(i);
+    }
+    unsigned int p50 = spread.p50();
+    unsigned int p99 = spread.p99();
+    unsigned int p999 = spread.p999();
+    ASSERT(p50 >= 50000 && p50 <= 50000 + 50000 / 16);
+    ASSERT(p99 >= 99000 && p99 <= 99000 + 99000 / 16);
+    ASSERT(p999 >= 99900 && p999 <= 100000);
+    ASSERT(spread.max() == 100000);
+    spread.record(0xFFFFFFFFu);
+    ASSERT(spread.percentile(1.0) == 0xFFFFFFFFu);
+
+    histogram.merge(spread);
+    ASSERT(histogram.count() == 100011);
+    histogram.reset();
+    ASSERT(histogram.count() == 0 && histogram.max() == 0);
+    return TR_PASS;
+}
 
-	i1.connectNorth(lanes[0], Intersection::LD_INCOMING);
-	i1.connectEast(lanes[3], Intersection::LD_OUTGOING);
-	i1.connectSouth(lanes[5], Intersection::LD_INCOMING);
-	i1.connectWest(lanes[2], Intersection::LD_INCOMING);
+#endif /*ENABLE_T1_TESTS*/
 
-	i2.connectNorth(lanes[1], Intersection::LD_INCOMING);
-	i2.connectEast(lanes[4], Intersection::LD_OUTGOING);
-	i2.connectSouth(lanes[6], Intersection::LD_OUTGOING);
-	i2.connectWest(lanes[3], Intersection::LD_INCOMING);
+#ifdef ENABLE_T2_TESTS
+/*
+Test Intersection construction and initial state.
+*/
+TestResult test_IntersectionConstruction() {
+    Intersection* intersection = new Intersection();
+    // check the intersection is initially invalid
+    ASSERT(!intersection->valid());
+    // invoke the destructor (if any)
+    delete intersection;
 
-	i3.connectNorth(lanes[6], Intersection::LD_INCOMING);
-	i3.connectEast(lanes[9], Intersection::LD_OUTGOING);
-	i3.connectSouth(lanes[11], Intersection::LD_OUTGOING);
-	i3.connectWest(lanes[8], Intersection::LD_OUTGOING);
+    return TR_PASS;
+}
 
-	i4.connectNorth(lanes[5], Intersection::LD_OUTGOING);
-	i4.connectEast(lanes[8], Intersection::LD_INCOMING);
-	i4.connectSouth(lanes[10], Intersection::LD_OUTGOING);
-	i4.connectWest(lanes[7], Intersection::LD_INCOMING);
+/*
+Test intersection Lane overwriting behavior; i.e. when a new Lane is assigned in a position already occupied by another
+Lane connected to the Intersection.
+*/
+TestResult test_IntersectionOverwrite() {
+    Intersection intersection;
 
-	/* Test with a single car to go around the loop */
+    Lane* l1 = new SimpleLane();
+    Lane* l2 = new SimpleLane();
+    Lane* l3 = new SimpleLane();
+    Lane* l4 = new SimpleLane();
+    Lane* l5 = new SimpleLane();
 
-	Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
-	v1->turnLeft();
-	v1->turnRight();
-	v1->turnRight();
-	v1->turnRight();
-	v1->turnRight();
-	v1->turnStraight();
-	lanes[0]->enqueue(v1);
+    // connect first lanes
+    ASSERT(intersection.connectNorth(l1, Intersection::LD_INCOMING) == 0);
+    ASSERT(!intersection.valid());
+    ASSERT(intersection.connectEast(l2, Intersection::LD_OUTGOING) == 0);
+    ASSERT(!intersection.valid());
+    ASSERT(intersection.connectSouth(l3, Intersection::LD_INCOMING) == 0);
+    ASSERT(!intersection.valid());
+    ASSERT(intersection.connectWest(l4, Intersection::LD_OUTGOING) == 0);
+    ASSERT(intersection.valid());
 
-	i1.simulate();
-	i2.simulate();
-	i3.simulate();
-	i4.simulate();
-	i1.simulate();
-	i2.simulate();
+    // assign a new lane for each direction
+    ASSERT(intersection.connectNorth(l5, Intersection::LD_INCOMING) == l1);
+    ASSERT(intersection.valid());
+    ASSERT(intersection.connectEast(l5, Intersection::LD_OUTGOING) == l2);
+    ASSERT(intersection.valid());
+    ASSERT(intersection.connectSouth(l5, Intersection::LD_INCOMING) == l3);
+    ASSERT(intersection.valid());
+    ASSERT(intersection.connectWest(l5, Intersection::LD_OUTGOING) == l4);
+    ASSERT(intersection.valid());
 
-	for (int i=0; i<12; i++) {
-		ASSERT(i == 4 || lanes[i]->dequeue() == 0);
-	}
-	ASSERT(lanes[4]->dequeue() == v1);
-	ASSERT(v1->nextTurn() == Vehicle::TD_INVALID);
+    // de-assign all lanes
+    ASSERT(intersection.connectNorth(0, Intersection::LD_INCOMING) == l5);
+    ASSERT(!intersection.valid());
+    ASSERT(intersection.connectEast(0, Intersection::LD_OUTGOING) == l5);
+    ASSERT(!intersection.valid());
+    ASSERT(intersection.connectSouth(0, Intersection::LD_INCOMING) == l5);
+    ASSERT(!intersection.valid());
+    ASSERT(intersection.connectWest(0, Intersection::LD_OUTGOING) == l5);
+    ASSERT(!intersection.valid());
 
-	delete v1;
-	for (int i=0; i<12; i++) delete lanes[i];
+    delete l1;
+    delete l2;
+    delete l3;
+    delete l4;
+    delete l5;
 
-	return TR_PASS;
+    return TR_PASS;
 }
 
-// from piazza @418
-TestResult test_TrafficNetwork2() {
-    Intersection i0;
-    Intersection i1;
-    Intersection i2;
-    Intersection i3;
+/*
+Test an intersection with four Lanes attached, one incoming and three outgoing. This should be the simplest intersection
+it is possible to create; no give way rules have to be applied. Only tested using the SimpleLane class, so motorcycle
+filtering behavior shouldn't affect this test.
+*/
+TestResult test_IntersectionOneIn() {
+    Intersection intersection;
 
+    // vehicles for testing
     Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
     v1->turnLeft();
-    v1->turnStraight();
     Vehicle* v2 = new Vehicle(Vehicle::VT_BUS, 10);
-    v2->turnStraight();
     v2->turnRight();
-    v2->turnLeft();
     Vehicle* v3 = new Vehicle(Vehicle::VT_CAR, 1);
     v3->turnStraight();
-    v3->turnRight();
-    v3->turnLeft();
     Vehicle* v4 = new Vehicle(Vehicle::VT_MOTORCYCLE, 2);
     v4->turnLeft();
     v4->turnRight();
-    v4->turnRight();
-    v4->turnRight();
-    v4->turnRight();
-    v4->turnRight();
-    v4->turnRight();
-    v4->turnStraight();
-
-    Lane* lanes[12];
-    for (int i=0;i<12;i++) {
-    	lanes[i] = new SimpleLane();
-    }
 
-    lanes[0]->enqueue(v1);
-    lanes[1]->enqueue(v2);
-    lanes[2]->enqueue(v3);
-    lanes[7]->enqueue(v4);
+    // create the RoadWays
+    Lane* roadIn = new SimpleLane();
+    roadIn->enqueue(v1);
+    roadIn->enqueue(v2);
+    roadIn->enqueue(v3);
+    roadIn->enqueue(v4);
 
-    i0.connectNorth(lanes[0], Intersection::LD_INCOMING);
-    i0.connectEast(lanes[3], Intersection::LD_OUTGOING);
-    i0.connectSouth(lanes[5], Intersection::LD_INCOMING);
-    i0.connectWest(lanes[2], Intersection::LD_INCOMING);
-    i1.connectNorth(lanes[1], Intersection::LD_INCOMING);
-    i1.connectEast(lanes[4], Intersection::LD_OUTGOING);
-    i1.connectSouth(lanes[6], Intersection::LD_OUTGOING);
-    i1.connectWest(lanes[3], Intersection::LD_INCOMING);
-    i2.connectNorth(lanes[5], Intersection::LD_OUTGOING);
-    i2.connectEast(lanes[8], Intersection::LD_INCOMING);
-    i2.connectSouth(lanes[10], Intersection::LD_OUTGOING);
-    i2.connectWest(lanes[7], Intersection::LD_INCOMING);
-    i3.connectNorth(lanes[6], Intersection::LD_INCOMING);
-    i3.connectEast(lanes[9], Intersection::LD_OUTGOING);
-    i3.connectSouth(lanes[11], Intersection::LD_OUTGOING);
-    i3.connectWest(lanes[8], Intersection::LD_OUTGOING);
+    Lane* roadLeft = new SimpleLane();
+    Lane* roadStraight = new SimpleLane();
+    Lane* roadRight = new SimpleLane();
 
-    ASSERT(i0.valid());
-    ASSERT(i1.valid());
-    ASSERT(i2.valid());
-    ASSERT(i3.valid());
+    // add RoadWays to the Intersection
+    ASSERT(intersection.connectNorth(roadIn, Intersection::LD_INCOMING) == 0); // entry
+    ASSERT(intersection.connectEast(roadLeft, Intersection::LD_OUTGOING) == 0); // exit left
+    ASSERT(intersection.connectSouth(roadStraight, Intersection::LD_OUTGOING) == 0); // exit straight
+    ASSERT(intersection.connectWest(roadRight, Intersection::LD_OUTGOING) == 0); // exit right
+    // check intersection is valid
+    ASSERT(intersection.valid());
 
-    i0.simulate();
-    i1.simulate();
-    i3.simulate();
-    i2.simulate();
-    ASSERT(lanes[0]->front() == v1);
-    ASSERT(lanes[10]->front() == v2);
-    ASSERT(lanes[3]->front() == v3);
-    ASSERT(lanes[5]->front() == v4);
+    // simulate a single tick
+    intersection.simulate();
+    // check results (only one vehicle should proceed)
+    ASSERT(roadIn->front() == v2);
+    ASSERT(roadLeft->front() == v1);
+    ASSERT(roadRight->empty());
+    ASSERT(roadStraight->empty());
 
-    i0.simulate();
-    i1.simulate();
-    i3.simulate();
-    i2.simulate();
-    ASSERT(lanes[3]->front() == v1);
-    ASSERT(lanes[10]->front() == v2);
-    ASSERT(lanes[9]->front() == v3);
-    ASSERT(lanes[5]->front() == v4);
+    // run the simulation for 3 more ticks to allow the other vehicles to proceed
+    for (int i = 0; i < 3; ++i) {
+        intersection.simulate();
+    }
 
-    i0.simulate();
-    i1.simulate();
-    i3.simulate();
-    i2.simulate();
-    ASSERT(lanes[4]->front() == v1);
-    ASSERT(lanes[10]->front() == v2);
-    ASSERT(lanes[9]->front() == v3);
-    ASSERT(lanes[3]->front() == v4)
+    // check all vehicles passed through the intersection successfully
+    ASSERT(roadIn->front() == 0);
+    ASSERT(roadLeft->dequeue() == v1);
+    ASSERT(roadLeft->dequeue() == v4);
+    ASSERT(roadLeft->front() == 0);
+    ASSERT(roadStraight->dequeue() == v3);
+    ASSERT(roadStraight->front() == 0);
+    ASSERT(roadRight->dequeue() == v2);
+    ASSERT(roadRight->front() == 0);
 
-    i0.simulate();
+    delete roadIn;
+    delete roadLeft;
+    delete roadStraight;
+    delete roadRight;
+
+    delete v1;
+    delete v2;
+    delete v3;
+    delete v4;
+
+    return TR_PASS;
+}
+
+/*
+Test an intersection with four Lanes attached, two incoming and two outgoing, arranged so that Lanes attached to the
+intersection in the same direction (e.g. incoming) are directly opposite each other.
+*/
+TestResult test_IntersectionTwoInOpposing() {
+    Intersection intersection;
+
+    // vehicles for testing
+    Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
+    v1->turnLeft();
+    Vehicle* v2 = new Vehicle(Vehicle::VT_BUS, 10);
+    v2->turnRight();
+    Vehicle* v3 = new Vehicle(Vehicle::VT_CAR, 1);
+    v3->turnRight();
+    Vehicle* v4 = new Vehicle(Vehicle::VT_MOTORCYCLE, 2);
+    v4->turnLeft();
+    v4->turnRight();
+    Vehicle* v5 = new Vehicle(Vehicle::VT_CAR, 3);
+    v5->turnRight();
+    Vehicle* v6 = new Vehicle(Vehicle::VT_CAR, 2);
+    v6->turnRight();
+    v6->turnLeft();
+    Vehicle* v7 = new Vehicle(Vehicle::VT_BUS, 8);
+    v7->turnRight();
+    Vehicle* v8 = new Vehicle(Vehicle::VT_MOTORCYCLE, 1);
+    v8->turnLeft();
+
+    // create the Lanes
+    Lane* roadInNorth = new SimpleLane();
+    roadInNorth->enqueue(v1);
+    roadInNorth->enqueue(v2);
+    roadInNorth->enqueue(v3);
+    roadInNorth->enqueue(v4);
+
+    Lane* roadInSouth = new SimpleLane();
+    roadInSouth->enqueue(v5);
+    roadInSouth->enqueue(v6);
+    roadInSouth->enqueue(v7);
+    roadInSouth->enqueue(v8);
+
+    Lane* roadOutEast = new SimpleLane();
+    Lane* roadOutWest = new SimpleLane();
+
+    // add Lanes to the Intersection
+    ASSERT(intersection.connectNorth(roadInNorth, Intersection::LD_INCOMING) == 0); // entry
+    ASSERT(intersection.connectEast(roadOutEast, Intersection::LD_OUTGOING) == 0); // exit
+    ASSERT(intersection.connectSouth(roadInSouth, Intersection::LD_INCOMING) == 0); // entry
+    ASSERT(intersection.connectWest(roadOutWest, Intersection::LD_OUTGOING) == 0); // exit
+    // check intersection is valid
+    ASSERT(intersection.valid());
+
+    // simulate a single tick
+    intersection.simulate();
+    // check results (exactly one vehicle should proceed)
+    ASSERT(roadInNorth->front() == v2);
+    ASSERT(roadOutEast->front() == v1);
+    ASSERT(roadInSouth->front() == v5);
+    ASSERT(roadOutWest->front() == 0);
+
+    // run the simulation for 5 more ticks to allow the other vehicles to proceed (should be enough if road rules are
+    // followed)
+    for (int i = 0; i < 5; ++i) {
+        intersection.simulate();
+    }
+
+    // check all vehicles passed through the intersection successfully
+    // check inbound lanes
+    ASSERT(roadInNorth->front() == 0);
+    ASSERT(roadInSouth->front() == 0);
+    // check eastbound out lane
+    ASSERT(roadOutEast->dequeue() == v1);
+    ASSERT(roadOutEast->dequeue() == v5);
+    ASSERT(roadOutEast->dequeue() == v6);
+    ASSERT(roadOutEast->dequeue() == v4);
+    ASSERT(roadOutEast->dequeue() == v7);
+    ASSERT(roadOutEast->dequeue() == 0);
+    // check westbound out lane
+    ASSERT(roadOutWest->dequeue() == v2);
+    ASSERT(roadOutWest->dequeue() == v3);
+    ASSERT(roadOutWest->dequeue() == v8);
+    ASSERT(roadOutWest->dequeue() == 0);
+
+    delete roadInNorth;
+    delete roadOutEast;
+    delete roadInSouth;
+    delete roadOutWest;
+
+    delete v1;
+    delete v2;
+    delete v3;
+    delete v4;
+    delete v5;
+    delete v6;
+    delete v7;
+    delete v8;
+
+    return TR_PASS;
+}
+
+// from piazza @418
+TestResult test_IntersectionTwoInAdjacent() {
+    Intersection intersection;
+
+    // vehicles for testing
+    Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
+    v1->turnStraight();
+    Vehicle* v2 = new Vehicle(Vehicle::VT_BUS, 10);
+    v2->turnLeft();
+    Vehicle* v3 = new Vehicle(Vehicle::VT_CAR, 1);
+    v3->turnStraight();
+    Vehicle* v4 = new Vehicle(Vehicle::VT_MOTORCYCLE, 2);
+    v4->turnLeft();
+    Vehicle* v5 = new Vehicle(Vehicle::VT_CAR, 3);
+    v5->turnStraight();
+    Vehicle* v6 = new Vehicle(Vehicle::VT_CAR, 2);
+    v6->turnStraight();
+    Vehicle* v7 = new Vehicle(Vehicle::VT_BUS, 8);
+    v7->turnRight();
+    Vehicle* v8 = new Vehicle(Vehicle::VT_MOTORCYCLE, 1);
+    v8->turnStraight();
+
+    // create the Lanes
+    Lane* roadInSouth = new SimpleLane();
+    roadInSouth->enqueue(v1);
+    roadInSouth->enqueue(v2);
+    roadInSouth->enqueue(v3);
+    roadInSouth->enqueue(v4);
+
+    Lane* roadInEast = new SimpleLane();
+    roadInEast->enqueue(v5);
+    roadInEast->enqueue(v6);
+    roadInEast->enqueue(v7);
+    roadInEast->enqueue(v8);
+
+    Lane* roadOutNorth = new SimpleLane();
+    Lane* roadOutWest = new SimpleLane();
+
+    // add Lanes to the Intersection
+    ASSERT(intersection.connectNorth(roadOutNorth, Intersection::LD_OUTGOING) == 0); // exit
+    ASSERT(intersection.connectEast(roadInEast, Intersection::LD_INCOMING) == 0); // entry
+    ASSERT(intersection.connectSouth(roadInSouth, Intersection::LD_INCOMING) == 0); // entry
+    ASSERT(intersection.connectWest(roadOutWest, Intersection::LD_OUTGOING) == 0); // exit
+    // check intersection is valid
+    ASSERT(intersection.valid());
+
+    // simulate a single tick
+    intersection.simulate();
+    // check results (exactly one vehicle should proceed)
+    ASSERT(roadInSouth->front() == v2);
+    ASSERT(roadInEast->front() == v6);
+    ASSERT(roadOutNorth->front() == v1);
+    ASSERT(roadOutWest->front() == v5);
+
+
+    // run the simulation for 7 more ticks to allow the other vehicles to proceed (should be enough if road rules are
+    // followed)
+    for (int i = 0; i < 8; ++i) {
+        intersection.simulate();
+    }
+
+    // check all vehicles passed through the intersection successfully
+    // check inbound lanes
+    ASSERT(roadInEast->front() == 0);
+    ASSERT(roadInSouth->front() == 0);
+    // check northbound out lane
+    ASSERT(roadOutNorth->dequeue() == v1);
+    ASSERT(roadOutNorth->dequeue() == v3);
+    ASSERT(roadOutNorth->dequeue() == v7);
+    ASSERT(roadOutNorth->dequeue() == 0);
+    // check westbound out lane
+    ASSERT(roadOutWest->dequeue() == v5);
+    ASSERT(roadOutWest->dequeue() == v6);
+    ASSERT(roadOutWest->dequeue() == v2);
+    ASSERT(roadOutWest->dequeue() == v4);
+    ASSERT(roadOutWest->dequeue() == v8);
+    ASSERT(roadOutWest->dequeue() == 0);
+
+    delete roadInEast;
+    delete roadOutNorth;
+    delete roadInSouth;
+    delete roadOutWest;
+
+    delete v1;
+    delete v2;
+    delete v3;
+    delete v4;
+    delete v5;
+    delete v6;
+    delete v7;
+    delete v8;
+
+    return TR_PASS;
+}
+
+// from piazza @418, modified by hamish
+TestResult test_IntersectionThreeIn() {
+    Intersection intersection;
+
+    // vehicles for testing
+    Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
+    v1->turnLeft();
+    Vehicle* v2 = new Vehicle(Vehicle::VT_BUS, 10);
+    v2->turnLeft();
+    Vehicle* v3 = new Vehicle(Vehicle::VT_CAR, 1);
+    v3->turnLeft();
+    Vehicle* v4 = new Vehicle(Vehicle::VT_MOTORCYCLE, 2);
+    v4->turnStraight();
+    Vehicle* v5 = new Vehicle(Vehicle::VT_CAR, 3);
+    v5->turnStraight();
+    Vehicle* v6 = new Vehicle(Vehicle::VT_CAR, 2);
+    v6->turnStraight();
+    Vehicle* v7 = new Vehicle(Vehicle::VT_BUS, 8);
+    v7->turnRight();
+    Vehicle* v8 = new Vehicle(Vehicle::VT_MOTORCYCLE, 1);
+    v8->turnRight();
+    Vehicle* v9 = new Vehicle(Vehicle::VT_MOTORCYCLE, 1);
+    v9->turnRight();
+
+    // create the Lanes
+    Lane* roadInSouth = new SimpleLane();
+    roadInSouth->enqueue(v1);
+    roadInSouth->enqueue(v2);
+    roadInSouth->enqueue(v3);
+
+    Lane* roadInEast = new SimpleLane();
+    roadInEast->enqueue(v4);
+    roadInEast->enqueue(v5);
+    roadInEast->enqueue(v6);
+
+    Lane* roadInNorth = new SimpleLane();
+    roadInNorth->enqueue(v7);
+    roadInNorth->enqueue(v8);
+    roadInNorth->enqueue(v9);
+
+    Lane* roadOutWest = new SimpleLane();
+
+    // add Lanes to the Intersection
+    ASSERT(intersection.connectNorth(roadInNorth, Intersection::LD_INCOMING) == 0); // entry
+    ASSERT(intersection.connectEast(roadInEast, Intersection::LD_INCOMING) == 0); // entry
+    ASSERT(intersection.connectSouth(roadInSouth, Intersection::LD_INCOMING) == 0); // entry
+    ASSERT(intersection.connectWest(roadOutWest, Intersection::LD_OUTGOING) == 0); // exit
+    // check intersection is valid
+    ASSERT(intersection.valid());
+
+    // simulate a single tick
+    intersection.simulate();
+    // check results (exactly one vehicle should proceed)
+    ASSERT(roadInSouth->front() == v1);
+    ASSERT(roadInEast->front() == v5);
+    ASSERT(roadInNorth->front() == v7);
+    ASSERT(roadOutWest->front() == v4);
+
+    // run the simulation for 9 more ticks to allow the other vehicles to proceed (should be enough if road rules are
+    // followed)
+    for (int i = 0; i < 9; ++i) {
+        intersection.simulate();
+    }
+
+    // check all vehicles passed through the intersection successfully
+    // check inbound lanes
+    ASSERT(roadInEast->front() == 0);
+    ASSERT(roadInSouth->front() == 0);
+    ASSERT(roadInNorth->front() == 0);
+    // check westbound out lane
+    ASSERT(roadOutWest->dequeue() == v4);
+    ASSERT(roadOutWest->dequeue() == v5);
+    ASSERT(roadOutWest->dequeue() == v6);
+    ASSERT(roadOutWest->dequeue() == v1);
+    ASSERT(roadOutWest->dequeue() == v2);
+    ASSERT(roadOutWest->dequeue() == v3);
+    ASSERT(roadOutWest->dequeue() == v7);
+    ASSERT(roadOutWest->dequeue() == v8);
+    ASSERT(roadOutWest->dequeue() == v9);
+    ASSERT(roadOutWest->dequeue() == 0);
+
+    delete roadInEast;
+    delete roadInNorth;
+    delete roadInSouth;
+    delete roadOutWest;
+
+    delete v1;
+    delete v2;
+    delete v3;
+    delete v4;
+    delete v5;
+    delete v6;
+    delete v7;
+    delete v8;
+    delete v9;
+
+    return TR_PASS;
+}
+
+// made by hamish
+TestResult test_TrafficNetwork() {
+
+	Intersection i1, i2, i3, i4;
+	Lane *lanes[12];
+	for (int i=0; i<12; i++) lanes[i] = new ExpressLane();
+
+	i1.connectNorth(lanes[0], Intersection::LD_INCOMING);
+	i1.connectEast(lanes[3], Intersection::LD_OUTGOING);
+	i1.connectSouth(lanes[5], Intersection::LD_INCOMING);
+	i1.connectWest(lanes[2], Intersection::LD_INCOMING);
+
+	i2.connectNorth(lanes[1], Intersection::LD_INCOMING);
+	i2.connectEast(lanes[4], Intersection::LD_OUTGOING);
+	i2.connectSouth(lanes[6], Intersection::LD_OUTGOING);
+	i2.connectWest(lanes[3], Intersection::LD_INCOMING);
+
+	i3.connectNorth(lanes[6], Intersection::LD_INCOMING);
+	i3.connectEast(lanes[9], Intersection::LD_OUTGOING);
+	i3.connectSouth(lanes[11], Intersection::LD_OUTGOING);
+	i3.connectWest(lanes[8], Intersection::LD_OUTGOING);
+
+	i4.connectNorth(lanes[5], Intersection::LD_OUTGOING);
+	i4.connectEast(lanes[8], Intersection::LD_INCOMING);
+	i4.connectSouth(lanes[10], Intersection::LD_OUTGOING);
+	i4.connectWest(lanes[7], Intersection::LD_INCOMING);
+
+	/* Test with a single car to go around the loop */
+
+	Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
+	v1->turnLeft();
+	v1->turnRight();
+	v1->turnRight();
+	v1->turnRight();
+	v1->turnRight();
+	v1->turnStraight();
+	lanes[0]->enqueue(v1);
+
+	i1.simulate();
+	i2.simulate();
+	i3.simulate();
+	i4.simulate();
+	i1.simulate();
+	i2.simulate();
+
+	for (int i=0; i<12; i++) {
+		ASSERT(i == 4 || lanes[i]->dequeue() == 0);
+	}
+	ASSERT(lanes[4]->dequeue() == v1);
+	ASSERT(v1->nextTurn() == Vehicle::TD_INVALID);
+
+	delete v1;
+	for (int i=0; i<12; i++) delete lanes[i];
+
+	return TR_PASS;
+}
+
+// from piazza @418
+TestResult test_TrafficNetwork2() {
+    Intersection i0;
+    Intersection i1;
+    Intersection i2;
+    Intersection i3;
+
+    Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
+    v1->turnLeft();
+    v1->turnStraight();
+    Vehicle* v2 = new Vehicle(Vehicle::VT_BUS, 10);
+    v2->turnStraight();
+    v2->turnRight();
+    v2->turnLeft();
+    Vehicle* v3 = new Vehicle(Vehicle::VT_CAR, 1);
+    v3->turnStraight();
+    v3->turnRight();
+    v3->turnLeft();
+    Vehicle* v4 = new Vehicle(Vehicle::VT_MOTORCYCLE, 2);
+    v4->turnLeft();
+    v4->turnRight();
+    v4->turnRight();
+    v4->turnRight();
+    v4->turnRight();
+    v4->turnRight();
+    v4->turnRight();
+    v4->turnStraight();
+
+    Lane* lanes[12];
+    for (int i=0;i<12;i++) {
+    	lanes[i] = new SimpleLane();
+    }
+
+    lanes[0]->enqueue(v1);
+    lanes[1]->enqueue(v2);
+    lanes[2]->enqueue(v3);
+    lanes[7]->enqueue(v4);
+
+    i0.connectNorth(lanes[0], Intersection::LD_INCOMING);
+    i0.connectEast(lanes[3], Intersection::LD_OUTGOING);
+    i0.connectSouth(lanes[5], Intersection::LD_INCOMING);
+    i0.connectWest(lanes[2], Intersection::LD_INCOMING);
+    i1.connectNorth(lanes[1], Intersection::LD_INCOMING);
+    i1.connectEast(lanes[4], Intersection::LD_OUTGOING);
+    i1.connectSouth(lanes[6], Intersection::LD_OUTGOING);
+    i1.connectWest(lanes[3], Intersection::LD_INCOMING);
+    i2.connectNorth(lanes[5], Intersection::LD_OUTGOING);
+    i2.connectEast(lanes[8], Intersection::LD_INCOMING);
+    i2.connectSouth(lanes[10], Intersection::LD_OUTGOING);
+    i2.connectWest(lanes[7], Intersection::LD_INCOMING);
+    i3.connectNorth(lanes[6], Intersection::LD_INCOMING);
+    i3.connectEast(lanes[9], Intersection::LD_OUTGOING);
+    i3.connectSouth(lanes[11], Intersection::LD_OUTGOING);
+    i3.connectWest(lanes[8], Intersection::LD_OUTGOING);
+
+    ASSERT(i0.valid());
+    ASSERT(i1.valid());
+    ASSERT(i2.valid());
+    ASSERT(i3.valid());
+
+    i0.simulate();
+    i1.simulate();
+    i3.simulate();
+    i2.simulate();
+    ASSERT(lanes[0]->front() == v1);
+    ASSERT(lanes[10]->front() == v2);
+    ASSERT(lanes[3]->front() == v3);
+    ASSERT(lanes[5]->front() == v4);
+
+    i0.simulate();
+    i1.simulate();
+    i3.simulate();
+    i2.simulate();
+    ASSERT(lanes[3]->front() == v1);
+    ASSERT(lanes[10]->front() == v2);
+    ASSERT(lanes[9]->front() == v3);
+    ASSERT(lanes[5]->front() == v4);
+
+    i0.simulate();
+    i1.simulate();
+    i3.simulate();
+    i2.simulate();
+    ASSERT(lanes[4]->front() == v1);
+    ASSERT(lanes[10]->front() == v2);
+    ASSERT(lanes[9]->front() == v3);
+    ASSERT(lanes[3]->front() == v4)
+
+    i0.simulate();
     i1.simulate();
     i3.simulate();
     i2.simulate();
@@ -1058,188 +2153,1402 @@ TestResult test_TrafficNetwork2() {
     ASSERT(lanes[9]->front() == v3);
     ASSERT(lanes[11]->front() == v4)
 
-    for (int i=0;i<12;i++) {
-    	delete lanes[i];
+    for (int i=0;i<12;i++) {
+    	delete lanes[i];
+    }
+
+    return TR_PASS;
+}
+
+// from piazza @301, modified by hamish
+TestResult test_Intersections(){
+
+	// Create Intersections
+
+	Intersection intersection1;
+	Intersection intersection2;
+	Intersection intersection3;
+	Intersection intersection4;
+
+	Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
+	v1->turnStraight();
+	v1->turnLeft();
+	Vehicle* v2 = new Vehicle(Vehicle::VT_BUS, 10);
+	v2->turnStraight();
+	v2->turnStraight();
+	Vehicle* v3 = new Vehicle(Vehicle::VT_CAR, 1);
+	v3->turnLeft();
+	v3->turnRight();
+	v3->turnStraight();
+	Vehicle* v4 = new Vehicle(Vehicle::VT_CAR, 1);
+	v4->turnStraight();
+	v4->turnLeft();
+
+	// Creating first intersection
+
+	Lane* North1 = new SimpleLane();
+	North1->enqueue(v2);
+	Lane* West1 = new SimpleLane();
+	West1->enqueue(v1);
+	Lane* roadTop = new SimpleLane();
+	Lane* roadLeft = new SimpleLane();
+
+
+	ASSERT(intersection1.connectNorth(North1, Intersection::LD_INCOMING) == 0);
+	ASSERT(intersection1.connectEast(roadTop, Intersection::LD_OUTGOING) == 0);
+	ASSERT(intersection1.connectSouth(roadLeft, Intersection::LD_OUTGOING) == 0);
+	ASSERT(intersection1.connectWest(West1, Intersection::LD_INCOMING) == 0);
+
+	// Creating second intersection
+
+	Lane* North2 = new SimpleLane();
+	Lane* East2 = new SimpleLane();
+	East2->enqueue(v3);
+	Lane* roadRight = new SimpleLane();
+
+	ASSERT(intersection2.connectNorth(North2, Intersection::LD_OUTGOING) == 0);
+	ASSERT(intersection2.connectEast(East2, Intersection::LD_INCOMING) == 0);
+	ASSERT(intersection2.connectSouth(roadRight, Intersection::LD_OUTGOING) == 0);
+	ASSERT(intersection2.connectWest(roadTop, Intersection::LD_INCOMING) == 0);
+
+
+	// Creating third intersection
+
+	Lane* South3 = new SimpleLane();
+	Lane* East3= new SimpleLane();
+	East3->enqueue(v4);
+	Lane* roadBot = new SimpleLane();
+
+	ASSERT(intersection3.connectNorth(roadRight, Intersection::LD_INCOMING) == 0);
+	ASSERT(intersection3.connectEast(East3, Intersection::LD_INCOMING) == 0);
+	ASSERT(intersection3.connectSouth(South3, Intersection::LD_OUTGOING) == 0);
+	ASSERT(intersection3.connectWest(roadBot, Intersection::LD_OUTGOING) == 0);
+
+	// Creating fourth intersection
+
+	Lane* South4 = new SimpleLane();
+	Lane* West4 = new SimpleLane();
+
+	ASSERT(intersection4.connectNorth(roadLeft, Intersection::LD_INCOMING) == 0);
+	ASSERT(intersection4.connectEast(roadBot, Intersection::LD_INCOMING) == 0);
+	ASSERT(intersection4.connectSouth(South4, Intersection::LD_OUTGOING) == 0);
+	ASSERT(intersection4.connectWest(West4, Intersection::LD_OUTGOING) == 0);
+
+	//cout << "Intersections Created" << endl;
+	//cout << "Time to simulate" << endl;
+
+	intersection1.simulate();
+	ASSERT(North1->front() == 0);
+	ASSERT(West1->front() == 0);
+	ASSERT(roadTop->back() == v1);
+	ASSERT(roadLeft->back() == v2);
+
+
+	intersection2.simulate();
+	ASSERT(North2->back() == v1);
+	ASSERT(East2->front() == 0);
+	ASSERT(roadRight->back() == v3);
+	ASSERT(roadTop->back() == 0);
+
+
+	 for (int i=0; i<2; i++){
+		 intersection3.simulate();
+	 }
+
+	 ASSERT(roadRight->back() == 0);
+	ASSERT(East3->back() == 0);
+	ASSERT(roadBot->back() == v3);
+	ASSERT(roadBot->front() == v4);
+	ASSERT(South3->back() == 0);
+
+
+	 for (int i=0; i<3; i++){
+		 intersection4.simulate();
+	 }
+
+	 ASSERT(roadLeft->back() == 0);
+	 ASSERT(roadBot->back() == 0);
+	 ASSERT(South4->front() == v2);
+	 ASSERT(South4->back() == v4);
+	 ASSERT(West4->back() == v3);
+
+	//cout << "THe Largest Case has been passed" << endl;
+
+	delete North1;
+	delete West1;
+	delete roadTop;
+	delete roadLeft;
+	delete North2;
+	delete East2;
+	delete roadRight;
+	delete South3;
+	delete East3;
+	delete roadBot;
+	delete South4;
+	delete West4;
+
+	return TR_PASS;
+}
+
+//from piazza @376
+TestResult test_The_Filip_Simulate() {
+	Intersection intersection;
+	// vehicles for testing
+	Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
+	v1->turnStraight();//v1 turns straight
+	Vehicle* v2 = new Vehicle(Vehicle::VT_CAR, 10);
+	v2->turnLeft();//v2 turns left
+	Vehicle* v3 = new Vehicle(Vehicle::VT_CAR, 1);
+	v3->turnRight();//v3 turns right
+	Lane* roadInNorth = new SimpleLane();
+	roadInNorth->enqueue(v1);//v1 should be in north
+	Lane* roadInWest = new SimpleLane();
+	roadInWest->enqueue(v3);//v3 should be in west
+	Lane* roadInEast = new SimpleLane();
+	roadInEast->enqueue(v2);//v2 should be in east
+	Lane* roadOutSouth = new SimpleLane();
+
+	ASSERT(intersection.connectNorth(roadInNorth, Intersection::LD_INCOMING) == 0); // entry
+	ASSERT(intersection.connectEast(roadInEast, Intersection::LD_INCOMING) == 0); // entry
+	ASSERT(intersection.connectSouth(roadOutSouth, Intersection::LD_OUTGOING) == 0); // exit
+	ASSERT(intersection.connectWest(roadInWest, Intersection::LD_INCOMING) == 0); // entry
+	// check intersection is valid
+	ASSERT(intersection.valid());
+	//simulate and check results
+	intersection.simulate();
+	ASSERT(roadInNorth->front() == 0);
+	//simulate and check results
+	intersection.simulate();
+	ASSERT(roadInEast->front() == 0);
+	//simulate and run
+	intersection.simulate();
+	ASSERT(roadInWest->front() == 0);
+	ASSERT(roadOutSouth->front() == v1);
+	ASSERT(roadOutSouth->dequeue() == v1);
+	ASSERT(roadOutSouth->dequeue() == v2);
+	ASSERT(roadOutSouth->dequeue() == v3);
+	delete roadInNorth;
+	delete roadInEast;
+	delete roadOutSouth;
+	delete roadInWest;
+	delete v1;
+	delete v2;
+	delete v3;
+	return TR_PASS;
+}
+
+/*
+Test an intersection built over a concrete lane type, using the network from test_TrafficNetwork.
+*/
+TestResult test_StaticIntersectionNetwork() {
+	BasicIntersection<ExpressLane> i1, i2, i3, i4;
+	ExpressLane lanes[12];
+
+	i1.connectNorth(&lanes[0], Intersection::LD_INCOMING);
+	i1.connectEast(&lanes[3], Intersection::LD_OUTGOING);
+	i1.connectSouth(&lanes[5], Intersection::LD_INCOMING);
+	i1.connectWest(&lanes[2], Intersection::LD_INCOMING);
+
+	i2.connectNorth(&lanes[1], Intersection::LD_INCOMING);
+	i2.connectEast(&lanes[4], Intersection::LD_OUTGOING);
+	i2.connectSouth(&lanes[6], Intersection::LD_OUTGOING);
+	i2.connectWest(&lanes[3], Intersection::LD_INCOMING);
+
+	i3.connectNorth(&lanes[6], Intersection::LD_INCOMING);
+	i3.connectEast(&lanes[9], Intersection::LD_OUTGOING);
+	i3.connectSouth(&lanes[11], Intersection::LD_OUTGOING);
+	i3.connectWest(&lanes[8], Intersection::LD_OUTGOING);
+
+	i4.connectNorth(&lanes[5], Intersection::LD_OUTGOING);
+	i4.connectEast(&lanes[8], Intersection::LD_INCOMING);
+	i4.connectSouth(&lanes[10], Intersection::LD_OUTGOING);
+	i4.connectWest(&lanes[7], Intersection::LD_INCOMING);
+	ASSERT(i1.valid() && i2.valid() && i3.valid() && i4.valid());
+
+	Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
+	v1->turnLeft();
+	v1->turnRight();
+	v1->turnRight();
+	v1->turnRight();
+	v1->turnRight();
+	v1->turnStraight();
+	lanes[0].enqueue(v1);
+
+	i1.simulate();
+	i2.simulate();
+	i3.simulate();
+	i4.simulate();
+	i1.simulate();
+	i2.simulate();
+
+	for (int i=0; i<12; i++) {
+		ASSERT(i == 4 || lanes[i].dequeue() == 0);
+	}
+	ASSERT(lanes[4].dequeue() == v1);
+	ASSERT(v1->nextTurn() == Vehicle::TD_INVALID);
+
+	delete v1;
+
+	return TR_PASS;
+}
+
+/*
+Test an intersection whose incoming lane is fed from another thread through an MpscLane, as a demand injector would.
+*/
+TestResult test_IntersectionConcurrentFeed() {
+    const unsigned int total = 2000;
+    Intersection intersection;
+    MpscLane* roadIn = new MpscLane(16);
+    RingLane* roadLeft = new RingLane();
+    RingLane* roadStraight = new RingLane();
+    RingLane* roadRight = new RingLane();
+    ASSERT(intersection.connectNorth(roadIn, Intersection::LD_INCOMING) == 0);
+    ASSERT(intersection.connectEast(roadLeft, Intersection::LD_OUTGOING) == 0);
+    ASSERT(intersection.connectSouth(roadStraight, Intersection::LD_OUTGOING) == 0);
+    ASSERT(intersection.connectWest(roadRight, Intersection::LD_OUTGOING) == 0);
+
+    vector<Vehicle*> vehicles(total);
+    for (unsigned int i = 0; i < total; i++) {
+        vehicles[i] = new Vehicle(Vehicle::VT_CAR, 1);
+        vehicles[i]->turnLeft();
+    }
+    thread injector([&]() {
+        for (unsigned int i = 0; i < total; i++) {
+            roadIn->enqueue(vehicles[i]);
+        }
+    });
+    while (roadLeft->count() < total) {
+        intersection.simulate();
     }
+    injector.join();
+
+    ASSERT(roadIn->empty());
+    ASSERT(roadStraight->empty());
+    ASSERT(roadRight->empty());
+    for (unsigned int i = 0; i < total; i++) {
+        ASSERT(roadLeft->peek(i) == vehicles[i]);
+    }
+
+    // the vehicles are deleted by roadLeft
+    delete roadIn;
+    delete roadLeft;
+    delete roadStraight;
+    delete roadRight;
 
     return TR_PASS;
 }
 
-// from piazza @301, modified by hamish
-TestResult test_Intersections(){
+/*
+Test spillback: a vehicle whose outgoing lane is full waits in its incoming lane, together with the vehicles that must
+give way to it, until the outgoing lane has room.
+*/
+TestResult test_IntersectionSpillback() {
+    Intersection intersection;
 
-	// Create Intersections
+    Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
+    v1->turnLeft();
+    Vehicle* v2 = new Vehicle(Vehicle::VT_CAR, 1);
+    v2->turnLeft();
+    Vehicle* v3 = new Vehicle(Vehicle::VT_CAR, 1);
+    v3->turnLeft();
+    Vehicle* v4 = new Vehicle(Vehicle::VT_BUS, 10);
+    v4->turnRight();
 
-	Intersection intersection1;
-	Intersection intersection2;
-	Intersection intersection3;
-	Intersection intersection4;
+    Lane* roadInNorth = new RingLane();
+    roadInNorth->enqueue(v1);
+    roadInNorth->enqueue(v2);
+    roadInNorth->enqueue(v3);
+    Lane* roadInWest = new RingLane();
+    roadInWest->enqueue(v4);
+    Lane* roadOutEast = new RingLane();
+    roadOutEast->setCapacity(2);
+    Lane* roadOutSouth = new RingLane();
+
+    ASSERT(intersection.connectNorth(roadInNorth, Intersection::LD_INCOMING) == 0);
+    ASSERT(intersection.connectEast(roadOutEast, Intersection::LD_OUTGOING) == 0);
+    ASSERT(intersection.connectSouth(roadOutSouth, Intersection::LD_OUTGOING) == 0);
+    ASSERT(intersection.connectWest(roadInWest, Intersection::LD_INCOMING) == 0);
+
+    // two left-turning vehicles fill the eastern lane
+    intersection.simulate();
+    intersection.simulate();
+    ASSERT(roadOutEast->full());
+    ASSERT(roadOutEast->count() == 2);
 
-	Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
-	v1->turnStraight();
-	v1->turnLeft();
-	Vehicle* v2 = new Vehicle(Vehicle::VT_BUS, 10);
-	v2->turnStraight();
-	v2->turnStraight();
-	Vehicle* v3 = new Vehicle(Vehicle::VT_CAR, 1);
-	v3->turnLeft();
-	v3->turnRight();
-	v3->turnStraight();
-	Vehicle* v4 = new Vehicle(Vehicle::VT_CAR, 1);
-	v4->turnStraight();
-	v4->turnLeft();
+    // v3 is held, and v4 turning right must still give way to it
+    for (int i = 0; i < 3; i++) {
+        intersection.simulate();
+    }
+    ASSERT(roadInNorth->front() == v3);
+    ASSERT(roadInWest->front() == v4);
+    ASSERT(roadOutSouth->empty());
 
-	// Creating first intersection
+    // once there is room v3 proceeds, then v4
+    ASSERT(roadOutEast->dequeue() == v1);
+    intersection.simulate();
+    ASSERT(roadOutEast->back() == v3);
+    ASSERT(roadInNorth->empty());
+    intersection.simulate();
+    ASSERT(roadOutSouth->front() == v4);
+    ASSERT(roadInWest->empty());
 
-	Lane* North1 = new SimpleLane();
-	North1->enqueue(v2);
-	Lane* West1 = new SimpleLane();
-	West1->enqueue(v1);
-	Lane* roadTop = new SimpleLane();
-	Lane* roadLeft = new SimpleLane();
+    delete roadInNorth;
+    delete roadInWest;
+    delete roadOutEast;
+    delete roadOutSouth;
+    delete v1;
+
+    return TR_PASS;
+}
+
+TestResult test_IntersectionTiming() {
+    SimClock::reset();
+    Intersection intersection;
+    Lane* lanes[4];
+    for (int i = 0; i < 4; i++) {
+        lanes[i] = new RingLane();
+    }
+    ASSERT(intersection.connectNorth(lanes[0], Intersection::LD_INCOMING) == 0);
+    ASSERT(intersection.connectEast(lanes[1], Intersection::LD_OUTGOING) == 0);
+    ASSERT(intersection.connectSouth(lanes[2], Intersection::LD_OUTGOING) == 0);
+    ASSERT(intersection.connectWest(lanes[3], Intersection::LD_OUTGOING) == 0);
+
+    // three vehicles enter the northern lane at tick 0; the last one has a one-turn route
+    Vehicle* vehicles[3];
+    for (int i = 0; i < 3; i++) {
+        vehicles[i] = new Vehicle(Vehicle::VT_CAR, 1);
+        vehicles[i]->turnStraight();
+        vehicles[i]->turnStraight();
+    }
+    vehicles[2]->makeTurn();
+    lanes[0]->enqueueRange(vehicles, 3);
+#ifndef TRAFFIC_NO_TIMING
+    ASSERT(vehicles[0]->journeyStartTick() == 0 && vehicles[0]->lastMoveTick() == 0);
+#endif
+
+    // one vehicle leaves per tick, starting at tick 1
+    for (int tick = 0; tick < 3; tick++) {
+        SimClock::tick();
+        intersection.simulate();
+    }
+    ASSERT(lanes[2]->count() == 3);
+    LatencyHistogram waits = intersection.waitTimes();
+#ifndef TRAFFIC_NO_TIMING
+    ASSERT(vehicles[0]->lastMoveTick() == 1 && vehicles[0]->journeyStartTick() == 0);
+    ASSERT(waits.count() == 3);
+    ASSERT(waits.p50() == 2 && waits.max() == 3);
+    ASSERT(intersection.journeyTimes().count() == 1);
+    ASSERT(intersection.journeyTimes().max() == 3);
+#else
+    ASSERT(waits.count() == 0);
+#endif
+
+    for (int i = 0; i < 4; i++) {
+        delete lanes[i];
+    }
+    SimClock::reset();
+    return TR_PASS;
+}
+
+/*
+Adds "the vehicle in lane `from` proceeds into lane `to`" to a GiveWay table entry.
+*/
+unsigned int legacyMove(unsigned int entry, int from, int to) {
+    return entry | (1 << from) | (to << (4 + 2 * from));
+}
+
+/*
+The give way decision simulate() made before it used the GiveWay table, for comparison. Two cases differ on purpose:
+with three vehicles waiting the old code found the straight vehicle's outgoing lane from its position among the waiting
+lanes instead of its lane number, and with four it wrote past the end of incomingIndexes and moved nobody. Both now
+follow the three-vehicle rule with the lane number.
+*/
+unsigned int legacyGiveWay(unsigned int key) {
+    int incomingLanes = 0;
+    int incomingIndexes[4] = {};
+    Vehicle::TurnDirection turns[4];
+    for (int i = 0; i < 4; i++) {
+        turns[i] = (Vehicle::TurnDirection)((key >> (4 + 2 * i)) & 3);
+        if (key & (1 << i)) {
+            incomingIndexes[incomingLanes] = i;
+            incomingLanes++;
+        }
+    }
+
+    unsigned int entry = 0;
+    if (incomingLanes == 1) {
+        int i = incomingIndexes[0];
+        entry = legacyMove(entry, i, enqueueLane(i, turns[i]));
+    }
+    else if (incomingLanes == 2) {
+        int outgoingIndexes[2];
+        for (int i = 0; i < 2; i++) {
+            outgoingIndexes[i] = enqueueLane(incomingIndexes[i], turns[incomingIndexes[i]]);
+        }
+        if (turns[incomingIndexes[0]] == turns[incomingIndexes[1]]) {
+            for (int i = 0; i < 2; i++) {
+                entry = legacyMove(entry, incomingIndexes[i], outgoingIndexes[i]);
+            }
+        }
+        else {
+            int straightLanes = 0;
+            int j = 0;
+            int k = 0;
+            for (int i = 0; i < 2; i++) {
+                if (turns[incomingIndexes[i]] == Vehicle::TD_STRAIGHT) {
+                    j = i;
+                    straightLanes++;
+                }
+                if (turns[incomingIndexes[i]] == Vehicle::TD_LEFT) {
+                    k = i;
+                }
+            }
+            if (straightLanes > 0) {
+                entry = legacyMove(entry, incomingIndexes[j], outgoingIndexes[j]);
+            }
+            else {
+                entry = legacyMove(entry, incomingIndexes[k], outgoingIndexes[k]);
+            }
+        }
+    }
+    else if (incomingLanes >= 3) {
+        int j = 0;
+        for (int i = 0; i < incomingLanes; i++) {
+            if (turns[incomingIndexes[i]] == Vehicle::TD_STRAIGHT) {
+                j = i;
+            }
+        }
+        int i = incomingIndexes[j];
+        entry = legacyMove(entry, i, enqueueLane(i, turns[i]));
+    }
+    return entry;
+}
+
+TestResult test_GiveWayTable() {
+    // every key, including ones with turn bits set for empty lanes, which must be ignored
+    for (unsigned int key = 0; key < GiveWay::TABLE_SIZE; key++) {
+        unsigned int canonical = key & 15;
+        for (int i = 0; i < 4; i++) {
+            if (key & (1 << i)) {
+                canonical |= key & (3 << (4 + 2 * i));
+            }
+        }
+        unsigned int entry = GiveWayTable<LeftHandTraffic>::lookup(key);
+        ASSERT(entry == legacyGiveWay(canonical));
+        ASSERT(entry == LeftHandTraffic::decide(key));
+        // only waiting vehicles proceed, and at least one of them does
+        ASSERT((GiveWay::proceeding(entry) & ~key) == 0);
+        ASSERT((GiveWay::proceeding(entry) != 0) == ((key & 15) != 0));
+    }
+
+    // the key packs the turns of waiting vehicles only
+    Vehicle::TurnDirection turns[4] = { Vehicle::TD_RIGHT, Vehicle::TD_STRAIGHT, Vehicle::TD_INVALID, Vehicle::TD_LEFT };
+    ASSERT(GiveWay::key(10, turns) == (10 | (Vehicle::TD_STRAIGHT << 6) | (Vehicle::TD_LEFT << 10)));
+
+    // three waiting with north free: the straight vehicle from the west goes east
+    unsigned int key = 14 | (Vehicle::TD_LEFT << 6) | (Vehicle::TD_RIGHT << 8) | (Vehicle::TD_STRAIGHT << 10);
+    ASSERT(GiveWay::proceeding(GiveWayTable<LeftHandTraffic>::lookup(key)) == 8);
+    ASSERT(GiveWay::destination(GiveWayTable<LeftHandTraffic>::lookup(key), 3) == 1);
+
+    // the tables are generated and checked at compile time
+    static_assert(GiveWay::deadlockFree(buildGiveWayEntries<RightHandTraffic>().entries), "");
+    static_assert(RightHandTraffic::decide(10 | (Vehicle::TD_LEFT << 6) | (Vehicle::TD_RIGHT << 10)) ==
+        (8 | (2 << 10)), "");
+
+    return TR_PASS;
+}
+
+TestResult test_IntersectionFourIn() {
+    Intersection intersection;
+    Lane* lanes[4];
+    Vehicle* vehicles[4];
+    for (int i = 0; i < 4; i++) {
+        lanes[i] = new SimpleLane();
+        vehicles[i] = new Vehicle(Vehicle::VT_CAR, 1);
+        lanes[i]->enqueue(vehicles[i]);
+    }
+    vehicles[0]->turnStraight();
+    vehicles[1]->turnLeft();
+    vehicles[2]->turnStraight();
+    vehicles[3]->turnRight();
+    intersection.connectNorth(lanes[0], Intersection::LD_INCOMING);
+    intersection.connectEast(lanes[1], Intersection::LD_INCOMING);
+    intersection.connectSouth(lanes[2], Intersection::LD_INCOMING);
+    intersection.connectWest(lanes[3], Intersection::LD_INCOMING);
+
+    // only the straight vehicle in the highest numbered lane (south) proceeds, into the back of the north lane
+    intersection.simulate();
+    ASSERT(lanes[0]->count() == 2);
+    ASSERT(lanes[0]->back() == vehicles[2]);
+    ASSERT(lanes[1]->front() == vehicles[1]);
+    ASSERT(lanes[2]->empty());
+    ASSERT(lanes[3]->front() == vehicles[3]);
+
+    // now three are waiting and the north vehicle is the only one going straight
+    intersection.simulate();
+    ASSERT(lanes[0]->front() == vehicles[2]);
+    ASSERT(lanes[2]->front() == vehicles[0]);
+
+    for (int i = 0; i < 4; i++) {
+        delete lanes[i];
+    }
+    return TR_PASS;
+}
+
+TestResult test_IntersectionRightHandTraffic() {
+    // east turns left and west turns right, with north and south as exits
+    Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
+    v1->turnLeft();
+    Vehicle* v2 = new Vehicle(Vehicle::VT_CAR, 1);
+    v2->turnRight();
+    Vehicle* v3 = new Vehicle(Vehicle::VT_CAR, 1);
+    v3->turnLeft();
+    Vehicle* v4 = new Vehicle(Vehicle::VT_CAR, 1);
+    v4->turnRight();
+    Lane* lanes[8];
+    for (int i = 0; i < 8; i++) {
+        lanes[i] = new SimpleLane();
+    }
+    lanes[1]->enqueue(v1);
+    lanes[3]->enqueue(v2);
+    lanes[5]->enqueue(v3);
+    lanes[7]->enqueue(v4);
+
+    Intersection leftHand;
+    leftHand.connectNorth(lanes[0], Intersection::LD_OUTGOING);
+    leftHand.connectEast(lanes[1], Intersection::LD_INCOMING);
+    leftHand.connectSouth(lanes[2], Intersection::LD_OUTGOING);
+    leftHand.connectWest(lanes[3], Intersection::LD_INCOMING);
+    BasicIntersection<Lane, RightHandTraffic> rightHand;
+    rightHand.connectNorth(lanes[4], Intersection::LD_OUTGOING);
+    rightHand.connectEast(lanes[5], Intersection::LD_INCOMING);
+    rightHand.connectSouth(lanes[6], Intersection::LD_OUTGOING);
+    rightHand.connectWest(lanes[7], Intersection::LD_INCOMING);
+
+    // driving on the left the right turn gives way, driving on the right the left turn does
+    leftHand.simulate();
+    rightHand.simulate();
+    ASSERT(lanes[2]->front() == v1);
+    ASSERT(lanes[3]->front() == v2);
+    ASSERT(lanes[5]->front() == v3);
+    ASSERT(lanes[6]->front() == v4);
+
+    for (int i = 0; i < 8; i++) {
+        delete lanes[i];
+    }
+    return TR_PASS;
+}
+
+/*
+Test that reconnecting a lane in the other direction changes which lanes the intersection drains.
+*/
+TestResult test_IntersectionReconnect() {
+    Intersection intersection;
+    Lane* lanes[4];
+    for (int i = 0; i < 4; i++) {
+        lanes[i] = new SimpleLane();
+    }
+    Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
+    v1->turnStraight();
+    Vehicle* v2 = new Vehicle(Vehicle::VT_CAR, 1);
+    v2->turnStraight();
+    lanes[0]->enqueue(v1);
+    lanes[1]->enqueue(v2);
+
+    intersection.connectNorth(lanes[0], Intersection::LD_INCOMING);
+    intersection.connectEast(lanes[1], Intersection::LD_OUTGOING);
+    intersection.connectSouth(lanes[2], Intersection::LD_OUTGOING);
+    intersection.connectWest(lanes[3], Intersection::LD_OUTGOING);
+
+    // only north is incoming, so east's vehicle stays put
+    intersection.simulate();
+    ASSERT(lanes[2]->front() == v1);
+    ASSERT(lanes[1]->front() == v2);
+
+    // turning east around makes it incoming
+    ASSERT(intersection.connectEast(lanes[1], Intersection::LD_INCOMING) == lanes[1]);
+    intersection.simulate();
+    ASSERT(lanes[1]->empty());
+    ASSERT(lanes[3]->front() == v2);
+
+    // an intersection missing a lane does nothing, even with traffic waiting
+    lanes[1]->enqueue(lanes[3]->dequeue());
+    intersection.connectWest(0, Intersection::LD_OUTGOING);
+    intersection.simulate();
+    ASSERT(lanes[1]->front() == v2);
+
+    for (int i = 0; i < 4; i++) {
+        delete lanes[i];
+    }
+    return TR_PASS;
+}
+
+/*
+Test that simulate(k) gives the same result as k calls to simulate(), over many random intersections: random lane
+directions, turns (including vehicles with no turns left), vehicle types, outgoing lane capacities and batch sizes.
+*/
+TestResult test_IntersectionSaturationFlow() {
+    unsigned int seed = 12345;
+    for (int trial = 0; trial < 300; trial++) {
+        Intersection batched;
+        Intersection stepped;
+        Lane* batchedLanes[4];
+        Lane* steppedLanes[4];
+        unsigned int id = 0;
+        for (int i = 0; i < 4; i++) {
+            batchedLanes[i] = new ExpressLane();
+            steppedLanes[i] = new ExpressLane();
+            seed = seed * 1103515245 + 12345;
+            bool incoming = (seed >> 16) % 3 != 0;
+            Intersection::LaneDirection direction = incoming ? Intersection::LD_INCOMING : Intersection::LD_OUTGOING;
+            if (!incoming && (seed >> 20) % 2 == 0) {
+                batchedLanes[i]->setCapacity(1 + (seed >> 22) % 8);
+                steppedLanes[i]->setCapacity(1 + (seed >> 22) % 8);
+            }
+            // the same vehicles, told apart by their occupant counts, queue in both copies of an incoming lane
+            unsigned int queued = incoming ? (seed >> 24) % 50 : 0;
+            for (unsigned int v = 0; v < queued; v++) {
+                seed = seed * 1103515245 + 12345;
+                Vehicle::Type type = (seed >> 16) % 4 == 0 ? Vehicle::VT_MOTORCYCLE : Vehicle::VT_CAR;
+                Vehicle* vehicles[2] = { new Vehicle(type, id), new Vehicle(type, id) };
+                id++;
+                unsigned int turns = (seed >> 18) % 8 == 0 ? 0 : 1 + (seed >> 21) % 3;
+                for (unsigned int t = 0; t < turns; t++) {
+                    unsigned int turn = (seed >> (23 + 2 * t)) % 3;
+                    for (int c = 0; c < 2; c++) {
+                        if (turn == 0) {
+                            vehicles[c]->turnLeft();
+                        }
+                        else if (turn == 1) {
+                            vehicles[c]->turnStraight();
+                        }
+                        else {
+                            vehicles[c]->turnRight();
+                        }
+                    }
+                }
+                batchedLanes[i]->enqueue(vehicles[0]);
+                steppedLanes[i]->enqueue(vehicles[1]);
+            }
+            if (i == 0) {
+                batched.connectNorth(batchedLanes[i], direction);
+                stepped.connectNorth(steppedLanes[i], direction);
+            }
+            else if (i == 1) {
+                batched.connectEast(batchedLanes[i], direction);
+                stepped.connectEast(steppedLanes[i], direction);
+            }
+            else if (i == 2) {
+                batched.connectSouth(batchedLanes[i], direction);
+                stepped.connectSouth(steppedLanes[i], direction);
+            }
+            else {
+                batched.connectWest(batchedLanes[i], direction);
+                stepped.connectWest(steppedLanes[i], direction);
+            }
+        }
+
+        seed = seed * 1103515245 + 12345;
+        unsigned int k = 1 + (seed >> 16) % 70;
+        batched.simulate(k);
+        for (unsigned int r = 0; r < k; r++) {
+            stepped.simulate();
+        }
 
+        for (int i = 0; i < 4; i++) {
+            ASSERT(batchedLanes[i]->count() == steppedLanes[i]->count());
+            Lane::const_iterator b = batchedLanes[i]->begin();
+            for (Lane::const_iterator s = steppedLanes[i]->begin(); s != steppedLanes[i]->end(); ++s, ++b) {
+                ASSERT((*b)->occupantCount() == (*s)->occupantCount());
+                ASSERT((*b)->nextTurn() == (*s)->nextTurn());
+            }
+            delete batchedLanes[i];
+            delete steppedLanes[i];
+        }
+#ifndef TRAFFIC_NO_TIMING
+        ASSERT(batched.waitTimes().count() == stepped.waitTimes().count());
+#endif
+    }
 
-	ASSERT(intersection1.connectNorth(North1, Intersection::LD_INCOMING) == 0);
-	ASSERT(intersection1.connectEast(roadTop, Intersection::LD_OUTGOING) == 0);
-	ASSERT(intersection1.connectSouth(roadLeft, Intersection::LD_OUTGOING) == 0);
-	ASSERT(intersection1.connectWest(West1, Intersection::LD_INCOMING) == 0);
+    // a lone incoming lane discharges three vehicles at once
+    Intersection intersection;
+    Lane* lanes[4];
+    for (int i = 0; i < 4; i++) {
+        lanes[i] = new SimpleLane();
+    }
+    for (int v = 0; v < 5; v++) {
+        Vehicle* vehicle = new Vehicle(Vehicle::VT_CAR, 1);
+        vehicle->turnStraight();
+        lanes[0]->enqueue(vehicle);
+    }
+    intersection.connectNorth(lanes[0], Intersection::LD_INCOMING);
+    intersection.connectEast(lanes[1], Intersection::LD_OUTGOING);
+    intersection.connectSouth(lanes[2], Intersection::LD_OUTGOING);
+    intersection.connectWest(lanes[3], Intersection::LD_OUTGOING);
+    intersection.simulate(3);
+    ASSERT(lanes[0]->count() == 2);
+    ASSERT(lanes[2]->count() == 3);
+    // and stops at the outgoing lane's capacity
+    lanes[2]->setCapacity(4);
+    intersection.simulate(3);
+    ASSERT(lanes[0]->count() == 1);
+    ASSERT(lanes[2]->count() == 4);
+    for (int i = 0; i < 4; i++) {
+        delete lanes[i];
+    }
 
-	// Creating second intersection
+    return TR_PASS;
+}
 
-	Lane* North2 = new SimpleLane();
-	Lane* East2 = new SimpleLane();
-	East2->enqueue(v3);
-	Lane* roadRight = new SimpleLane();
+/*
+Test the standard junction layouts, a T-junction, a five-way junction and a junction with a custom layout.
+*/
+TestResult test_Junction() {
+    // four-way: crossing paths and shared exits conflict, opposite and non-crossing paths do not
+    const JunctionLayout<4>& four = JunctionLayout<4>::standard();
+    unsigned int northStraight = JunctionLayout<4>::movement(0, Vehicle::TD_STRAIGHT);
+    ASSERT(four.exit(northStraight) == 2);
+    ASSERT(four.conflicts(northStraight) & (1ull << JunctionLayout<4>::movement(1, Vehicle::TD_STRAIGHT)));
+    ASSERT(!(four.conflicts(northStraight) & (1ull << JunctionLayout<4>::movement(2, Vehicle::TD_STRAIGHT))));
+    ASSERT(four.conflicts(northStraight) & (1ull << JunctionLayout<4>::movement(1, Vehicle::TD_LEFT)));
+    ASSERT(!(four.conflicts(JunctionLayout<4>::movement(0, Vehicle::TD_LEFT)) &
+        (1ull << JunctionLayout<4>::movement(2, Vehicle::TD_LEFT))));
+    ASSERT(four.conflicts(JunctionLayout<4>::movement(0, Vehicle::TD_INVALID)) == 0);
+    // the lookup table agrees with the rules, and someone always proceeds
+    for (unsigned int key = 0; key < 4096; key++) {
+        Vehicle::TurnDirection turns[4];
+        for (int i = 0; i < 4; i++) {
+            turns[i] = (Vehicle::TurnDirection)((key >> (4 + 2 * i)) & 3);
+        }
+        unsigned int entry = four.decisions()[key];
+        ASSERT((entry & 15) == four.decide(key & 15, turns));
+        ASSERT(((entry & 15) != 0) == ((key & 15) != 0));
+        ASSERT((entry & ~key & 15) == 0);
+        for (unsigned int i = 0; i < 4; i++) {
+            if (entry & (1 << i)) {
+                ASSERT(((entry >> (4 + 2 * i)) & 3) == four.exit(JunctionLayout<4>::movement(i, turns[i])));
+            }
+        }
+    }
 
-	ASSERT(intersection2.connectNorth(North2, Intersection::LD_OUTGOING) == 0);
-	ASSERT(intersection2.connectEast(East2, Intersection::LD_INCOMING) == 0);
-	ASSERT(intersection2.connectSouth(roadRight, Intersection::LD_OUTGOING) == 0);
-	ASSERT(intersection2.connectWest(roadTop, Intersection::LD_INCOMING) == 0);
+    // T-junction: both arms' vehicles head for the same exit, and the left turn goes first
+    Junction<3> tee;
+    Lane* teeLanes[3];
+    for (int i = 0; i < 3; i++) {
+        teeLanes[i] = new SimpleLane();
+    }
+    Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
+    v1->turnRight();
+    Vehicle* v2 = new Vehicle(Vehicle::VT_CAR, 2);
+    v2->turnLeft();
+    teeLanes[0]->enqueue(v1);
+    teeLanes[1]->enqueue(v2);
+    ASSERT(tee.connect(0, teeLanes[0], Junction<3>::LD_INCOMING) == 0);
+    ASSERT(tee.connect(1, teeLanes[1], Junction<3>::LD_INCOMING) == 0);
+    ASSERT(!tee.valid());
+    tee.simulate();
+    ASSERT(teeLanes[0]->front() == v1);
+    ASSERT(tee.connect(2, teeLanes[2], Junction<3>::LD_OUTGOING) == 0);
+    ASSERT(tee.valid());
+    tee.simulate();
+    ASSERT(teeLanes[2]->front() == v2);
+    ASSERT(teeLanes[0]->front() == v1);
+    tee.simulate();
+    ASSERT(teeLanes[2]->back() == v1);
+    ASSERT(teeLanes[0]->empty());
+    for (int i = 0; i < 3; i++) {
+        delete teeLanes[i];
+    }
 
+    // five-way: straight on leaves two approaches round, and paths that do not cross proceed together
+    Junction<5> star;
+    Lane* starLanes[5];
+    for (int i = 0; i < 5; i++) {
+        starLanes[i] = new SimpleLane();
+        star.connect(i, starLanes[i], i < 2 ? Junction<5>::LD_INCOMING : Junction<5>::LD_OUTGOING);
+    }
+    Vehicle* v3 = new Vehicle(Vehicle::VT_CAR, 3);
+    v3->turnStraight();
+    Vehicle* v4 = new Vehicle(Vehicle::VT_CAR, 4);
+    v4->turnLeft();
+    Vehicle* v5 = new Vehicle(Vehicle::VT_CAR, 5);
+    v5->turnRight();
+    starLanes[0]->enqueue(v3);
+    starLanes[1]->enqueue(v4);
+    starLanes[1]->enqueue(v5);
+    // 0 -> 2 and 1 -> 2 share an exit, so only the straight vehicle goes
+    star.simulate();
+    ASSERT(starLanes[2]->front() == v3);
+    ASSERT(starLanes[1]->front() == v4);
+    star.simulate();
+    ASSERT(starLanes[2]->back() == v4);
+    // 1 -> 0 turns back into an incoming lane
+    star.simulate();
+    ASSERT(starLanes[0]->front() == v5);
+    for (int i = 0; i < 5; i++) {
+        delete starLanes[i];
+    }
 
-	// Creating third intersection
+    // a custom layout in which every movement conflicts with every other, and approach 1 has priority
+    unsigned int exits[8];
+    JunctionLayout<2>::MovementSet conflicts[8];
+    unsigned int priorities[8];
+    for (unsigned int m = 0; m < 8; m++) {
+        exits[m] = 1 - m / 4;
+        conflicts[m] = 0xff;
+        priorities[m] = m < 4 ? 1 : 0;
+    }
+    JunctionLayout<2> oneAtATime(exits, conflicts, priorities);
+    Junction<2> pair(oneAtATime);
+    Lane* pairLanes[2] = { new SimpleLane(), new SimpleLane() };
+    Vehicle* v6 = new Vehicle(Vehicle::VT_CAR, 6);
+    Vehicle* v7 = new Vehicle(Vehicle::VT_CAR, 7);
+    pairLanes[0]->enqueue(v6);
+    pairLanes[1]->enqueue(v7);
+    pair.connect(0, pairLanes[0], Junction<2>::LD_INCOMING);
+    pair.connect(1, pairLanes[1], Junction<2>::LD_INCOMING);
+    pair.simulate();
+    ASSERT(pairLanes[0]->count() == 2);
+    ASSERT(pairLanes[0]->back() == v7);
+    delete pairLanes[0];
+    delete pairLanes[1];
 
-	Lane* South3 = new SimpleLane();
-	Lane* East3= new SimpleLane();
-	East3->enqueue(v4);
-	Lane* roadBot = new SimpleLane();
+    return TR_PASS;
+}
 
-	ASSERT(intersection3.connectNorth(roadRight, Intersection::LD_INCOMING) == 0);
-	ASSERT(intersection3.connectEast(East3, Intersection::LD_INCOMING) == 0);
-	ASSERT(intersection3.connectSouth(South3, Intersection::LD_OUTGOING) == 0);
-	ASSERT(intersection3.connectWest(roadBot, Intersection::LD_OUTGOING) == 0);
+/*
+Test the network from test_TrafficNetwork built as a RoadNetwork.
+*/
+TestResult test_RoadNetwork() {
+    BasicRoadNetwork<ExpressLane> network(4, 12);
+    ASSERT(network.intersectionCount() == 4);
+    ASSERT(network.laneCount() == 12);
+    const int wiring[4][4] = { { 0, 3, 5, 2 }, { 1, 4, 6, 3 }, { 6, 9, 11, 8 }, { 5, 8, 10, 7 } };
+    const bool incoming[4][4] = { { true, false, true, true }, { true, false, false, true },
+                                  { true, false, false, false }, { false, true, false, true } };
+    for (int i = 0; i < 4; i++) {
+        for (int side = 0; side < 4; side++) {
+            network.connect(i, side, wiring[i][side], incoming[i][side] ? Intersection::LD_INCOMING :
+                                                                         Intersection::LD_OUTGOING);
+        }
+        ASSERT(network.intersection(i).valid());
+    }
 
-	// Creating fourth intersection
+    // lane 3 runs from intersection 0 to 1, lane 4 leaves the network
+    ASSERT(network.upstreamOf(3) == 0);
+    ASSERT(network.downstreamOf(3) == 1);
+    ASSERT(network.downstreamOf(4) == RoadNetwork::NONE);
+    ASSERT(network.laneAt(2, 3) == 8);
+    const unsigned int downstream[4] = { 1, 2, 3, 0 };
+    for (unsigned int i = 0; i < 4; i++) {
+        ASSERT(network.downstreamEnd(i) - network.downstreamBegin(i) == 1);
+        ASSERT(*network.downstreamBegin(i) == downstream[i]);
+    }
 
-	Lane* South4 = new SimpleLane();
-	Lane* West4 = new SimpleLane();
+    // the car goes round the loop in the same six intersection visits, in two steps
+    Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
+    v1->turnLeft();
+    v1->turnRight();
+    v1->turnRight();
+    v1->turnRight();
+    v1->turnRight();
+    v1->turnStraight();
+    network.lane(0).enqueue(v1);
+    unsigned int start = SimClock::now();
+    network.step();
+    network.step();
+    ASSERT(SimClock::now() == start + 2);
+    for (unsigned int l = 0; l < 12; l++) {
+        ASSERT(network.lane(l).count() == (l == 4 ? 1u : 0u));
+    }
+    ASSERT(network.lane(4).front() == v1);
+    ASSERT(v1->nextTurn() == Vehicle::TD_INVALID);
 
-	ASSERT(intersection4.connectNorth(roadLeft, Intersection::LD_INCOMING) == 0);
-	ASSERT(intersection4.connectEast(roadBot, Intersection::LD_INCOMING) == 0);
-	ASSERT(intersection4.connectSouth(South4, Intersection::LD_OUTGOING) == 0);
-	ASSERT(intersection4.connectWest(West4, Intersection::LD_OUTGOING) == 0);
+    // disconnecting a side updates the wiring
+    network.connect(0, 1, RoadNetwork::NONE, Intersection::LD_OUTGOING);
+    ASSERT(!network.intersection(0).valid());
+    ASSERT(network.upstreamOf(3) == RoadNetwork::NONE);
+    ASSERT(network.downstreamEnd(0) == network.downstreamBegin(0));
 
-	//cout << "Intersections Created" << endl;
-	//cout << "Time to simulate" << endl;
+    // the network deletes v1 along with its lanes
+    return TR_PASS;
+}
 
-	intersection1.simulate();
-	ASSERT(North1->front() == 0);
-	ASSERT(West1->front() == 0);
-	ASSERT(roadTop->back() == v1);
-	ASSERT(roadLeft->back() == v2);
+/*
+Wire `network` as a `size` x `size` torus: lane 2i leaves intersection i eastwards into the west side of the next
+intersection along its row, lane 2i + 1 leaves it southwards into the north side of the next one down its column. Each
+lane gets a few vehicles with random routes, numbered by their occupant count, and some lanes a capacity. Vehicles can
+turn back into an incoming lane, so lanes are fed from both ends.
+*/
+template <class Network>
+void buildTestGrid(Network& network, unsigned int size, unsigned int seed) {
+    for (unsigned int r = 0; r < size; r++) {
+        for (unsigned int c = 0; c < size; c++) {
+            unsigned int i = r * size + c;
+            unsigned int west = r * size + (c + size - 1) % size;
+            unsigned int north = ((r + size - 1) % size) * size + c;
+            network.connect(i, 0, 2 * north + 1, Intersection::LD_INCOMING);
+            network.connect(i, 1, 2 * i, Intersection::LD_OUTGOING);
+            network.connect(i, 2, 2 * i + 1, Intersection::LD_OUTGOING);
+            network.connect(i, 3, 2 * west, Intersection::LD_INCOMING);
+        }
+    }
+    unsigned int id = 0;
+    for (unsigned int l = 0; l < network.laneCount(); l++) {
+        seed = seed * 1103515245 + 12345;
+        if ((seed >> 16) % 4 == 0) {
+            network.lane(l).setCapacity(2 + (seed >> 20) % 4);
+        }
+        unsigned int queued = (seed >> 24) % 4;
+        for (unsigned int v = 0; v < queued && !network.lane(l).full(); v++) {
+            Vehicle* vehicle = new Vehicle(Vehicle::VT_CAR, id++);
+            for (int t = 0; t < 8; t++) {
+                seed = seed * 1103515245 + 12345;
+                unsigned int turn = (seed >> 16) % 3;
+                if (turn == 0) {
+                    vehicle->turnLeft();
+                }
+                else if (turn == 1) {
+                    vehicle->turnStraight();
+                }
+                else {
+                    vehicle->turnRight();
+                }
+            }
+            network.lane(l).enqueue(vehicle);
+        }
+    }
+}
 
+/*
+Return `true` if every lane of networks `a` and `b` holds the same vehicles, by occupant count, in the same order.
+*/
+template <class Network>
+bool sameTraffic(Network& a, Network& b) {
+    for (unsigned int l = 0; l < a.laneCount(); l++) {
+        if (a.lane(l).count() != b.lane(l).count()) {
+            return false;
+        }
+        for (unsigned int k = 0; k < a.lane(l).count(); k++) {
+            if (a.lane(l).peek(k)->occupantCount() != b.lane(l).peek(k)->occupantCount() ||
+                a.lane(l).peek(k)->turnsLeft() != b.lane(l).peek(k)->turnsLeft()) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
 
-	intersection2.simulate();
-	ASSERT(North2->back() == v1);
-	ASSERT(East2->front() == 0);
-	ASSERT(roadRight->back() == v3);
-	ASSERT(roadTop->back() == 0);
+/*
+In a synchronous step a vehicle crosses at most one intersection per tick, and the result does not depend on the order
+the intersections are simulated in.
+*/
+TestResult test_RoadNetworkSynchronous() {
+    RoadNetwork loop(4, 12);
+    const int wiring[4][4] = { { 0, 3, 5, 2 }, { 1, 4, 6, 3 }, { 6, 9, 11, 8 }, { 5, 8, 10, 7 } };
+    const bool incoming[4][4] = { { true, false, true, true }, { true, false, false, true },
+                                  { true, false, false, false }, { false, true, false, true } };
+    for (int i = 0; i < 4; i++) {
+        for (int side = 0; side < 4; side++) {
+            loop.connect(i, side, wiring[i][side], incoming[i][side] ? Intersection::LD_INCOMING :
+                                                                      Intersection::LD_OUTGOING);
+        }
+    }
+    loop.setStepMode(RoadNetworkBase::SM_SYNCHRONOUS);
+    ASSERT(loop.stepMode() == RoadNetworkBase::SM_SYNCHRONOUS);
 
+    // the car from test_TrafficNetwork now takes one tick per intersection
+    Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
+    v1->turnLeft();
+    v1->turnRight();
+    v1->turnRight();
+    v1->turnRight();
+    v1->turnRight();
+    v1->turnStraight();
+    loop.lane(0).enqueue(v1);
+    const unsigned int route[6] = { 3, 6, 8, 5, 3, 4 };
+    for (int t = 0; t < 6; t++) {
+        loop.step();
+        for (unsigned int l = 0; l < 12; l++) {
+            ASSERT(loop.lane(l).count() == (l == route[t] ? 1u : 0u));
+        }
+    }
+    ASSERT(v1->nextTurn() == Vehicle::TD_INVALID);
+
+    // simulating the intersections backwards, one at a time, and the lanes in two halves gives the same traffic
+    const unsigned int size = 6;
+    BasicRoadNetwork<ExpressLane> forward(size * size, 2 * size * size);
+    BasicRoadNetwork<ExpressLane> backward(size * size, 2 * size * size);
+    buildTestGrid(forward, size, 777);
+    buildTestGrid(backward, size, 777);
+    ASSERT(sameTraffic(forward, backward));
+    forward.setStepMode(RoadNetworkBase::SM_SYNCHRONOUS);
+    for (int t = 0; t < 40; t++) {
+        forward.step();
+        unsigned int half = backward.laneCount() / 2;
+        backward.prepareLanes(half, backward.laneCount());
+        backward.prepareLanes(0, half);
+        for (unsigned int i = backward.intersectionCount(); i > 0; i--) {
+            backward.stageIntersections(i - 1, i);
+        }
+        backward.commitLanes(half, backward.laneCount());
+        backward.commitLanes(0, half);
+        SimClock::tick();
+        ASSERT(sameTraffic(forward, backward));
+    }
+    // and the traffic did move: some vehicles have finished their routes
+    unsigned int finished = 0;
+    for (unsigned int l = 0; l < forward.laneCount(); l++) {
+        for (unsigned int k = 0; k < forward.lane(l).count(); k++) {
+            finished += forward.lane(l).peek(k)->turnsLeft() == 0 ? 1 : 0;
+        }
+    }
+    ASSERT(finished > 0);
 
-	 for (int i=0; i<2; i++){
-		 intersection3.simulate();
-	 }
+    return TR_PASS;
+}
 
-	 ASSERT(roadRight->back() == 0);
-	ASSERT(East3->back() == 0);
-	ASSERT(roadBot->back() == v3);
-	ASSERT(roadBot->front() == v4);
-	ASSERT(South3->back() == 0);
+/*
+Every chunk of a WorkerPool run is processed exactly once, however unevenly the chunks are sized, and runs can follow
+each other on the same pool.
+*/
+void countChunk(void* context, unsigned int chunk) {
+    unsigned int* counts = (unsigned int*)context;
+    // Make the early chunks slow so that the other threads run out of work and steal
+    volatile unsigned int spin = 0;
+    for (unsigned int k = 0; k < (chunk < 8 ? 20000u : 10u); k++) {
+        spin = spin + k;
+    }
+    counts[chunk]++;
+}
+
+TestResult test_WorkerPool() {
+    const unsigned int threadCounts[3] = { 1, 2, 5 };
+    for (unsigned int t = 0; t < 3; t++) {
+        WorkerPool pool(threadCounts[t]);
+        ASSERT(pool.threadCount() == threadCounts[t]);
+        unsigned int counts[97] = {};
+        for (unsigned int run = 0; run < 20; run++) {
+            pool.run(97, &countChunk, counts);
+        }
+        for (unsigned int chunk = 0; chunk < 97; chunk++) {
+            ASSERT(counts[chunk] == 20);
+        }
+        pool.run(0, &countChunk, counts);
+    }
+    return TR_PASS;
+}
 
+/*
+A step across a WorkerPool gives the same traffic as a serial synchronous step, tick by tick.
+*/
+TestResult test_RoadNetworkParallel() {
+    const unsigned int size = 10;
+    BasicRoadNetwork<ExpressLane> serial(size * size, 2 * size * size);
+    BasicRoadNetwork<ExpressLane> parallel(size * size, 2 * size * size);
+    buildTestGrid(serial, size, 4242);
+    buildTestGrid(parallel, size, 4242);
+    serial.setStepMode(RoadNetworkBase::SM_SYNCHRONOUS);
+    WorkerPool pool(4);
+    for (int t = 0; t < 40; t++) {
+        unsigned int before = SimClock::now();
+        serial.step();
+        parallel.step(pool);
+        ASSERT(SimClock::now() == before + 2);
+        ASSERT(sameTraffic(serial, parallel));
+    }
+    return TR_PASS;
+}
 
-	 for (int i=0; i<3; i++){
-		 intersection4.simulate();
-	 }
+/*
+Relabelling and reordering a network moves its intersections, lanes and vehicles without changing the wiring or, in
+synchronous mode, the traffic; Reverse Cuthill-McKee order cuts fewer lanes than a shuffled numbering.
+*/
+TestResult test_RoadNetworkReorder() {
+    const unsigned int size = 8;
+    const unsigned int n = size * size;
+    BasicRoadNetwork<ExpressLane> original(n, 2 * n);
+    BasicRoadNetwork<ExpressLane> moved(n, 2 * n);
+    buildTestGrid(original, size, 99);
+    buildTestGrid(moved, size, 99);
+    original.setStepMode(RoadNetworkBase::SM_SYNCHRONOUS);
+    moved.setStepMode(RoadNetworkBase::SM_SYNCHRONOUS);
+    for (int t = 0; t < 5; t++) {
+        original.step();
+        moved.step();
+    }
 
-	 ASSERT(roadLeft->back() == 0);
-	 ASSERT(roadBot->back() == 0);
-	 ASSERT(South4->front() == v2);
-	 ASSERT(South4->back() == v4);
-	 ASSERT(West4->back() == v3);
+    // shuffle the intersections, then put them in Reverse Cuthill-McKee order
+    unsigned int shuffled[n];
+    for (unsigned int i = 0; i < n; i++) {
+        shuffled[i] = i;
+    }
+    unsigned int seed = 31337;
+    for (unsigned int i = n - 1; i > 0; i--) {
+        seed = seed * 1103515245 + 12345;
+        unsigned int j = (seed >> 16) % (i + 1);
+        unsigned int t = shuffled[i];
+        shuffled[i] = shuffled[j];
+        shuffled[j] = t;
+    }
+    unsigned int shuffledLanes[2 * n];
+    moved.relabel(shuffled, shuffledLanes);
+    unsigned int shuffledCut = moved.edgeCut(4);
+    unsigned int reordered[n];
+    unsigned int reorderedLanes[2 * n];
+    moved.reorder(reordered, reorderedLanes);
+    unsigned int newIntersection[n];
+    unsigned int newLane[2 * n];
+    for (unsigned int i = 0; i < n; i++) {
+        newIntersection[i] = reordered[shuffled[i]];
+    }
+    for (unsigned int l = 0; l < 2 * n; l++) {
+        newLane[l] = reorderedLanes[shuffledLanes[l]];
+    }
+    ASSERT(moved.edgeCut(4) < shuffledCut);
+    ASSERT(moved.edgeCut(1) == 0);
 
-	//cout << "THe Largest Case has been passed" << endl;
+    for (unsigned int l = 0; l < 2 * n; l++) {
+        ASSERT(moved.upstreamOf(newLane[l]) == newIntersection[original.upstreamOf(l)]);
+        ASSERT(moved.downstreamOf(newLane[l]) == newIntersection[original.downstreamOf(l)]);
+        ASSERT(moved.lane(newLane[l]).capacity() == original.lane(l).capacity());
+    }
+    for (unsigned int i = 0; i < n; i++) {
+        ASSERT(moved.intersection(newIntersection[i]).valid());
+        for (int side = 0; side < 4; side++) {
+            ASSERT(moved.laneAt(newIntersection[i], side) == newLane[original.laneAt(i, side)]);
+        }
+        // the recorded times move with their intersection
+        ASSERT(moved.intersection(newIntersection[i]).waitTimes().count() ==
+               original.intersection(i).waitTimes().count());
+    }
 
-	delete North1;
-	delete West1;
-	delete roadTop;
-	delete roadLeft;
-	delete North2;
-	delete East2;
-	delete roadRight;
-	delete South3;
-	delete East3;
-	delete roadBot;
-	delete South4;
-	delete West4;
+    // the traffic is the same, lane for lane, tick after tick
+    for (int t = 0; t < 30; t++) {
+        for (unsigned int l = 0; l < 2 * n; l++) {
+            const ExpressLane& a = original.lane(l);
+            const ExpressLane& b = moved.lane(newLane[l]);
+            ASSERT(a.count() == b.count());
+            for (unsigned int k = 0; k < a.count(); k++) {
+                ASSERT(a.peek(k)->occupantCount() == b.peek(k)->occupantCount());
+                ASSERT(a.peek(k)->turnsLeft() == b.peek(k)->turnsLeft());
+            }
+        }
+        original.step();
+        moved.step();
+    }
+    return TR_PASS;
+}
 
-	return TR_PASS;
+/*
+Intersections with nothing waiting sleep until a vehicle arrives in one of their incoming lanes, and a network that only
+simulates the intersections awake moves traffic exactly as one that simulates them all.
+*/
+TestResult test_RoadNetworkActiveSet() {
+    RoadNetwork loop(4, 12);
+    const int wiring[4][4] = { { 0, 3, 5, 2 }, { 1, 4, 6, 3 }, { 6, 9, 11, 8 }, { 5, 8, 10, 7 } };
+    const bool incoming[4][4] = { { true, false, true, true }, { true, false, false, true },
+                                  { true, false, false, false }, { false, true, false, true } };
+    for (int i = 0; i < 4; i++) {
+        for (int side = 0; side < 4; side++) {
+            loop.connect(i, side, wiring[i][side], incoming[i][side] ? Intersection::LD_INCOMING :
+                                                                      Intersection::LD_OUTGOING);
+        }
+        ASSERT(loop.active(i));
+    }
+    loop.setStepMode(RoadNetworkBase::SM_SYNCHRONOUS);
+    Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
+    v1->turnLeft();
+    v1->turnRight();
+    v1->turnRight();
+    loop.lane(0).enqueue(v1);
+    loop.step();
+    ASSERT(loop.active(0) && loop.active(1) && !loop.active(2) && !loop.active(3));
+    loop.step();
+    ASSERT(!loop.active(0) && loop.active(1) && loop.active(2) && !loop.active(3));
+    ASSERT(loop.lane(6).front() == v1);
+    // a vehicle added from outside wakes the intersection it waits at
+    loop.lane(7).enqueue(new Vehicle(Vehicle::VT_BUS, 1));
+    ASSERT(loop.active(3));
+
+    // active stepping against simulating every intersection, in both modes and across a pool
+    const unsigned int size = 12;
+    const unsigned int n = size * size;
+    WorkerPool pool(3);
+    for (int mode = 0; mode < 3; mode++) {
+        BasicRoadNetwork<ExpressLane> active(n, 2 * n);
+        BasicRoadNetwork<ExpressLane> every(n, 2 * n);
+        buildTestGrid(active, size, 2718 + mode);
+        buildTestGrid(every, size, 2718 + mode);
+        active.setStepMode(mode == 0 ? RoadNetworkBase::SM_SEQUENTIAL : RoadNetworkBase::SM_SYNCHRONOUS);
+        unsigned int asleep = 0;
+        for (int t = 0; t < 60; t++) {
+            if (t % 7 == 0) {
+                unsigned int l = (t * 37) % (2 * n);
+                if (!active.lane(l).full()) {
+                    Vehicle* a = new Vehicle(Vehicle::VT_MOTORCYCLE, 1000 + t);
+                    Vehicle* b = new Vehicle(Vehicle::VT_MOTORCYCLE, 1000 + t);
+                    a->turnLeft();
+                    b->turnLeft();
+                    active.lane(l).enqueue(a);
+                    every.lane(l).enqueue(b);
+                }
+            }
+            if (mode == 2) {
+                active.step(pool);
+            }
+            else {
+                active.step();
+            }
+            if (mode == 0) {
+                for (unsigned int i = 0; i < n; i++) {
+                    every.intersection(i).simulate();
+                }
+            }
+            else {
+                every.prepareLanes(0, 2 * n);
+                every.stageIntersections(0, n);
+                every.commitLanes(0, 2 * n);
+            }
+            SimClock::tick();
+            ASSERT(sameTraffic(active, every));
+            for (unsigned int i = 0; i < n; i++) {
+                asleep += active.active(i) ? 0 : 1;
+            }
+        }
+        ASSERT(asleep > 0);
+    }
+    return TR_PASS;
 }
 
-//from piazza @376
-TestResult test_The_Filip_Simulate() {
-	Intersection intersection;
-	// vehicles for testing
-	Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
-	v1->turnStraight();//v1 turns straight
-	Vehicle* v2 = new Vehicle(Vehicle::VT_CAR, 10);
-	v2->turnLeft();//v2 turns left
-	Vehicle* v3 = new Vehicle(Vehicle::VT_CAR, 1);
-	v3->turnRight();//v3 turns right
-	Lane* roadInNorth = new SimpleLane();
-	roadInNorth->enqueue(v1);//v1 should be in north
-	Lane* roadInWest = new SimpleLane();
-	roadInWest->enqueue(v3);//v3 should be in west
-	Lane* roadInEast = new SimpleLane();
-	roadInEast->enqueue(v2);//v2 should be in east
-	Lane* roadOutSouth = new SimpleLane();
+/*
+A CalendarQueue hands out events by tick, finding the next one whether it is due this year or many years ahead.
+*/
+TestResult test_CalendarQueue() {
+    CalendarQueue queue(5);
+    ASSERT(queue.empty());
+    ASSERT(queue.nextTick(0) == CalendarQueue::NO_EVENT);
+    // 5 buckets round up to 8, so ticks 3, 11 and 1003 share a bucket
+    queue.push(11, 2);
+    queue.push(3, 1);
+    queue.push(1003, 3);
+    queue.push(3, 4);
+    ASSERT(queue.size() == 4);
+    ASSERT(queue.nextTick(0) == 3);
+    unsigned int item = 0;
+    ASSERT(queue.pop(2, item) == false);
+    unsigned int seen = 0;
+    while (queue.pop(3, item)) {
+        seen |= 1 << item;
+    }
+    ASSERT(seen == ((1u << 1) | (1u << 4)));
+    ASSERT(queue.nextTick(4) == 11);
+    ASSERT(queue.pop(11, item) && item == 2);
+    // nothing is due in the coming year, so the queue looks further ahead
+    ASSERT(queue.nextTick(12) == 1003);
+    ASSERT(queue.nextTick(1004) == CalendarQueue::NO_EVENT);
+    ASSERT(queue.pop(1003, item) && item == 3);
+    ASSERT(queue.empty());
+    // a bucket grows to hold many events for the same tick
+    for (unsigned int k = 0; k < 100; k++) {
+        queue.push(40 + 8 * (k % 2), k);
+    }
+    unsigned int popped = 0;
+    while (queue.pop(40, item)) {
+        ASSERT(item % 2 == 0);
+        popped++;
+    }
+    ASSERT(popped == 50 && queue.size() == 50 && queue.nextTick(41) == 48);
+    return TR_PASS;
+}
 
-	ASSERT(intersection.connectNorth(roadInNorth, Intersection::LD_INCOMING) == 0); // entry
-	ASSERT(intersection.connectEast(roadInEast, Intersection::LD_INCOMING) == 0); // entry
-	ASSERT(intersection.connectSouth(roadOutSouth, Intersection::LD_OUTGOING) == 0); // exit
-	ASSERT(intersection.connectWest(roadInWest, Intersection::LD_INCOMING) == 0); // entry
-	// check intersection is valid
-	ASSERT(intersection.valid());
-	//simulate and check results
-	intersection.simulate();
-	ASSERT(roadInNorth->front() == 0);
-	//simulate and check results
-	intersection.simulate();
-	ASSERT(roadInEast->front() == 0);
-	//simulate and run
-	intersection.simulate();
-	ASSERT(roadInWest->front() == 0);
-	ASSERT(roadOutSouth->front() == v1);
-	ASSERT(roadOutSouth->dequeue() == v1);
-	ASSERT(roadOutSouth->dequeue() == v2);
-	ASSERT(roadOutSouth->dequeue() == v3);
-	delete roadInNorth;
-	delete roadInEast;
-	delete roadOutSouth;
-	delete roadInWest;
-	delete v1;
-	delete v2;
-	delete v3;
-	return TR_PASS;
+/*
+With no travel time an EventEngine gives the same traffic as synchronous steps, however many ticks each run covers; with
+a travel time vehicles spend that long between intersections.
+*/
+TestResult test_EventEngine() {
+    const unsigned int size = 6;
+    BasicRoadNetwork<ExpressLane> stepped(size * size, 2 * size * size);
+    BasicRoadNetwork<ExpressLane> evented(size * size, 2 * size * size);
+    buildTestGrid(stepped, size, 4242);
+    buildTestGrid(evented, size, 4242);
+    stepped.setStepMode(RoadNetworkBase::SM_SYNCHRONOUS);
+    {
+        BasicEventEngine<ExpressLane> engine(evented, 4);
+        SimClock::reset(50);
+        for (int t = 0; t < 60; t++) {
+            unsigned int now = SimClock::now();
+            stepped.step();
+            SimClock::reset(now);
+            engine.run(now + 1);
+            ASSERT(SimClock::now() == now + 1);
+            ASSERT(sameTraffic(stepped, evented));
+        }
+        // one run over many ticks, skipping those with nothing to do once the traffic dies down
+        unsigned int start = SimClock::now();
+        for (int t = 0; t < 400; t++) {
+            stepped.step();
+        }
+        unsigned int end = SimClock::now();
+        SimClock::reset(start);
+        engine.run(end);
+        ASSERT(sameTraffic(stepped, evented));
+        ASSERT(engine.movements() > 0 && engine.inTransit() == 0);
+        for (unsigned int i = 0; i < stepped.intersectionCount(); i++) {
+            ASSERT(stepped.intersection(i).waitTimes().count() == evented.intersection(i).waitTimes().count());
+            ASSERT(stepped.intersection(i).waitTimes().mean() == evented.intersection(i).waitTimes().mean());
+        }
+    }
+
+    // the car from test_RoadNetworkSynchronous now takes 5 ticks to travel along lane 3
+    RoadNetwork loop(4, 12);
+    const int wiring[4][4] = { { 0, 3, 5, 2 }, { 1, 4, 6, 3 }, { 6, 9, 11, 8 }, { 5, 8, 10, 7 } };
+    const bool incoming[4][4] = { { true, false, true, true }, { true, false, false, true },
+                                  { true, false, false, false }, { false, true, false, true } };
+    for (int i = 0; i < 4; i++) {
+        for (int side = 0; side < 4; side++) {
+            loop.connect(i, side, wiring[i][side], incoming[i][side] ? Intersection::LD_INCOMING :
+                                                                      Intersection::LD_OUTGOING);
+        }
+    }
+    EventEngine engine(loop);
+    engine.setTravelTime(3, 5);
+    ASSERT(engine.travelTime(3) == 5 && engine.travelTime(4) == 0);
+    Vehicle* v1 = new Vehicle(Vehicle::VT_CAR, 1);
+    v1->turnLeft();
+    v1->turnRight();
+    v1->turnRight();
+    v1->turnRight();
+    v1->turnRight();
+    v1->turnStraight();
+    SimClock::reset(100);
+    loop.lane(0).enqueue(v1);
+    // { tick to run until, lane holding the car afterwards, or 12 while it is travelling along lane 3 }
+    const unsigned int route[7][2] = { { 101, 12 }, { 105, 12 }, { 106, 3 }, { 109, 5 }, { 110, 12 }, { 115, 3 },
+                                       { 200, 4 } };
+    for (int r = 0; r < 7; r++) {
+        engine.run(route[r][0]);
+        ASSERT(engine.inTransit(3) == (route[r][1] == 12 ? 1u : 0u));
+        for (unsigned int l = 0; l < 12; l++) {
+            ASSERT(loop.lane(l).count() == (l == route[r][1] ? 1u : 0u));
+        }
+    }
+    ASSERT(v1->nextTurn() == Vehicle::TD_INVALID);
+    ASSERT(engine.movements() == 6);
+
+    // vehicles travelling along a lane count towards its capacity, so the second car waits
+    loop.lane(4).dequeue();
+    delete v1;
+    loop.lane(3).setCapacity(1);
+    for (unsigned int id = 2; id < 4; id++) {
+        Vehicle* vehicle = new Vehicle(Vehicle::VT_CAR, id);
+        vehicle->turnLeft();
+        loop.lane(0).enqueue(vehicle);
+    }
+    engine.run(203);
+    ASSERT(engine.inTransit() == 1 && loop.lane(0).count() == 1);
+    // and a vehicle still travelling when the engine is destroyed is deleted with it
+    return TR_PASS;
 }
 
 #endif /*ENABLE_T2_TESTS*/
@@ -1253,6 +3562,9 @@ vector<TestResult (*)()> generateTests() {
 #ifdef ENABLE_VEHICLE_TESTS
     tests.push_back(&test_VehicleConstruction);
     tests.push_back(&test_VehicleTurning);
+    tests.push_back(&test_VehicleLongRoute);
+    tests.push_back(&test_RouteTable);
+    tests.push_back(&test_VehiclePool);
 #endif /*ENABLE_VEHICLE_TESTS*/
 #ifdef ENABLE_T1_TESTS
     tests.push_back(&test_SimpleLaneConstruction);
@@ -1263,6 +3575,23 @@ vector<TestResult (*)()> generateTests() {
     tests.push_back(&test_ExpressLaneInitialState);
     tests.push_back(&test_ExpressLaneEnqueue);
     tests.push_back(&test_ExpressLaneEnqueue2);
+    tests.push_back(&test_ExpressLaneInterleaved);
+    tests.push_back(&test_RingLaneInitialState);
+    tests.push_back(&test_RingLaneEnqueueDequeue);
+    tests.push_back(&test_PriorityLaneMotorcyclesFirst);
+    tests.push_back(&test_PriorityLaneCustomPolicies);
+    tests.push_back(&test_LaneBatchOperations);
+    tests.push_back(&test_ExpressLaneBatchAndSplice);
+    tests.push_back(&test_LaneSpliceSameType);
+    tests.push_back(&test_ConcurrentLanesSingleThread);
+    tests.push_back(&test_SpscLaneStress);
+    tests.push_back(&test_MpscLaneStress);
+    tests.push_back(&test_LaneCapacity);
+    tests.push_back(&test_LaneStats);
+    tests.push_back(&test_LaneIteration);
+    tests.push_back(&test_PooledLane);
+    tests.push_back(&test_FleetStore);
+    tests.push_back(&test_LatencyHistogram);
 #endif /*ENABLE_T1_TESTS*/
 #ifdef ENABLE_T2_TESTS
     tests.push_back(&test_IntersectionConstruction);
@@ -1275,6 +3604,24 @@ vector<TestResult (*)()> generateTests() {
     tests.push_back(&test_TrafficNetwork2);
     tests.push_back(&test_Intersections);
     tests.push_back(&test_The_Filip_Simulate);
+    tests.push_back(&test_StaticIntersectionNetwork);
+    tests.push_back(&test_IntersectionConcurrentFeed);
+    tests.push_back(&test_IntersectionSpillback);
+    tests.push_back(&test_IntersectionTiming);
+    tests.push_back(&test_GiveWayTable);
+    tests.push_back(&test_IntersectionFourIn);
+    tests.push_back(&test_IntersectionRightHandTraffic);
+    tests.push_back(&test_IntersectionReconnect);
+    tests.push_back(&test_IntersectionSaturationFlow);
+    tests.push_back(&test_Junction);
+    tests.push_back(&test_RoadNetwork);
+    tests.push_back(&test_RoadNetworkSynchronous);
+    tests.push_back(&test_WorkerPool);
+    tests.push_back(&test_RoadNetworkParallel);
+    tests.push_back(&test_RoadNetworkReorder);
+    tests.push_back(&test_RoadNetworkActiveSet);
+    tests.push_back(&test_CalendarQueue);
+    tests.push_back(&test_EventEngine);
 #endif /*ENABLE_T2_TESTS*/
 
     return tests;